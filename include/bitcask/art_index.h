@@ -5,6 +5,7 @@
 #include <vector>
 #include <array>
 #include <mutex>
+#include <shared_mutex>
 
 namespace bitcask {
 
@@ -132,10 +133,11 @@ public:
 private:
     std::shared_ptr<ARTNode> root_;
     size_t size_;
-    mutable std::mutex mutex_;
+    mutable std::shared_mutex mutex_;    // 查询共享持有，修改独占持有
     
     // 简单的后备存储确保正确性
     std::map<Bytes, LogRecordPos> simple_map_;
+    BTreeCursors cursors_;          // 后备map上打开的迭代器，删除节点都经过这里
     
     // 查找节点
     std::shared_ptr<ARTNode> search(const Bytes& key);
@@ -171,32 +173,12 @@ private:
     std::shared_ptr<ARTLeaf> get_leaf(std::shared_ptr<ARTNode> node);
 };
 
-// ART迭代器
-class ARTIterator : public IndexIterator {
+// ART迭代器：数据保存在后备map中，直接复用BTree的游标迭代器
+class ARTIterator : public BTreeIterator {
 public:
-    ARTIterator(std::shared_ptr<ARTNode> root, const IteratorOptions& options);
-    ~ARTIterator() = default;
-
-    // IndexIterator接口实现
-    void rewind() override;
-    void seek(const Bytes& key) override;
-    void next() override;
-    bool valid() const override;
-    Bytes key() const override;
-    LogRecordPos value() const override;
-    void close() override;
-
-private:
-    std::shared_ptr<ARTNode> root_;
-    IteratorOptions options_;
-    std::vector<std::pair<Bytes, LogRecordPos>> items_;
-    size_t current_index_;
-    
-    // 收集所有项目
-    void collect_items();
-    
-    // 检查键是否匹配前缀
-    bool key_matches_prefix(const Bytes& key) const;
+    ARTIterator(const std::map<Bytes, LogRecordPos>& tree, std::shared_mutex& mutex,
+                BTreeCursors& cursors, bool reverse)
+        : BTreeIterator(tree, mutex, cursors, reverse) {}
 };
 
 }  // namespace bitcask
@@ -8,6 +8,8 @@
 #include "log_record.h"
 #include "io_manager.h"
 #include "data_file.h"
+#include "data_file_scanner.h"
+#include "value_view.h"
 #include "index.h"
 #include "db.h"
 #include "utils.h"
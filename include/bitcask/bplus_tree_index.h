@@ -19,7 +19,7 @@ enum class BPlusNodeType {
 // B+树节点
 struct BPlusTreeNode {
     BPlusNodeType type;
-    std::vector<Bytes> keys;
+    std::vector<std::shared_ptr<const Bytes>> keys;  // 共享且不可变，迭代器直接持有当前key而不复制
     std::vector<LogRecordPos> values;  // 仅叶子节点使用
     std::vector<std::shared_ptr<BPlusTreeNode>> children;  // 仅内部节点使用
     std::shared_ptr<BPlusTreeNode> next;  // 叶子节点链表指针
@@ -47,6 +47,8 @@ public:
     void sync();
 
 private:
+    friend class BPlusTreeIterator;
+
     static const int MAX_KEYS = 64;  // 每个节点的最大键数
     static const std::string INDEX_FILE_NAME;
     
@@ -55,6 +57,7 @@ private:
     std::shared_ptr<BPlusTreeNode> root_;
     std::fstream file_;
     mutable std::mutex mutex_;
+    uint64_t modify_version_ = 0;    // 插入新键或删除时加一，叶子内的下标会因此移动
     
     // 加载索引文件
     void load_from_file();
@@ -94,6 +97,16 @@ private:
     // 找到第一个叶子节点
     std::shared_ptr<BPlusTreeNode> find_first_leaf();
     
+    // 找到最后一个非空叶子节点，不存在时返回nullptr
+    std::shared_ptr<BPlusTreeNode> find_last_leaf();
+    
+    // 找到key所在叶子之前最靠右的非空叶子，不存在时返回nullptr。
+    // 从根按key向下查找，再从最深一层开始回到路径左侧的兄弟子树，O(log n)，不依赖叶子链表
+    std::shared_ptr<BPlusTreeNode> find_prev_leaf(const Bytes& key);
+    
+    // 子树中最右边的非空叶子，不存在时返回nullptr
+    static std::shared_ptr<BPlusTreeNode> find_last_nonempty_leaf(const std::shared_ptr<BPlusTreeNode>& node);
+    
     // 序列化Bytes
     void serialize_bytes(const Bytes& bytes, std::ostream& os);
     
@@ -107,10 +120,12 @@ private:
     LogRecordPos deserialize_pos(std::istream& is);
 };
 
-// B+树迭代器
+// B+树迭代器：游标为（叶子节点，下标），正向沿叶子链表前进，反向在叶子内后退，
+// 不复制数据。每次操作持有索引的锁；插入新键或删除会移动叶子内的下标，
+// 版本号变化后从当前key重新定位（O(log n)）。
 class BPlusTreeIterator : public IndexIterator {
 public:
-    BPlusTreeIterator(std::shared_ptr<BPlusTreeNode> root, const IteratorOptions& options);
+    BPlusTreeIterator(BPlusTreeIndex& index, bool reverse);
     ~BPlusTreeIterator() = default;
 
     // IndexIterator接口实现
@@ -118,30 +133,31 @@ public:
     void seek(const Bytes& key) override;
     void next() override;
     bool valid() const override;
-    Bytes key() const override;
+    const Bytes& key() const override;
     LogRecordPos value() const override;
     void close() override;
 
 private:
-    std::shared_ptr<BPlusTreeNode> root_;
-    std::shared_ptr<BPlusTreeNode> current_leaf_;
-    size_t current_index_;
-    IteratorOptions options_;
-    std::vector<std::pair<Bytes, LogRecordPos>> items_;
-    size_t items_index_;
-    bool use_items_;
-    
-    // 找到第一个叶子节点
-    std::shared_ptr<BPlusTreeNode> find_first_leaf();
-    
-    // 初始化项目列表（用于反向迭代）
-    void init_items();
-    
-    // 检查键是否匹配前缀
-    bool key_matches_prefix(const Bytes& key) const;
-    
-    // 比较键值
-    int compare_keys(const Bytes& a, const Bytes& b) const;
+    // 正向定位到第一个大于（inclusive时大于等于）key的位置，
+    // 反向定位到最后一个小于（inclusive时小于等于）key的位置（调用者持有锁）
+    void position_at(const Bytes& key, bool inclusive);
+
+    // 从leaf_的idx_开始向后找到第一个存在的项（调用者持有锁）
+    void settle_forward();
+
+    // 定位到leaf_中下标idx之前的一项，叶子内没有时退到前面叶子中最后一个小于bound的项（调用者持有锁）
+    void settle_backward(size_t idx, const Bytes& bound);
+
+    // 停在游标所在的项上：key与叶子共享，只复制位置（调用者持有锁）
+    void load();
+
+    BPlusTreeIndex& index_;
+    std::shared_ptr<BPlusTreeNode> leaf_;   // 为空表示迭代结束
+    size_t idx_;
+    uint64_t version_;                      // 定位时的修改版本号
+    std::shared_ptr<const Bytes> key_;      // 当前key，与叶子共享，用于重新定位
+    LogRecordPos pos_;
+    bool reverse_;
 };
 
 }  // namespace bitcask
@@ -10,6 +10,7 @@ namespace bitcask {
 
 // 常量定义
 static const std::string DATA_FILE_SUFFIX = ".data";
+static const std::string DATA_HINT_FILE_SUFFIX = ".hint";
 static const std::string HINT_FILE_NAME = "hint-index";
 static const std::string MERGE_FINISHED_FILE_NAME = "merge-finished";
 static const std::string SEQ_NO_FILE_NAME = "seq-no";
@@ -29,13 +30,16 @@ using BytesPtr = std::shared_ptr<Bytes>;
 enum class LogRecordType : uint8_t {
     NORMAL = 1,
     DELETED = 2,
-    TXN_FINISHED = 3
+    TXN_FINISHED = 3,
+    SYNC_MARKER = 4         // 同步标记，扫描遇到损坏时跳到下一个标记继续
 };
 
 // IO类型
 enum class IOType {
     STANDARD_FIO,
-    MEMORY_MAP
+    MEMORY_MAP,
+    IO_URING,
+    DIRECT_IO
 };
 
 // 索引类型
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bitcask {
+namespace crc32c {
+
+/**
+ * @brief 在已有CRC32C值的基础上继续计算
+ *
+ * 多项式为Castagnoli(0x1EDC6F41)。首次调用时按CPU能力选择实现：
+ * 支持SSE4.2时使用crc32指令，同时支持PCLMULQDQ时长数据分三路并行计算后用
+ * 无进位乘法合并；都不支持时使用slicing-by-8查表实现。
+ * @param crc 前一段数据的CRC值，第一段数据传0
+ * @param data 数据
+ * @param length 数据长度
+ * @return 拼接后数据的CRC值
+ */
+uint32_t extend(uint32_t crc, const void* data, size_t length);
+
+/**
+ * @brief 计算一段数据的CRC32C值
+ */
+inline uint32_t value(const void* data, size_t length) {
+    return extend(0, data, length);
+}
+
+/**
+ * @brief 纯软件实现（slicing-by-8），结果与extend相同，用于测试和性能对比
+ */
+uint32_t extend_portable(uint32_t crc, const void* data, size_t length);
+
+/**
+ * @brief 当前是否使用了硬件指令
+ */
+bool hardware_accelerated();
+
+/**
+ * @brief 当前使用的实现名称："sse4.2+pclmul"、"sse4.2"或"slicing-by-8"
+ */
+const char* implementation();
+
+}  // namespace crc32c
+}  // namespace bitcask
@@ -3,9 +3,15 @@
 #include "common.h"
 #include "log_record.h"
 #include "io_manager.h"
+#include "data_file_scanner.h"
+#include "mmap_io.h"
+#include "value_view.h"
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace bitcask {
 
@@ -13,7 +19,7 @@ namespace bitcask {
 class DataFile {
 public:
     DataFile(const std::string& dir_path, uint32_t file_id, IOType io_type);
-    ~DataFile() = default;
+    ~DataFile();
 
     // 创建数据文件
     static std::unique_ptr<DataFile> open_data_file(const std::string& dir_path, 
@@ -28,18 +34,62 @@ public:
     // 创建序列号文件
     static std::unique_ptr<DataFile> open_seq_no_file(const std::string& dir_path);
 
+    // 打开指定路径的文件（标准文件IO），用于数据文件的提示文件等辅助文件
+    static std::unique_ptr<DataFile> open_file(const std::string& file_name);
+
     // 根据偏移量读取日志记录
+    // 已落盘的区域（封存的文件或活跃文件中已写入的部分）不加锁读取，
+    // 只有涉及追加缓冲区的读取才需要持有文件锁
     ReadLogRecord read_log_record(uint64_t offset);
 
+    // 读取长度已知的日志记录（size取自LogRecordPos），只做一次读取
+    ReadLogRecord read_log_record(uint64_t offset, uint32_t size);
+
+    // 读取记录的值视图：封存并映射的文件直接返回指向映射的视图，不分配内存也不拷贝；
+    // 其他情况读出记录后由视图持有值。type返回记录类型
+    ValueView read_value_view(uint64_t offset, uint32_t size, LogRecordType& type);
+
+    // 创建顺序扫描器（先刷出追加缓冲区），扫描范围是当前已写入的数据
+    std::unique_ptr<DataFileScanner> new_scanner(const ScannerOptions& options = ScannerOptions());
+
+    // 批量读取多条位置已知的日志记录，所有读请求一次提交给IO管理器
+    std::vector<ReadLogRecord> read_log_records(const std::vector<LogRecordPos>& positions);
+
     // 写入数据
     size_t write(const Bytes& data);
 
+    // 分散写入多个缓冲区（一次writev）
+    size_t write(const struct iovec* iov, int iovcnt);
+
+    // 写入日志记录：头部在栈上编码，key和value直接交给IO层，不做拼接拷贝
+    size_t write(const LogRecord& record);
+
+    // 在文件末尾预留size字节，返回预留区域的起始偏移（先刷出追加缓冲区）
+    uint64_t reserve(size_t size);
+
+    // 把日志记录写入reserve预留的位置，不持有文件锁，多个线程可以同时写各自的区域
+    size_t write_at(uint64_t offset, const LogRecord& record);
+
     // 写入提示记录
     void write_hint_record(const Bytes& key, const LogRecordPos& pos);
 
-    // 同步到磁盘
+    // 同步到磁盘（先刷出追加缓冲区）
     void sync();
 
+    // 启用追加缓冲区：小记录先写入内存，攒满capacity字节后一次写入文件
+    // capacity为0表示关闭缓冲
+    void enable_write_buffer(size_t capacity);
+
+    // 将追加缓冲区中的数据写入文件（不做fdatasync）
+    void flush();
+
+    // 预分配size字节的磁盘空间，不改变文件大小（文件系统不支持时忽略）
+    void preallocate(uint64_t size);
+
+    // 封存文件：刷出追加缓冲区，之后不再写入，所有读取都不加锁
+    // map_read_only为true时同时建立只读映射，之后的读取直接从映射中取数据
+    void seal(bool map_read_only = false);
+
     // 关闭文件
     void close();
 
@@ -55,20 +105,75 @@ public:
     // 获取文件ID
     uint32_t get_file_id() const { return file_id_; }
 
-    // 设置IO管理器
+    // 把文件截断到size字节，写入偏移随之移到文件末尾（用于丢弃写了一半的尾部）
+    void truncate(uint64_t size);
+
+    // 设置IO管理器（不能与读取并发调用）
     void set_io_manager(const std::string& dir_path, IOType io_type);
 
+    // 之后的读写先向limiter申请额度（不能与读写并发调用，用于merge写出的文件）
+    void set_rate_limiter(std::shared_ptr<RateLimiter> limiter);
+
+    // 用wrap包装当前的IO管理器，例如在测试中注入IO错误（不能与读写并发调用）
+    void wrap_io_manager(const std::function<std::unique_ptr<IOManager>(std::unique_ptr<IOManager>)>& wrap);
+
     // 获取数据文件名
     static std::string get_data_file_name(const std::string& dir_path, uint32_t file_id);
 
+    // 读一遍目录，返回其中所有数据文件的ID（升序），目录不存在时返回空
+    static std::vector<uint32_t> list_data_file_ids(const std::string& dir_path);
+
+    // 获取数据文件对应的提示文件名
+    static std::string get_hint_file_name(const std::string& dir_path, uint32_t file_id);
+
 private:
+    // 直接打开指定路径的文件，文件ID为0
+    DataFile(const std::string& file_name, IOType io_type);
+
     uint32_t file_id_;                          // 文件ID
-    uint64_t write_off_;                        // 写入偏移量
+    std::string file_name_;                     // 文件路径
+    std::atomic<uint64_t> write_off_;           // 写入偏移量（包含缓冲区中未刷出的数据），持锁修改
     std::unique_ptr<IOManager> io_manager_;     // IO管理器
     mutable std::mutex mutex_;                  // 线程安全保护
+    Bytes write_buffer_;                        // 追加缓冲区
+    size_t write_buffer_capacity_;              // 追加缓冲区容量，0表示不缓冲
+    uint64_t buffer_off_;                       // 缓冲区第一个字节在文件中的偏移
+    std::atomic<uint64_t> file_size_;           // 已写入文件的字节数，打开时取一次，之后随写入更新
+    std::atomic<bool> sealed_;                  // 是否已封存
+    IOType io_type_;                            // 当前IO管理器的类型
+    bool concurrent_io_;                        // IO管理器的读能否与写并发（mmap写入会重新映射，不能）
+    std::shared_ptr<const ReadOnlyMapping> mapping_; // 封存时建立的只读映射，在sealed_置位前设置，之后不再改变
+
+    // 封存并映射后返回映射，否则返回nullptr
+    const ReadOnlyMapping* sealed_mapping() const;
+
+    // 从IO管理器重新获取文件大小（打开文件或更换IO管理器时调用）
+    void load_file_size();
 
-    // 读取N个字节
+    // 写入[0, end)之后更新缓存的文件大小
+    void extend_file_size(uint64_t end);
+
+    // [0, end)能否不加锁读取
+    bool readable_without_lock(uint64_t end) const;
+
+    // 直接从文件读取N个字节，不经过追加缓冲区，读到文件末尾时返回的数据较短
+    Bytes read_file_bytes(size_t n, uint64_t offset) const;
+
+    // 按偏移解析一条记录，file_size为可读范围，read负责读取字节
+    template <typename ReadFn>
+    ReadLogRecord read_log_record_from(uint64_t offset, uint64_t file_size, ReadFn read);
+
+    // 读取N个字节（调用者持有锁）
     Bytes read_n_bytes(size_t n, uint64_t offset);
+
+    // 写入多个缓冲区（调用者持有锁）
+    size_t write_locked(const struct iovec* iov, int iovcnt);
+
+    // 刷出追加缓冲区（调用者持有锁）
+    void flush_locked();
+
+    // 逻辑文件大小，包含缓冲区中未刷出的数据（调用者持有锁）
+    uint64_t logical_size_locked() const;
 };
 
 }  // namespace bitcask
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "common.h"
+#include "rate_limiter.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace bitcask {
+
+/**
+ * @brief 顺序扫描的配置
+ */
+struct ScannerOptions {
+    size_t buffer_size = 1024 * 1024;   // 每次顺序读取的字节数
+    bool map_populate = false;          // 改为整体映射文件并用MAP_POPULATE一次预读所有页
+    RateLimiter* rate_limiter = nullptr; // 每次从文件读取前申请额度（映射整个文件时不限速）
+};
+
+/**
+ * @brief 扫描结果
+ */
+enum class ScanStatus {
+    OK,             // 读到一条完整且校验通过的记录
+    END_OF_FILE,    // 到达文件末尾（包括全零的尾部）
+    TORN_TAIL,      // 文件末尾的记录不完整，通常是写入时崩溃留下的
+    CORRUPTED       // 当前偏移处的记录损坏，offset()停在这条记录上
+};
+
+/**
+ * @brief 扫描到的一条记录
+ *
+ * key和value直接指向扫描器的缓冲区（或映射），只在下一次调用next之前有效。
+ */
+struct ScannedRecord {
+    uint64_t offset = 0;                // 记录在文件中的偏移
+    uint32_t size = 0;                  // 记录编码后的总长度
+    LogRecordType type = LogRecordType::NORMAL;
+    const uint8_t* key = nullptr;
+    uint32_t key_size = 0;
+    const uint8_t* value = nullptr;
+    uint32_t value_size = 0;
+
+    Bytes key_bytes() const { return Bytes(key, key + key_size); }
+    Bytes value_bytes() const { return Bytes(value, value + value_size); }
+};
+
+/**
+ * @brief 数据文件的顺序扫描器
+ *
+ * 用独立的只读文件描述符按大块顺序读取（posix_fadvise(SEQUENTIAL)），
+ * 在缓冲区中原地解码记录并校验CRC，每条记录不需要额外的系统调用。
+ * 扫描过程不抛异常，文件结束、尾部不完整和记录损坏都通过返回值报告。
+ * 遇到损坏时用skip_corrupted跳到下一个同步标记，并累计损坏区间的统计。
+ * 扫描范围是打开时的文件大小，调用者需要保证此前的写入已经刷到文件。
+ */
+class DataFileScanner {
+public:
+    /**
+     * @brief 打开文件进行扫描
+     * @param file_name 文件路径
+     * @param options 扫描配置
+     * @throws BitcaskException 文件无法打开时抛出
+     */
+    static std::unique_ptr<DataFileScanner> open(const std::string& file_name,
+                                                 const ScannerOptions& options = ScannerOptions());
+
+    ~DataFileScanner();
+
+    DataFileScanner(const DataFileScanner&) = delete;
+    DataFileScanner& operator=(const DataFileScanner&) = delete;
+
+    /**
+     * @brief 解码当前偏移处的记录，成功时前进到下一条
+     * @param record 输出记录，指针在下一次调用前有效
+     * @return 扫描状态，不是OK时偏移不变
+     */
+    ScanStatus next(ScannedRecord& record);
+
+    /**
+     * @brief 跳到指定偏移继续扫描
+     */
+    void seek(uint64_t offset);
+
+    /**
+     * @brief 跳过当前偏移处的损坏数据：跳到其后的下一个同步标记，
+     *        后面没有同步标记时（如旧版本写入的文件）只前进一个字节
+     */
+    void skip_corrupted();
+
+    /**
+     * @brief skip_corrupted跳过的区间数（相邻的跳过合并为一个区间）
+     */
+    uint64_t corrupted_ranges() const { return corrupted_ranges_; }
+
+    /**
+     * @brief skip_corrupted跳过的字节数
+     */
+    uint64_t corrupted_bytes() const { return corrupted_bytes_; }
+
+    /**
+     * @brief 下一条记录的偏移；扫描停止时是最后一条有效记录的结尾
+     */
+    uint64_t offset() const { return offset_; }
+
+    /**
+     * @brief 打开时的文件大小
+     */
+    uint64_t file_size() const { return file_size_; }
+
+private:
+    DataFileScanner(int fd, uint64_t file_size, const ScannerOptions& options);
+
+    // 保证[offset, offset + n)在缓冲区中，返回起始地址；文件剩余不足n字节时返回nullptr
+    const uint8_t* fetch(uint64_t offset, size_t n);
+
+    // 解码offset处的记录，不移动扫描位置
+    ScanStatus decode_at(uint64_t offset, ScannedRecord& record);
+
+    // offset处超出文件末尾的记录是否确实是写了一半的尾部（而不是长度字段损坏）：
+    // 后面既没有同步标记，也解不出任何完整记录时才是尾部
+    bool is_torn_tail(uint64_t offset);
+
+    // 从from开始查找同步标记，返回其偏移，找不到时返回file_size_
+    uint64_t find_sync_marker(uint64_t from);
+
+    // 文件中最后一个同步标记的偏移，没有时返回file_size_；从文件末尾向前查找，结果缓存
+    uint64_t last_sync_marker();
+
+    int fd_;
+    uint64_t file_size_;
+    uint64_t offset_;
+    size_t buffer_size_;
+    RateLimiter* rate_limiter_;
+    Bytes buffer_;                  // 缓冲区，保存文件中[buffer_off_, buffer_off_ + buffer_len_)的内容
+    uint64_t buffer_off_;
+    size_t buffer_len_;
+    const uint8_t* mapped_;         // map_populate时整个文件的映射
+    uint64_t corrupted_ranges_;
+    uint64_t corrupted_bytes_;
+    uint64_t corrupted_end_;        // 上一个跳过区间的结尾
+    uint64_t marker_search_from_;   // 上一次查找的起点和结果，连续跳过时不重复查找
+    uint64_t marker_found_at_;
+    uint64_t last_marker_;          // 最后一个同步标记的偏移，UINT64_MAX表示还没有查找
+    uint64_t probe_from_;           // 上一次试探尾部的起点和找到的完整记录位置
+    uint64_t probe_found_;
+};
+
+}  // namespace bitcask
@@ -5,12 +5,19 @@
 #include "log_record.h"
 #include "data_file.h"
 #include "index.h"
+#include "value_cache.h"
+#include "rate_limiter.h"
 #include <unordered_map>
 #include <memory>
 #include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include <atomic>
 #include <functional>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace bitcask {
 
@@ -39,6 +46,7 @@ private:
 // Bitcask存储引擎实例
 class DB {
     friend class DBIterator;  // 允许DBIterator访问私有成员
+    friend class DBFaultInjection;  // 测试中替换活跃文件的IO管理器以注入写入错误
     
 public:
     // 打开数据库
@@ -50,9 +58,16 @@ public:
     // 写入key/value数据
     void put(const Bytes& key, const Bytes& value);
 
+    // 写入key/value数据（接管key和value的内存，写入过程中不再拷贝）
+    void put(Bytes&& key, Bytes&& value);
+
     // 根据key读取数据
     Bytes get(const Bytes& key);
 
+    // 根据key读取数据，返回值的只读视图；值在已映射的旧文件中时不分配内存也不拷贝，
+    // 视图持有映射的引用，数据库关闭或merge之后仍然有效
+    ValueView get_view(const Bytes& key);
+
     // 根据key删除数据
     void remove(const Bytes& key);
 
@@ -71,16 +86,23 @@ public:
     // 获取统计信息
     Stat stat();
 
+    // 获取每个数据文件的大小和失效字节数（按文件ID升序）
+    std::vector<DataFileStat> data_file_stats();
+
     // 备份数据库
     void backup(const std::string& dir);
 
+    // 创建检查点：在dir（不能已存在）中生成一份时间点快照，可以直接作为数据库打开。
+    // 写入只在记录活跃文件的已提交长度时暂停片刻，旧文件尽量硬链接，复制在锁外进行
+    void checkpoint(const std::string& dir);
+
     // 创建批量写入对象
     std::unique_ptr<WriteBatch> new_write_batch(const WriteBatchOptions& options);
 
     // 创建迭代器
     std::unique_ptr<class DBIterator> iterator(const IteratorOptions& options);
 
-    // 合并无效数据，生成Hint文件
+    // 合并无效数据：只重写失效比例达到merge_file_garbage_ratio的旧文件，合并结果沿用原来的文件ID
     void merge();
 
 private:
@@ -95,23 +117,148 @@ private:
     // 从数据文件加载索引
     void load_index_from_data_files();
 
+    // 索引重建时从数据文件中扫描出的一条记录
+    struct IndexRunEntry {
+        Bytes key;                  // 去掉序列号后的key
+        LogRecordPos pos;           // 记录位置
+        LogRecordType type;         // 记录类型
+        uint64_t seq_no;            // 事务序列号
+    };
+
+    // 一个数据文件的扫描结果，记录按文件中的顺序排列
+    struct IndexRun {
+        std::vector<IndexRunEntry> entries;
+        uint64_t end_offset = 0;    // 扫描结束的位置（活跃文件从这里继续写入）
+        bool from_hint = false;     // 是否来自提示文件
+        uint64_t corrupted_ranges = 0;  // 跳过的损坏区间
+        uint64_t corrupted_bytes = 0;
+        uint64_t torn_tail_bytes = 0;   // 末尾写了一半的记录长度
+    };
+
+    // 顺序扫描一个数据文件（不访问索引，可以在多个线程中并发调用）
+    static IndexRun scan_data_file(uint32_t fid, DataFile* data_file);
+
+    // 获取一个数据文件的记录：封存的文件优先读取它的提示文件，没有可用的提示文件时扫描数据文件
+    IndexRun load_index_run(uint32_t fid, DataFile* data_file) const;
+
+    // 读取数据文件的提示文件，提示文件不存在、不完整或与数据文件不匹配时返回false
+    static bool load_hint_run(const std::string& dir_path, uint32_t fid, DataFile* data_file, IndexRun& run);
+
+    // 为封存的数据文件生成提示文件：每条记录对应一条提示（原始key、类型和位置，不含value），
+    // 最后是记录数据文件大小和整个文件CRC的结束标记；先写临时文件，同步后再改名
+    static void write_hint_file(const std::string& dir_path, uint32_t fid, DataFile* data_file);
+
+    // 后台线程：为指定的数据文件生成提示文件（文件已不存在或仍是活跃文件时跳过）
+    void build_hint_file(uint32_t fid);
+
+    // 请求后台线程为这些数据文件生成提示文件
+    void request_hint_files(const std::vector<uint32_t>& fids);
+
+    // 用recovery_threads个线程并发扫描数据文件，按files中的顺序依次把结果交给apply
+    // 同时在扫描和等待应用的文件数有上限，内存占用不随文件数增长
+    void scan_data_files_in_order(const std::vector<std::pair<uint32_t, DataFile*>>& files,
+                                  const std::function<void(uint32_t, IndexRun&)>& apply);
+
     // 从hint文件加载索引
     void load_index_from_hint_file();
 
-    // 加载合并文件
+    // 重做上次中断的merge安装，清理遗留的合并目录
     void load_merge_files();
 
-    // 设置活跃数据文件
+    // 设置活跃数据文件（优先使用后台预创建好的文件）
     void set_active_data_file();
 
+    // 把写满的活跃文件转为旧文件并切换到新文件（调用者持有追加锁）
+    void rotate_active_data_file();
+
+    // 数据文件表：文件ID到数据文件的映射，每次变化都生成新表整体发布，
+    // 读请求取得当前表后即可解析LogRecordPos，不需要追加锁
+    struct DataFileTable {
+        DataFile* active = nullptr;                         // 活跃文件
+        std::unordered_map<uint32_t, DataFile*> files;      // 所有数据文件（包括活跃文件）
+    };
+
+    // 根据active_file_和older_files_生成新的数据文件表并发布（调用者持有追加锁或独占mutex_）
+    void publish_data_files();
+
+    // 获取当前发布的数据文件表，表中的文件在持有mutex_（共享或独占）期间有效
+    std::shared_ptr<const DataFileTable> data_files() const;
+
+    // 启动/停止后台文件轮转线程
+    void start_background_worker();
+    void stop_background_worker();
+
+    // 后台线程：同步已转为旧文件的数据文件，预创建下一个数据文件
+    void background_worker();
+
+    // 请求后台预创建指定ID的数据文件
+    void request_next_data_file(uint32_t file_id);
+
+    // 取走预创建好的数据文件，ID不匹配时返回空
+    std::unique_ptr<DataFile> take_next_data_file(uint32_t file_id);
+
+    // 丢弃预创建好的数据文件（未写入过的空文件会被删除）
+    void discard_next_data_file();
+
+    // 等待所有已转为旧文件的数据文件同步完成
+    void sync_sealed_files();
+
     // 追加写入日志记录
     LogRecordPos append_log_record(const LogRecord& record);
     
-    // 追加写入日志记录（内部版本，不加锁）
-    LogRecordPos append_log_record_internal(const LogRecord& record);
+    // 在write_off处写入size字节的记录之前需要先写的同步标记长度（不需要时为0）
+    size_t sync_marker_size(uint64_t write_off, uint64_t size) const;
+
+    // 追加写入日志记录（内部版本，调用者持有追加锁或独占mutex_）
+    // defer_sync为true时不做sync_writes/bytes_per_sync同步，由调用者统一同步
+    LogRecordPos append_log_record_internal(const LogRecord& record, bool defer_sync = false);
+
+    // 追加写入后的同步方式
+    enum class AppendSync {
+        POLICY,     // 按sync_writes/bytes_per_sync配置同步
+        DEFER,      // 不同步，由调用者统一同步
+        ALWAYS      // 写入后一定同步
+    };
+
+    // 连续追加一组日志记录（调用者共享持有mutex_）
+    // 追加锁只覆盖文件轮转和偏移预留，数据在锁外写入；写入完成后按预留顺序调用apply更新索引，
+    // 同一个key的多次写入在索引中的先后顺序与文件中的顺序一致
+    // 写入预留区域失败后把[offset, offset + size)整个改写为填充记录，恢复时跳过而不是在空洞处停止；
+    // 填充也失败时返回false
+    bool pad_reserved_range(DataFile* file, uint64_t offset, uint64_t size);
+
+    std::vector<LogRecordPos> append_log_records(
+        const std::vector<const LogRecord*>& records, AppendSync sync_mode,
+        const std::function<void(const std::vector<LogRecordPos>&)>& apply);
+
+    // 单条写请求（put/remove），组提交时在队列中排队
+    struct CommitRequest {
+        Bytes key;                          // 用户key，更新索引时使用
+        LogRecord record;                   // 待写入的日志记录（key带序列号前缀）
+        bool done = false;                  // 是否已由leader处理完成
+        std::exception_ptr error;           // 处理过程中产生的异常
+    };
+
+    // 写入日志记录并更新索引（调用者共享持有mutex_）
+    void apply_commit_request(CommitRequest& request);
+
+    // 删除不存在的key时不需要写入记录，直接完成
+    bool skip_commit_request(const CommitRequest& request);
+
+    // 记录写入后更新索引
+    void update_index_for_request(const CommitRequest& request, const LogRecordPos& pos);
+
+    // pos处的记录已失效（被覆盖、被删除或本身是删除记录）：计入可回收空间和所在文件的失效字节数
+    void mark_dead(const LogRecordPos& pos);
+
+    // 组提交：排队等待，由leader批量写入并只做一次fdatasync
+    void group_commit(CommitRequest& request);
 
     // 根据位置获取值
     Bytes get_value_by_position(const LogRecordPos& pos);
+    
+    // 批量获取多个位置的值：同一文件的记录通过DataFile::read_log_records一次读取
+    std::vector<Bytes> get_values_by_positions(const std::vector<LogRecordPos>& positions);
 
     // 检查配置选项
     static void check_options(const Options& options);
@@ -140,20 +287,58 @@ private:
     // 检查是否达到合并阈值
     bool should_merge() const;
 
-    // 旋转合并文件
-    std::vector<std::unique_ptr<DataFile>> rotate_merge_files();
-
-    // 获取非合并文件ID
-    uint32_t get_non_merge_file_id(const std::string& dir_path) const;
+    // merge输出文件的写入器（定义在db.cpp中）
+    class MergeWriter;
+
+    // merge重写的一条有效记录：安装时只有索引仍指向旧位置的key才改为新位置
+    struct MergedRecord {
+        Bytes key;
+        LogRecordPos old_pos;       // 被合并文件中的位置
+        LogRecordPos new_pos;       // 合并结果中的位置
+    };
+
+    // 用合并结果替换被合并的文件并更新索引（调用者独占持有mutex_）
+    // dead_positions为合并结果中保留下来的删除记录；返回移出文件表的旧文件，由调用者在锁外关闭
+    std::vector<std::unique_ptr<DataFile>> install_merge_files(const std::vector<uint32_t>& merged_fids,
+                                                               const std::vector<uint32_t>& output_fids,
+                                                               const std::string& merge_path,
+                                                               const std::vector<MergedRecord>& records,
+                                                               const std::vector<LogRecordPos>& dead_positions);
+
+    // 写入merge完成标记：记录被合并的文件和合并结果的文件ID，同步后安装才开始
+    static void write_merge_finished_file(const std::string& merge_path,
+                                          const std::vector<uint32_t>& merged_fids,
+                                          const std::vector<uint32_t>& output_fids);
+
+    // 读取merge完成标记，标记不存在或不完整时返回false
+    static bool read_merge_finished_file(const std::string& merge_path,
+                                         std::vector<uint32_t>& merged_fids,
+                                         std::vector<uint32_t>& output_fids);
+
+    // 把合并结果改名到主目录，删除没有被替换的旧文件和失效的提示文件；
+    // 可以重复执行，启动时据此重做中断的安装。调用者同步主目录后才能删除合并目录
+    static void move_merge_files(const std::string& dir_path, const std::string& merge_path,
+                                 const std::vector<uint32_t>& merged_fids,
+                                 const std::vector<uint32_t>& output_fids);
 
     friend class WriteBatch;
 
 private:
     Options options_;                                           // 配置选项
-    mutable std::shared_mutex mutex_;                          // 读写锁
+    mutable std::shared_mutex mutex_;                          // 结构锁：读写操作共享持有，merge安装结果时独占
+    std::mutex append_mutex_;                                  // 追加锁：保护活跃文件切换和偏移预留
     std::vector<uint32_t> file_ids_;                          // 文件ID列表
     std::unique_ptr<DataFile> active_file_;                    // 活跃数据文件
     std::unordered_map<uint32_t, std::unique_ptr<DataFile>> older_files_; // 旧数据文件
+    std::shared_ptr<const DataFileTable> data_file_table_;     // 已发布的数据文件表（原子读写）
+
+    // 追加写入的顺序发布
+    std::mutex publish_mutex_;                                // 保护以下状态
+    std::condition_variable publish_cv_;                      // 写入完成或轮到发布时通知
+    uint64_t next_append_ticket_;                             // 下一次预留的序号（持有追加锁时分配）
+    uint64_t published_append_ticket_;                        // 下一个可以更新索引的序号
+    uint32_t pending_appends_;                                // 已预留但还没写完的次数
+    std::atomic<bool> append_failed_;                         // 预留区域写入失败且无法用填充记录修补，之后拒绝追加
     std::unique_ptr<Indexer> index_;                          // 内存索引
     std::atomic<uint64_t> seq_no_;                            // 事务序列号
     std::atomic<bool> is_merging_;                            // 是否正在合并
@@ -161,10 +346,44 @@ private:
     bool is_initial_;                                         // 是否首次初始化
     int file_lock_fd_;                                        // 文件锁
     std::atomic<uint64_t> bytes_write_;                       // 累计写入字节数
-    std::atomic<int64_t> reclaim_size_;                       // 可回收空间大小
+    std::atomic<int64_t> reclaim_size_;                       // 可回收空间大小（所有文件失效字节数之和）
+    std::mutex dead_bytes_mutex_;                             // 保护dead_bytes_
+    std::unordered_map<uint32_t, uint64_t> dead_bytes_;       // 每个数据文件中失效的字节数
+    std::atomic<uint64_t> file_epoch_;                        // 数据文件代数，merge替换文件后加一
+    std::unique_ptr<ValueCache> value_cache_;                 // 值缓存（未启用时为空）
+    std::shared_ptr<RateLimiter> io_limiter_;                 // merge和备份共用的IO限速器（未限速时为空）
+    uint64_t corrupted_ranges_;                               // 启动时跳过的损坏区间数
+    uint64_t corrupted_bytes_;                                // 启动时跳过的损坏字节数
+    uint64_t truncated_tail_bytes_;                           // 启动时截掉的活跃文件尾部字节数
+
+    // 组提交
+    std::mutex commit_mutex_;                                 // 保护提交队列和统计
+    std::condition_variable commit_cv_;                       // 唤醒等待的写请求
+    std::vector<CommitRequest*> commit_queue_;                // 等待写入的请求
+    bool commit_leader_active_;                               // 是否已有leader在处理
+    uint64_t sync_group_num_;                                 // 组提交次数
+    uint64_t sync_group_records_;                             // 组提交记录总数
+    uint32_t sync_group_max_size_;                            // 单组最大记录数
+    uint64_t sync_group_total_latency_us_;                    // 组提交累计耗时
+    uint64_t sync_group_max_latency_us_;                      // 单组最大耗时
+
+    // 后台文件轮转
+    std::thread bg_thread_;                                   // 后台线程
+    std::mutex bg_mutex_;                                     // 保护以下状态
+    std::condition_variable bg_cv_;                           // 唤醒后台线程
+    std::condition_variable bg_done_cv_;                      // 后台任务完成通知
+    bool bg_stop_;                                            // 通知后台线程退出
+    int64_t next_file_id_;                                    // 需要预创建的文件ID，-1表示没有
+    bool next_file_creating_;                                 // 后台线程是否正在创建文件
+    std::unique_ptr<DataFile> next_file_;                     // 预创建好的下一个数据文件
+    std::vector<std::string> sealed_files_;                   // 等待后台同步的旧文件路径
+    std::vector<uint32_t> pending_hints_;                     // 等待后台生成提示文件的数据文件ID
+    uint32_t sealed_syncing_;                                 // 正在后台同步的批次数
+    std::exception_ptr sealed_sync_error_;                    // 后台同步旧文件遇到的错误，等待同步的写入取走
 };
 
-// 数据库迭代器
+// 数据库迭代器：前缀和上下界合并成一个[lower_, upper_)范围，定位时直接seek到范围的一端，
+// 移动时只和范围的另一端比较一次，不再逐个检查前缀
 class DBIterator {
 public:
     DBIterator(DB* db, const IteratorOptions& options);
@@ -182,8 +401,8 @@ public:
     // 检查是否有效
     bool valid() const;
 
-    // 获取当前key
-    Bytes key() const;
+    // 获取当前key，引用在下一次移动迭代器之前有效
+    const Bytes& key() const;
 
     // 获取当前value
     Bytes value() const;
@@ -192,9 +411,17 @@ public:
     void close();
 
 private:
+    // 移动之后根据范围和数量限制更新valid_
+    void update_valid();
+
     DB* db_;
     IteratorOptions options_;
     std::unique_ptr<IndexIterator> index_iter_;
+    Bytes lower_;           // 合并前缀后的下界（包含），为空表示不限
+    Bytes upper_;           // 合并前缀后的上界（不包含）
+    bool has_upper_;        // 是否有上界（空key不能作为上界）
+    size_t returned_;       // rewind或seek之后已经越过的key数
+    bool valid_;
 };
 
 }  // namespace bitcask
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "io_manager.h"
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace bitcask {
+
+// O_DIRECT的对齐单位（偏移、长度和内存地址都按此对齐）
+constexpr size_t DIRECT_IO_BLOCK_SIZE = 4096;
+
+/**
+ * @brief 直接IO使用的块缓存
+ *
+ * 直接IO绕过页缓存，小范围的随机读由引擎自己缓存最近访问的块，
+ * 进程内所有DirectIOManager共用一个LRU缓存。
+ */
+class DirectIOBlockCache {
+public:
+    /**
+     * @brief 获取共享的块缓存
+     */
+    static DirectIOBlockCache& shared();
+
+    /**
+     * @brief 构造函数
+     * @param capacity_blocks 最多缓存的块数
+     */
+    explicit DirectIOBlockCache(size_t capacity_blocks);
+
+    /**
+     * @brief 查找块，命中时复制到out
+     * @return 命中返回true
+     */
+    bool get(uint64_t file_key, uint64_t block, uint8_t* out);
+
+    /**
+     * @brief 放入一个块，超出容量时淘汰最久未使用的块
+     */
+    void put(uint64_t file_key, uint64_t block, const uint8_t* data);
+
+    /**
+     * @brief 删除一个块（块被写入后调用）
+     */
+    void erase(uint64_t file_key, uint64_t block);
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    struct BlockKey {
+        uint64_t file_key;
+        uint64_t block;
+
+        bool operator==(const BlockKey& other) const {
+            return file_key == other.file_key && block == other.block;
+        }
+    };
+
+    struct BlockKeyHash {
+        size_t operator()(const BlockKey& key) const {
+            return std::hash<uint64_t>()(key.file_key * 0x9e3779b97f4a7c15ULL ^ key.block);
+        }
+    };
+
+    using LRUList = std::list<std::pair<BlockKey, Bytes>>;
+
+    size_t capacity_;
+    LRUList lru_;                                                   // 表头为最近使用
+    std::unordered_map<BlockKey, LRUList::iterator, BlockKeyHash> blocks_;
+    uint64_t hits_;
+    uint64_t misses_;
+    mutable std::mutex mutex_;
+};
+
+/**
+ * @brief 直接IO管理器
+ *
+ * 使用O_DIRECT打开文件，数据不经过页缓存。写入时在对齐的缓冲区中拼出完整的块，
+ * 尾部不满一块的部分补零后整块写入（文件末尾因此可能有一段全零数据，恢复时视为文件结束）；
+ * 尾块内容保存在内存中，连续追加不需要先读回尾块。读取按块对齐，小范围读取经过块缓存。
+ * 文件系统不支持O_DIRECT时仍按同样的方式读写，只是会经过页缓存。
+ */
+class DirectIOManager : public IOManager {
+public:
+    /**
+     * @brief 构造函数
+     * @param file_path 文件路径
+     */
+    explicit DirectIOManager(const std::string& file_path);
+
+    ~DirectIOManager() override;
+
+    ssize_t read(void* buf, size_t size, off_t offset) override;
+    ssize_t write(const void* buf, size_t size, off_t offset) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override;
+    int allocate(off_t offset, off_t len) override;
+    int sync() override;
+    int close() override;
+    off_t size() override;
+
+    /**
+     * @brief 是否真正使用了O_DIRECT
+     */
+    bool uses_direct_io() const { return direct_; }
+
+private:
+    struct FreeDeleter {
+        void operator()(uint8_t* p) const { std::free(p); }
+    };
+    using AlignedBuffer = std::unique_ptr<uint8_t[], FreeDeleter>;
+
+    /**
+     * @brief 分配按块对齐的缓冲区
+     */
+    static AlignedBuffer alloc_aligned(size_t size);
+
+    /**
+     * @brief 写入多个缓冲区（调用者持有锁）
+     */
+    ssize_t write_locked(const struct iovec* iov, int iovcnt, off_t offset);
+
+    /**
+     * @brief 读取连续的若干块到对齐缓冲区，超出文件末尾的部分补零（调用者持有锁）
+     * @return 成功返回true
+     */
+    bool read_blocks_locked(uint64_t first_block, size_t count, uint8_t* out, bool use_cache);
+
+    std::string file_path_;     // 文件路径
+    int fd_;                    // 文件描述符
+    bool is_open_;              // 是否已打开
+    bool direct_;               // 是否使用了O_DIRECT
+    uint64_t file_key_;         // 块缓存中区分文件的标识
+    uint64_t size_;             // 文件逻辑大小（本次打开后尾块的补零不计入）
+    AlignedBuffer tail_;        // 最后一个块的内容
+    uint64_t tail_block_;       // tail_对应的块号，无效时为UINT64_MAX
+    std::mutex mutex_;
+};
+
+} // namespace bitcask
@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <shared_mutex>
 
 namespace bitcask {
@@ -18,7 +19,7 @@ public:
     // 重新回到起点
     virtual void rewind() = 0;
 
-    // 根据key查找第一个大于等于的位置
+    // 根据key定位：正向为第一个大于等于key的位置，反向为最后一个小于等于key的位置
     virtual void seek(const Bytes& key) = 0;
 
     // 移动到下一个位置
@@ -27,8 +28,8 @@ public:
     // 检查是否有效
     virtual bool valid() const = 0;
 
-    // 获取当前key
-    virtual Bytes key() const = 0;
+    // 获取当前key，引用在下一次移动迭代器之前有效
+    virtual const Bytes& key() const = 0;
 
     // 获取当前value
     virtual LogRecordPos value() const = 0;
@@ -54,7 +55,7 @@ public:
     // 获取索引中的数据量
     virtual size_t size() const = 0;
 
-    // 创建迭代器
+    // 创建迭代器，迭代器不能比索引存活更久
     virtual std::unique_ptr<IndexIterator> iterator(bool reverse = false) = 0;
 
     // 获取所有keys
@@ -77,6 +78,34 @@ struct BTreeItem {
     }
 };
 
+class BTreeIterator;
+
+// 有序map上打开的游标。删除节点时代替map::erase：有游标停在要删除的节点上时，
+// 把节点从map中摘下交给这些游标保管，游标返回的key引用在它移动之前一直有效
+class BTreeCursors {
+public:
+    using Tree = std::map<Bytes, LogRecordPos>;
+
+    // 删除it所在的节点（调用者持有索引的写锁）
+    void erase(Tree& tree, Tree::const_iterator it);
+
+    // 清空map（调用者持有索引的写锁）
+    void clear(Tree& tree);
+
+    // 删除版本号，每次删除加一，游标据此判断位置是否需要重新定位
+    uint64_t version() const { return version_; }
+
+private:
+    friend class BTreeIterator;
+
+    // 把it所在的节点摘下交给停在上面的游标，没有游标停在上面时返回false（调用者持有mutex_）
+    bool park(Tree& tree, Tree::const_iterator it);
+
+    std::mutex mutex_;                      // 保护cursors_
+    std::vector<BTreeIterator*> cursors_;
+    uint64_t version_ = 0;
+};
+
 // BTree索引实现
 class BTreeIndex : public Indexer {
 public:
@@ -94,25 +123,46 @@ public:
 private:
     std::map<Bytes, LogRecordPos> tree_;
     mutable std::shared_mutex mutex_;
+    BTreeCursors cursors_;          // 打开的迭代器，删除节点都经过这里
 };
 
-// BTree迭代器实现
+// BTree迭代器实现：游标直接在map上移动，key直接引用map节点，不复制数据。
+// 每次操作持有索引的共享锁；插入不会使map的迭代器失效，
+// 删除会增加删除版本号，版本变化后从当前key重新定位（O(log n)）。
 class BTreeIterator : public IndexIterator {
 public:
-    BTreeIterator(const std::map<Bytes, LogRecordPos>& tree, bool reverse);
-    ~BTreeIterator() override = default;
+    BTreeIterator(const std::map<Bytes, LogRecordPos>& tree, std::shared_mutex& mutex,
+                  BTreeCursors& cursors, bool reverse);
+    ~BTreeIterator() override;
 
     void rewind() override;
     void seek(const Bytes& key) override;
     void next() override;
     bool valid() const override;
-    Bytes key() const override;
+    const Bytes& key() const override;
     LogRecordPos value() const override;
     void close() override;
 
 private:
-    std::vector<std::pair<Bytes, LogRecordPos>> items_;
-    size_t current_index_;
+    using Tree = std::map<Bytes, LogRecordPos>;
+
+    // 正向定位到第一个大于（inclusive时大于等于）key的位置，
+    // 反向定位到最后一个小于（inclusive时小于等于）key的位置（调用者持有锁）
+    void position_at(const Bytes& key, bool inclusive);
+
+    // 停在it_所在的节点上（调用者持有锁）
+    void load(bool found);
+
+    friend class BTreeCursors;
+
+    const Tree& tree_;
+    std::shared_mutex& mutex_;
+    BTreeCursors& cursors_;
+    uint64_t version_;          // 定位时的删除版本号
+    Tree::const_iterator it_;
+    const Bytes* key_;          // 当前节点中的key
+    std::shared_ptr<Tree::node_type> parked_;  // 当前节点被删除后由游标保管，key_仍指向其中的key
+    bool valid_;
     bool reverse_;
 };
 
@@ -3,9 +3,18 @@
 #include "common.h"
 #include <memory>
 #include <string>
+#include <sys/uio.h>
 
 namespace bitcask {
 
+// 批量读取中的单个请求
+struct IORequest {
+    void* buf;          // 数据缓冲区
+    size_t size;        // 读取大小
+    off_t offset;       // 文件偏移
+    ssize_t result;     // 实际读取的字节数，-1表示错误
+};
+
 // IO管理器接口（统一接口）
 class IOManager {
 public:
@@ -17,6 +26,15 @@ public:
     // 写入数据到指定位置
     virtual ssize_t write(const void* buf, size_t size, off_t offset) = 0;
 
+    // 将多个缓冲区依次写入指定位置（默认逐个调用write）
+    virtual ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset);
+
+    // 批量读取，结果写入每个请求的result（默认逐个调用read）
+    virtual void read_batch(IORequest* reqs, size_t count);
+
+    // 预分配磁盘空间，不改变文件大小（默认不做任何事）
+    virtual int allocate(off_t offset, off_t len);
+
     // 同步数据到磁盘
     virtual int sync() = 0;
 
@@ -35,16 +53,39 @@ public:
 
     ssize_t read(void* buf, size_t size, off_t offset) override;
     ssize_t write(const void* buf, size_t size, off_t offset) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override;
+    int allocate(off_t offset, off_t len) override;
     int sync() override;
     int close() override;
     off_t size() override;
 
-private:
+protected:
     std::string file_path_;
     int fd_;
     bool is_open_;
 };
 
+class RateLimiter;
+
+// 限速的IO管理器：包装另一个IO管理器，读写前先向共享的限速器申请额度（用于merge和备份）
+class RateLimitedIOManager : public IOManager {
+public:
+    RateLimitedIOManager(std::unique_ptr<IOManager> inner, std::shared_ptr<RateLimiter> limiter);
+
+    ssize_t read(void* buf, size_t size, off_t offset) override;
+    ssize_t write(const void* buf, size_t size, off_t offset) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override;
+    void read_batch(IORequest* reqs, size_t count) override;
+    int allocate(off_t offset, off_t len) override;
+    int sync() override;
+    int close() override;
+    off_t size() override;
+
+private:
+    std::unique_ptr<IOManager> inner_;
+    std::shared_ptr<RateLimiter> limiter_;
+};
+
 // 创建IO管理器的工厂函数
 std::unique_ptr<IOManager> create_io_manager(const std::string& file_path, IOType type);
 
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "io_manager.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bitcask {
+
+// 提交给io_uring的一次读写操作
+struct IOUringOp {
+    int fd;                     // 文件描述符
+    bool write;                 // true为写，false为读
+    const struct iovec* iov;    // 数据缓冲区
+    unsigned iovcnt;            // 缓冲区个数
+    off_t offset;               // 文件偏移
+    ssize_t result;             // 实际读写的字节数，-1表示错误
+    int error;                  // 失败时的errno
+};
+
+/**
+ * @brief 进程内共享的io_uring实例
+ *
+ * 所有IOUringIOManager共用一个提交/完成队列，一批请求只需一次io_uring_enter，
+ * 多个请求可以同时在设备上排队。直接使用系统调用，不依赖liburing。
+ * 锁只在填写提交队列和收割完成事件时持有：同一时刻由一个线程在锁外阻塞等待完成事件，
+ * 收割时按user_data把结果分发给各自的请求并唤醒等待的线程，
+ * 所以多个线程的请求可以同时在设备上排队，互不等待对方的整批完成。
+ */
+class IOUring {
+public:
+    /**
+     * @brief 获取共享的io_uring实例
+     * @return 内核不支持io_uring时返回nullptr
+     */
+    static IOUring* shared();
+
+    ~IOUring();
+
+    /**
+     * @brief 提交一批读写操作并等待全部完成
+     * @param ops 操作数组，完成后写入每个操作的result
+     * @param count 操作个数
+     * @return ring不可用时返回false，调用者应回退到同步IO；
+     *         返回false前已提交的操作都已完成，ops中的缓冲区不再被内核访问
+     */
+    bool submit(IOUringOp* ops, size_t count);
+
+private:
+    explicit IOUring(unsigned entries);
+
+    /**
+     * @brief 创建ring并映射提交/完成队列
+     * @return 成功返回true，失败返回false
+     */
+    bool init();
+
+    /**
+     * @brief 解除映射并关闭ring
+     */
+    void cleanup();
+
+    /**
+     * @brief 把提交队列中从tail开始的count个请求交给内核，没有交出的请求从队列中撤回
+     * @return 内核接受的请求数，出错时errno为出错原因（调用者持有锁）
+     */
+    unsigned enter_submit(unsigned tail, unsigned count, int& error);
+
+    /**
+     * @brief 等待完成事件：没有其他线程在等待时自己在锁外等待并收割，否则等待被唤醒
+     * @param lock 持有的锁，返回时仍然持有
+     */
+    void wait_completions(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * @brief 收割完成队列中的所有事件并分发给对应的请求（调用者持有锁）
+     */
+    void reap_locked();
+
+    unsigned entries_;              // 请求的队列深度
+    int ring_fd_;                   // io_uring文件描述符
+    bool broken_;                   // 出现无法恢复的错误后不再使用
+
+    void* sq_ptr_;                  // 提交队列映射
+    size_t sq_size_;
+    void* cq_ptr_;                  // 完成队列映射
+    size_t cq_size_;
+    io_uring_sqe* sqes_;            // 提交队列项数组
+    size_t sqes_size_;
+
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    unsigned* sq_array_;
+    unsigned sq_entries_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    io_uring_cqe* cqes_;
+    unsigned cq_entries_;
+
+    std::mutex mutex_;              // 保护提交队列、完成队列的头部和下面的状态
+    std::condition_variable cv_;    // 收割完成事件后唤醒等待的线程
+    bool reaping_;                  // 是否有线程正在锁外等待完成事件
+    unsigned inflight_;             // 已提交未收割的请求数，不超过完成队列的容量
+};
+
+/**
+ * @brief 基于io_uring的IO管理器
+ *
+ * 读写通过共享的io_uring提交，read_batch一次提交多个读请求。
+ * 内核不支持io_uring时退化为FileIOManager的pread/pwrite。
+ */
+class IOUringIOManager : public FileIOManager {
+public:
+    /**
+     * @brief 构造函数
+     * @param file_path 文件路径
+     */
+    explicit IOUringIOManager(const std::string& file_path);
+
+    ssize_t read(void* buf, size_t size, off_t offset) override;
+    ssize_t write(const void* buf, size_t size, off_t offset) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override;
+    void read_batch(IORequest* reqs, size_t count) override;
+
+    /**
+     * @brief 是否真正使用了io_uring
+     * @return 回退到pread/pwrite时返回false
+     */
+    bool uses_io_uring() const { return ring_ != nullptr; }
+
+private:
+    IOUring* ring_;             // 共享的io_uring，不可用时为nullptr
+
+    /**
+     * @brief 提交单个操作，ring不可用时返回false
+     */
+    bool submit_one(bool write, const struct iovec* iov, int iovcnt, off_t offset, ssize_t& result);
+};
+
+} // namespace bitcask
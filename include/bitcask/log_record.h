@@ -51,13 +51,22 @@ struct LogRecord {
     LogRecord() : type(LogRecordType::NORMAL) {}
     LogRecord(const Bytes& k, const Bytes& v, LogRecordType t = LogRecordType::NORMAL)
         : key(k), value(v), type(t) {}
+    LogRecord(Bytes&& k, Bytes&& v, LogRecordType t = LogRecordType::NORMAL)
+        : key(std::move(k)), value(std::move(v)), type(t) {}
 
     // 编码日志记录，返回编码后的数据和大小
     std::pair<Bytes, size_t> encode() const;
 
-    // 计算CRC值
+    // 只编码头部（CRC覆盖头部、key和value），buf至少MAX_LOG_RECORD_HEADER_SIZE字节
+    // 返回头部长度；key和value可直接从记录中取出，与头部一起分散写入
+    size_t encode_header(uint8_t* buf) const;
+
+    // 计算CRC值（CRC32C）
     uint32_t get_crc() const;
 
+    // 校验从文件中读到的CRC值，旧版本写入的CRC32（IEEE）校验值也视为有效
+    bool verify_crc(uint32_t crc) const;
+
     // 获取编码后的大小
     size_t encoded_size() const;
 };
@@ -73,6 +82,21 @@ struct ReadLogRecord {
 
 // 解码日志记录头部
 std::pair<LogRecordHeader, size_t> decode_log_record_header(const Bytes& data);
+std::pair<LogRecordHeader, size_t> decode_log_record_header(const uint8_t* data, size_t size);
+
+// 校验一条完整编码的日志记录（从CRC开始），旧版本写入的CRC32（IEEE）校验值也视为有效
+bool verify_encoded_log_record(const uint8_t* data, size_t size);
+
+// 同步标记记录：固定的key、空value，编码后的字节是常量，可以在文件中直接搜索
+const LogRecord& sync_marker_record();
+const Bytes& encoded_sync_marker();
+
+// 填充记录编码后的最小长度
+static const size_t MIN_PADDING_RECORD_SIZE = 7;
+
+// 编码后正好size字节的填充记录（同步标记类型，扫描和恢复时跳过），用来覆盖写入失败留下的区域
+// @throws BitcaskException size小于MIN_PADDING_RECORD_SIZE时抛出
+LogRecord padding_record(size_t size);
 
 // 计算日志记录CRC值
 uint32_t get_log_record_crc(const LogRecord& record, const Bytes& header);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "io_manager.h"
+#include <memory>
 #include <string>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -96,4 +97,45 @@ private:
     bool extend_file(size_t size);
 };
 
+/**
+ * @brief 只读内存映射
+ * 
+ * 以PROT_READ映射文件，供封存后不再写入的数据文件使用。
+ * 通过shared_ptr共享，最后一个持有者释放时才解除映射。
+ */
+class ReadOnlyMapping {
+public:
+    /**
+     * @brief 映射文件的前size字节
+     * @param file_name 文件名
+     * @param size 映射大小
+     * @return 映射对象，size为0或映射失败时返回nullptr
+     */
+    static std::shared_ptr<const ReadOnlyMapping> open(const std::string& file_name, size_t size);
+
+    /**
+     * @brief 析构函数，解除映射
+     */
+    ~ReadOnlyMapping();
+
+    ReadOnlyMapping(const ReadOnlyMapping&) = delete;
+    ReadOnlyMapping& operator=(const ReadOnlyMapping&) = delete;
+
+    /**
+     * @brief 映射的起始地址
+     */
+    const uint8_t* data() const { return data_; }
+
+    /**
+     * @brief 映射的大小
+     */
+    size_t size() const { return size_; }
+
+private:
+    ReadOnlyMapping(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    const uint8_t* data_;       // 映射的内存地址
+    size_t size_;               // 映射的大小
+};
+
 } // namespace bitcask
@@ -15,6 +15,18 @@ struct Options {
     bool mmap_at_startup;                  // 启动时是否使用mmap
     float data_file_merge_ratio;           // 数据文件合并阈值
     bool strict_sync;                      // 是否严格执行sync（测试环境可设为false）
+    uint32_t write_buffer_size;            // 活跃文件的用户态追加缓冲区大小（0表示不缓冲）
+    bool background_file_rotation;         // 后台预创建下一个数据文件，旧文件在后台同步
+    IOType io_type;                        // 数据文件的IO类型（启动时使用mmap的话加载完成后切换为该类型）
+    bool mmap_sealed_files;                // 对不再写入的旧数据文件建立只读映射（读取和get_view直接使用映射）
+    uint64_t value_cache_size;             // 值缓存容量（字节），按(文件ID, 偏移)缓存读到的值，0表示不启用
+    uint32_t recovery_threads;             // 启动时并发扫描数据文件重建索引的线程数，0或1表示在当前线程中逐个扫描
+    bool data_file_hints;                  // 后台为每个封存的数据文件生成提示文件，启动时读提示文件代替重放数据
+                                           // （需要background_file_rotation）
+    uint32_t sync_marker_interval;         // 数据文件中每隔多少字节写一个同步标记，扫描遇到损坏时跳到下一个标记（0表示不写）
+    float merge_file_garbage_ratio;        // merge只重写失效数据比例不低于该值的旧文件（0表示重写所有含失效数据的旧文件）
+    uint64_t background_io_rate;           // merge和备份的读写速率上限（字节/秒），0表示不限速
+    uint32_t background_io_latency_target_us; // 前台get/put延迟目标（微秒），超过时后台IO自动降速（0表示固定速率）
 
     // 默认配置
     static Options default_options() {
@@ -27,6 +39,17 @@ struct Options {
         opts.mmap_at_startup = true;
         opts.data_file_merge_ratio = 0.5f;
         opts.strict_sync = false;  // 默认为false，更适合测试环境
+        opts.write_buffer_size = 0;
+        opts.background_file_rotation = true;
+        opts.io_type = IOType::STANDARD_FIO;
+        opts.mmap_sealed_files = true;
+        opts.value_cache_size = 0;
+        opts.recovery_threads = 4;
+        opts.data_file_hints = true;
+        opts.sync_marker_interval = 64 * 1024;
+        opts.merge_file_garbage_ratio = 0.0f;
+        opts.background_io_rate = 0;
+        opts.background_io_latency_target_us = 0;
         return opts;
     }
 };
@@ -35,8 +58,11 @@ struct Options {
 struct IteratorOptions {
     Bytes prefix;           // 前缀过滤
     bool reverse;           // 是否反向迭代
+    Bytes lower_bound;      // 范围下界（包含），为空表示不限
+    Bytes upper_bound;      // 范围上界（不包含），为空表示不限
+    size_t limit;           // rewind或seek之后最多返回的key数，0表示不限
 
-    IteratorOptions() : reverse(false) {}
+    IteratorOptions() : reverse(false), limit(0) {}
 };
 
 // 批量写入配置选项
@@ -60,7 +86,43 @@ struct Stat {
     int64_t reclaimable_size;   // 可回收空间大小
     int64_t disk_size;          // 磁盘占用大小
 
-    Stat() : key_num(0), data_file_num(0), reclaimable_size(0), disk_size(0) {}
+    // 组提交（sync_writes）统计
+    uint64_t sync_group_num;            // 已完成的组提交次数
+    uint64_t sync_group_records;        // 组提交写入的记录总数
+    uint32_t sync_group_max_size;       // 单组最大记录数
+    double sync_group_avg_size;         // 平均每组记录数
+    double sync_group_avg_latency_us;   // 平均每组耗时（写入+同步，微秒）
+    uint64_t sync_group_max_latency_us; // 单组最大耗时（微秒）
+
+    // 值缓存统计（未启用时为0）
+    uint64_t value_cache_hits;          // 命中次数
+    uint64_t value_cache_misses;        // 未命中次数
+    uint64_t value_cache_usage;         // 已使用的字节数
+
+    // 启动时扫描数据文件发现的损坏
+    uint64_t corrupted_ranges;          // 跳过的损坏区间数
+    uint64_t corrupted_bytes;           // 跳过的损坏字节数
+    uint64_t truncated_tail_bytes;      // 活跃文件末尾被截掉的不完整记录字节数
+
+    Stat() : key_num(0), data_file_num(0), reclaimable_size(0), disk_size(0),
+             sync_group_num(0), sync_group_records(0), sync_group_max_size(0),
+             sync_group_avg_size(0), sync_group_avg_latency_us(0),
+             sync_group_max_latency_us(0), value_cache_hits(0), value_cache_misses(0),
+             value_cache_usage(0), corrupted_ranges(0), corrupted_bytes(0), truncated_tail_bytes(0) {}
+};
+
+// 单个数据文件的空间统计
+struct DataFileStat {
+    uint32_t file_id;           // 文件ID
+    uint64_t size;              // 已写入的字节数
+    uint64_t dead_bytes;        // 其中已被覆盖或删除的字节数
+
+    DataFileStat() : file_id(0), size(0), dead_bytes(0) {}
+
+    // 失效数据比例
+    double garbage_ratio() const {
+        return size == 0 ? 0.0 : static_cast<double>(dead_bytes) / static_cast<double>(size);
+    }
 };
 
 }  // namespace bitcask
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace bitcask {
+
+/**
+ * @brief 后台IO（merge、备份）的令牌桶限速器
+ *
+ * 令牌按速率连续补充，桶容量为一个调整周期的量。请求的字节数超过现有令牌时先记账，
+ * 在锁外睡眠到欠下的令牌补齐为止，所以单个大请求也不会卡死。
+ * 设置了延迟目标时为自适应模式：前台get/put报告自己的延迟，
+ * 每个调整周期内超过目标的样本多于1%时速率减半，否则按上限的1/10逐步恢复。
+ * 只在有后台任务使用限速器（ActiveScope存在）时采样前台延迟。
+ */
+class RateLimiter {
+public:
+    /**
+     * @brief 构造函数
+     * @param bytes_per_sec 速率上限（字节/秒），必须大于0
+     * @param latency_target_us 前台延迟目标（微秒），0表示不自适应
+     */
+    explicit RateLimiter(uint64_t bytes_per_sec, uint64_t latency_target_us = 0);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * @brief 申请bytes字节的IO额度，令牌不足时阻塞
+     */
+    void request(size_t bytes);
+
+    /**
+     * @brief 当前速率（字节/秒），自适应模式下随前台延迟变化
+     */
+    uint64_t rate() const { return rate_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 累计通过的字节数
+     */
+    uint64_t total_bytes() const { return total_bytes_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 是否需要前台报告延迟（自适应模式且有后台任务正在进行）
+     */
+    bool sampling() const {
+        return latency_target_us_ > 0 && active_.load(std::memory_order_relaxed) > 0;
+    }
+
+    /**
+     * @brief 报告一次前台操作的延迟（微秒）
+     */
+    void report_latency(uint64_t latency_us);
+
+    /**
+     * @brief 后台任务使用限速器期间持有，期间前台操作采样延迟
+     */
+    class ActiveScope {
+    public:
+        explicit ActiveScope(RateLimiter* limiter);
+        ~ActiveScope();
+
+        ActiveScope(const ActiveScope&) = delete;
+        ActiveScope& operator=(const ActiveScope&) = delete;
+
+    private:
+        RateLimiter* limiter_;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // 补充令牌，到了调整周期时根据前台延迟调整速率（调用者持有锁）
+    void refill_locked(Clock::time_point now);
+
+    const uint64_t max_rate_;
+    const uint64_t min_rate_;
+    const uint64_t latency_target_us_;
+    std::atomic<uint64_t> rate_;
+    std::atomic<uint64_t> total_bytes_;
+    std::atomic<int> active_;
+
+    std::mutex mutex_;                  // 保护令牌和调整周期
+    double tokens_;                     // 现有令牌，欠账时为负
+    Clock::time_point last_refill_;
+    Clock::time_point period_start_;
+
+    // 当前调整周期内的前台延迟样本
+    std::atomic<uint64_t> samples_;
+    std::atomic<uint64_t> slow_samples_;
+};
+
+}  // namespace bitcask
@@ -5,6 +5,7 @@
 #include <memory>
 #include <random>
 #include <mutex>
+#include <shared_mutex>
 
 namespace bitcask {
 
@@ -35,12 +36,15 @@ public:
     void close() override;
 
 private:
+    friend class SkipListIterator;
+
     static const int MAX_LEVEL = 16;
     static constexpr float SKIPLIST_P = 0.25f;
     
     std::shared_ptr<SkipListNode> header_;
     int level_;
-    mutable std::mutex mutex_;
+    mutable std::shared_mutex mutex_;    // 查询共享持有，修改独占持有
+    uint64_t erase_version_;             // 每次删除加一，迭代器据此判断后继指针是否可信
     std::mt19937 rng_;
     
     // 生成随机层级
@@ -52,12 +56,24 @@ private:
     // 查找节点
     std::shared_ptr<SkipListNode> find_node(const Bytes& key, 
                                            std::vector<std::shared_ptr<SkipListNode>>& update) const;
+
+    // 第一个大于（inclusive时大于等于）key的节点，不存在时返回nullptr（调用者持有锁）
+    std::shared_ptr<SkipListNode> find_after(const Bytes& key, bool inclusive) const;
+
+    // 最后一个小于（inclusive时小于等于）key的节点，不存在时返回nullptr（调用者持有锁）
+    std::shared_ptr<SkipListNode> find_before(const Bytes& key, bool inclusive) const;
+
+    // 最后一个节点，索引为空时返回nullptr（调用者持有锁）
+    std::shared_ptr<SkipListNode> find_last() const;
 };
 
-// SkipList迭代器
+// SkipList迭代器：游标持有当前节点，沿第0层前进；反向时每一步从高层向下
+// 查找前驱（O(log n)），不复制数据。节点的key不会修改，所以key()不需要复制。
+// 每次操作持有索引的共享锁；删除会增加删除版本号，版本变化后当前节点
+// 可能已被摘除，从当前key重新定位。
 class SkipListIterator : public IndexIterator {
 public:
-    SkipListIterator(std::shared_ptr<SkipListNode> header, const IteratorOptions& options);
+    SkipListIterator(const SkipListIndex& index, bool reverse);
     ~SkipListIterator() = default;
 
     // IndexIterator接口实现
@@ -65,26 +81,15 @@ public:
     void seek(const Bytes& key) override;
     void next() override;
     bool valid() const override;
-    Bytes key() const override;
+    const Bytes& key() const override;
     LogRecordPos value() const override;
     void close() override;
 
 private:
-    std::shared_ptr<SkipListNode> header_;
-    std::shared_ptr<SkipListNode> current_;
-    IteratorOptions options_;
-    std::vector<std::pair<Bytes, LogRecordPos>> items_;
-    size_t current_index_;
-    bool use_items_;
-    
-    // 初始化项目列表（用于反向迭代）
-    void init_items();
-    
-    // 检查键是否匹配前缀
-    bool key_matches_prefix(const Bytes& key) const;
-    
-    // 比较键值
-    int compare_keys(const Bytes& a, const Bytes& b) const;
+    const SkipListIndex& index_;
+    std::shared_ptr<SkipListNode> node_;    // 持有当前节点，被删除后key仍然有效
+    uint64_t version_;                      // 定位时的删除版本号
+    bool reverse_;
 };
 
 }  // namespace bitcask
@@ -5,6 +5,9 @@
 #include <vector>
 
 namespace bitcask {
+
+class RateLimiter;
+
 namespace utils {
 
 // 计算目录大小
@@ -13,12 +16,29 @@ uint64_t dir_size(const std::string& dir_path);
 // 获取可用磁盘空间
 uint64_t available_disk_size();
 
-// 复制文件
-void copy_file(const std::string& src, const std::string& dst);
+// 复制文件（覆盖已有的dst）：优先reflink，其次copy_file_range，都不支持时用read/write；
+// 给出limiter时每复制一块先申请额度
+void copy_file(const std::string& src, const std::string& dst, RateLimiter* limiter = nullptr);
+
+// 把已打开文件的前length字节复制到dst（覆盖已有的dst），文件更短时复制到末尾；
+// 从文件描述符复制，调用者打开之后源文件被改名替换也不影响
+void copy_file_prefix(int src_fd, const std::string& dst, uint64_t length, RateLimiter* limiter = nullptr);
+
+// 为src创建硬链接dst（覆盖已有的dst），跨文件系统等无法链接时返回false
+bool link_file(const std::string& src, const std::string& dst);
 
-// 移动文件
+// 两个路径是否指向同一个文件（同一设备上的同一inode）
+bool same_file(const std::string& a, const std::string& b);
+
+// 移动文件：同一文件系统内原子改名（覆盖已有的dst），跨文件系统时复制后删除
 void move_file(const std::string& src, const std::string& dst);
 
+// 将文件内容同步到磁盘（文件不存在时忽略，打开或同步失败时抛出异常）
+void sync_file(const std::string& file_path);
+
+// 同步目录项，使目录中文件的创建、改名和删除落盘（目录不存在时忽略）
+void sync_dir(const std::string& dir_path);
+
 // 删除目录
 bool remove_directory(const std::string& dir_path);
 
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "common.h"
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace bitcask {
+
+/**
+ * @brief 值缓存的键
+ *
+ * 数据文件只追加，同一个(文件ID, 偏移)上的记录不会改变；merge重写文件后
+ * 文件ID和偏移会被复用，所以再加上代数，merge之后代数加一，旧条目自然失效。
+ */
+struct ValueCacheKey {
+    uint64_t epoch;     // 数据文件代数
+    uint32_t fid;       // 文件ID
+    uint64_t offset;    // 记录偏移
+
+    bool operator==(const ValueCacheKey& other) const {
+        return epoch == other.epoch && fid == other.fid && offset == other.offset;
+    }
+};
+
+/**
+ * @brief 分片的值缓存
+ *
+ * 按键的哈希分成多个分片，每个分片独立加锁，命中时只持有共享锁。
+ * 条目按值的字节数计费，分片用量超过容量时按CLOCK算法淘汰：
+ * 指针扫过的条目如果最近被访问过则清除访问标记并跳过，否则淘汰。
+ */
+class ValueCache {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 总容量（字节），平均分给各个分片
+     * @param num_shards 分片数
+     */
+    explicit ValueCache(size_t capacity, size_t num_shards = 16);
+
+    /**
+     * @brief 查找值，命中时复制到value
+     * @return 命中返回true
+     */
+    bool get(const ValueCacheKey& key, Bytes& value);
+
+    /**
+     * @brief 放入一个值，超出分片容量时淘汰；单个值超过分片容量时不缓存
+     */
+    void put(const ValueCacheKey& key, const Bytes& value);
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+    /**
+     * @brief 当前已计费的字节数
+     */
+    size_t usage() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const ValueCacheKey& key) const {
+            uint64_t h = (key.epoch * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(key.fid) << 40) ^ key.offset;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Entry {
+        ValueCacheKey key;
+        std::shared_ptr<const Bytes> value;
+        size_t charge;                          // 计费字节数
+        std::atomic<bool> referenced;           // CLOCK访问标记，命中时在共享锁下置位
+
+        Entry(const ValueCacheKey& k, std::shared_ptr<const Bytes> v, size_t c)
+            : key(k), value(std::move(v)), charge(c), referenced(false) {}
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<ValueCacheKey, size_t, KeyHash> index;  // 键到槽位
+        std::vector<std::unique_ptr<Entry>> slots;                 // CLOCK环，空槽位为nullptr
+        std::vector<size_t> free_slots;                            // 空槽位
+        size_t hand = 0;                                           // CLOCK指针
+        size_t usage = 0;                                          // 已计费字节数
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+
+    Shard& shard_for(const ValueCacheKey& key);
+
+    // 淘汰条目直到分片能再放下charge字节（调用者持有分片独占锁）
+    void evict_locked(Shard& shard, size_t charge);
+
+    size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace bitcask
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace bitcask {
+
+/**
+ * @brief 值的只读视图
+ *
+ * 值位于已映射的封存文件中时，视图直接指向映射内存并持有映射的引用计数，
+ * 不分配内存也不拷贝数据；所有视图释放后映射才会解除。
+ * 值不在映射中时（如活跃文件），视图持有读出来的一份值。
+ */
+class ValueView {
+public:
+    ValueView() : data_(nullptr), size_(0) {}
+
+    /**
+     * @brief 构造视图
+     * @param owner 数据的持有者，视图存在期间保证data有效
+     * @param data 数据起始地址
+     * @param size 数据长度
+     */
+    ValueView(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+        : owner_(std::move(owner)), data_(data), size_(size) {}
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const uint8_t* begin() const { return data_; }
+    const uint8_t* end() const { return data_ + size_; }
+
+    /**
+     * @brief 拷贝出一份值
+     */
+    Bytes to_bytes() const { return Bytes(begin(), end()); }
+
+private:
+    std::shared_ptr<const void> owner_;     // 映射或值的持有者
+    const uint8_t* data_;                   // 数据起始地址
+    size_t size_;                           // 数据长度
+};
+
+}  // namespace bitcask
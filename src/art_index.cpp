@@ -209,7 +209,7 @@ void ARTNode256::remove_child(uint8_t key) {
 ARTIndex::ARTIndex() : root_(nullptr), size_(0) {}
 
 std::unique_ptr<LogRecordPos> ARTIndex::put(const Bytes& key, const LogRecordPos& pos) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     
     // 使用简单的map作为后备存储确保正确性
     auto it = simple_map_.find(key);
@@ -225,7 +225,7 @@ std::unique_ptr<LogRecordPos> ARTIndex::put(const Bytes& key, const LogRecordPos
 }
 
 std::unique_ptr<LogRecordPos> ARTIndex::get(const Bytes& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     
     // 使用简单的map作为后备存储确保正确性
     auto it = simple_map_.find(key);
@@ -237,13 +237,13 @@ std::unique_ptr<LogRecordPos> ARTIndex::get(const Bytes& key) {
 }
 
 std::pair<std::unique_ptr<LogRecordPos>, bool> ARTIndex::remove(const Bytes& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     
     // 使用简单的map作为后备存储确保正确性
     auto it = simple_map_.find(key);
     if (it != simple_map_.end()) {
         auto old_value = std::make_unique<LogRecordPos>(it->second);
-        simple_map_.erase(it);
+        cursors_.erase(simple_map_, it);
         size_--;
         return {std::move(old_value), true};
     }
@@ -252,20 +252,17 @@ std::pair<std::unique_ptr<LogRecordPos>, bool> ARTIndex::remove(const Bytes& key
 }
 
 size_t ARTIndex::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     return size_;
 }
 
 std::unique_ptr<IndexIterator> ARTIndex::iterator(bool reverse) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // 使用BTree迭代器作为后备，因为我们使用map存储
-    std::map<Bytes, LogRecordPos> tree_map(simple_map_.begin(), simple_map_.end());
-    return std::make_unique<BTreeIterator>(tree_map, reverse);
+    // 游标直接在后备map上移动，迭代器每次操作自己加锁
+    return std::make_unique<ARTIterator>(simple_map_, mutex_, cursors_, reverse);
 }
 
 std::vector<Bytes> ARTIndex::list_keys() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     
     // 使用简单的map作为后备存储
     std::vector<Bytes> keys;
@@ -279,7 +276,7 @@ std::vector<Bytes> ARTIndex::list_keys() {
 }
 
 void ARTIndex::close() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     root_ = nullptr;
     size_ = 0;
 }
@@ -560,140 +557,4 @@ std::shared_ptr<ARTLeaf> ARTIndex::get_leaf(std::shared_ptr<ARTNode> node) {
     return std::dynamic_pointer_cast<ARTLeaf>(node);
 }
 
-// ARTIterator实现
-ARTIterator::ARTIterator(std::shared_ptr<ARTNode> root, const IteratorOptions& options)
-    : root_(root), options_(options), current_index_(0) {
-    collect_items();
-    rewind();
-}
-
-void ARTIterator::rewind() {
-    current_index_ = 0;
-    
-    // 跳过不匹配前缀的项目
-    while (valid() && !key_matches_prefix(key())) {
-        current_index_++;
-    }
-}
-
-void ARTIterator::seek(const Bytes& key) {
-    current_index_ = 0;
-    
-    // 找到第一个大于等于key的位置
-    while (valid() && this->key() < key) {
-        current_index_++;
-    }
-    
-    // 检查前缀匹配
-    while (valid() && !key_matches_prefix(this->key())) {
-        current_index_++;
-    }
-}
-
-void ARTIterator::next() {
-    if (valid()) {
-        current_index_++;
-        
-        // 跳过不匹配前缀的项目
-        while (valid() && !key_matches_prefix(key())) {
-            current_index_++;
-        }
-    }
-}
-
-bool ARTIterator::valid() const {
-    return current_index_ < items_.size();
-}
-
-Bytes ARTIterator::key() const {
-    if (!valid()) {
-        throw BitcaskException("Iterator is not valid");
-    }
-    return items_[current_index_].first;
-}
-
-LogRecordPos ARTIterator::value() const {
-    if (!valid()) {
-        throw BitcaskException("Iterator is not valid");
-    }
-    return items_[current_index_].second;
-}
-
-void ARTIterator::close() {
-    items_.clear();
-    current_index_ = 0;
-}
-
-void ARTIterator::collect_items() {
-    items_.clear();
-    
-    // 简单实现：收集所有项目然后排序
-    std::function<void(std::shared_ptr<ARTNode>)> collect;
-    collect = [&](std::shared_ptr<ARTNode> node) {
-        if (!node) return;
-        
-        if (std::dynamic_pointer_cast<ARTLeaf>(node)) {
-            auto leaf = std::dynamic_pointer_cast<ARTLeaf>(node);
-            items_.emplace_back(leaf->key, leaf->value);
-            return;
-        }
-        
-        // 遍历子节点
-        switch (node->type) {
-            case ARTNodeType::NODE_4: {
-                auto node4 = std::dynamic_pointer_cast<ARTNode4>(node);
-                for (int i = 0; i < node4->num_children; i++) {
-                    collect(node4->children[i]);
-                }
-                break;
-            }
-            case ARTNodeType::NODE_16: {
-                auto node16 = std::dynamic_pointer_cast<ARTNode16>(node);
-                for (int i = 0; i < node16->num_children; i++) {
-                    collect(node16->children[i]);
-                }
-                break;
-            }
-            case ARTNodeType::NODE_48: {
-                auto node48 = std::dynamic_pointer_cast<ARTNode48>(node);
-                for (int i = 0; i < 48; i++) {
-                    if (node48->children[i]) {
-                        collect(node48->children[i]);
-                    }
-                }
-                break;
-            }
-            case ARTNodeType::NODE_256: {
-                auto node256 = std::dynamic_pointer_cast<ARTNode256>(node);
-                for (int i = 0; i < 256; i++) {
-                    if (node256->children[i]) {
-                        collect(node256->children[i]);
-                    }
-                }
-                break;
-            }
-        }
-    };
-    
-    collect(root_);
-    
-    // 排序
-    std::sort(items_.begin(), items_.end(), 
-              [this](const auto& a, const auto& b) {
-                  return options_.reverse ? a.first > b.first : a.first < b.first;
-              });
-}
-
-bool ARTIterator::key_matches_prefix(const Bytes& key) const {
-    if (options_.prefix.empty()) {
-        return true;
-    }
-    
-    if (key.size() < options_.prefix.size()) {
-        return false;
-    }
-    
-    return std::equal(options_.prefix.begin(), options_.prefix.end(), key.begin());
-}
-
 }  // namespace bitcask
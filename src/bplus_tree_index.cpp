@@ -47,7 +47,7 @@ std::unique_ptr<LogRecordPos> BPlusTreeIndex::get(const Bytes& key) {
     int pos = find_key_position(leaf, key);
     
     if (pos < static_cast<int>(leaf->keys.size()) && 
-        compare_keys(leaf->keys[pos], key) == 0) {
+        compare_keys(*leaf->keys[pos], key) == 0) {
         return std::make_unique<LogRecordPos>(leaf->values[pos]);
     }
     
@@ -69,7 +69,7 @@ std::vector<Bytes> BPlusTreeIndex::list_keys() {
     
     while (current) {
         for (const auto& key : current->keys) {
-            keys.push_back(key);
+            keys.push_back(*key);
         }
         current = current->next;
     }
@@ -102,9 +102,7 @@ size_t BPlusTreeIndex::size() const {
 }
 
 std::unique_ptr<IndexIterator> BPlusTreeIndex::iterator(bool reverse) {
-    IteratorOptions options;
-    options.reverse = reverse;
-    return std::make_unique<BPlusTreeIterator>(root_, options);
+    return std::make_unique<BPlusTreeIterator>(*this, reverse);
 }
 
 void BPlusTreeIndex::sync() {
@@ -180,7 +178,7 @@ void BPlusTreeIndex::serialize_node(const std::shared_ptr<BPlusTreeNode>& node,
     
     // 写入键
     for (const auto& key : node->keys) {
-        serialize_bytes(key, os);
+        serialize_bytes(*key, os);
     }
     
     if (node->type == BPlusNodeType::LEAF) {
@@ -225,7 +223,7 @@ std::shared_ptr<BPlusTreeNode> BPlusTreeIndex::deserialize_node(std::istream& is
     
     // 读取键
     for (uint32_t i = 0; i < key_count && is.good(); i++) {
-        node->keys.push_back(deserialize_bytes(is));
+        node->keys.push_back(std::make_shared<const Bytes>(deserialize_bytes(is)));
     }
     
     if (node->type == BPlusNodeType::LEAF) {
@@ -264,6 +262,45 @@ std::shared_ptr<BPlusTreeNode> BPlusTreeIndex::find_first_leaf() {
     return current;
 }
 
+std::shared_ptr<BPlusTreeNode> BPlusTreeIndex::find_last_leaf() {
+    return find_last_nonempty_leaf(root_);
+}
+
+std::shared_ptr<BPlusTreeNode> BPlusTreeIndex::find_prev_leaf(const Bytes& key) {
+    // 记下路径上每一层选择的子节点
+    std::vector<std::pair<BPlusTreeNode*, int>> path;
+    auto current = root_;
+    while (current->type == BPlusNodeType::INTERNAL) {
+        int pos = find_key_position(current, key);
+        path.emplace_back(current.get(), pos);
+        current = current->children[pos];
+    }
+    
+    // 从最深一层开始，在路径左侧的兄弟子树中从右向左找；删除后留下的空叶子跳过
+    for (auto level = path.rbegin(); level != path.rend(); ++level) {
+        for (int i = level->second - 1; i >= 0; --i) {
+            auto leaf = find_last_nonempty_leaf(level->first->children[i]);
+            if (leaf) {
+                return leaf;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<BPlusTreeNode> BPlusTreeIndex::find_last_nonempty_leaf(const std::shared_ptr<BPlusTreeNode>& node) {
+    if (node->type == BPlusNodeType::LEAF) {
+        return node->keys.empty() ? nullptr : node;
+    }
+    for (auto child = node->children.rbegin(); child != node->children.rend(); ++child) {
+        auto leaf = find_last_nonempty_leaf(*child);
+        if (leaf) {
+            return leaf;
+        }
+    }
+    return nullptr;
+}
+
 std::unique_ptr<LogRecordPos> BPlusTreeIndex::insert_to_leaf(std::shared_ptr<BPlusTreeNode> leaf, 
                                                             const Bytes& key, const LogRecordPos& pos) {
     int insert_pos = find_key_position(leaf, key);
@@ -271,14 +308,15 @@ std::unique_ptr<LogRecordPos> BPlusTreeIndex::insert_to_leaf(std::shared_ptr<BPl
     std::unique_ptr<LogRecordPos> old_pos = nullptr;
     
     if (insert_pos < static_cast<int>(leaf->keys.size()) && 
-        compare_keys(leaf->keys[insert_pos], key) == 0) {
+        compare_keys(*leaf->keys[insert_pos], key) == 0) {
         // 键已存在，更新值
         old_pos = std::make_unique<LogRecordPos>(leaf->values[insert_pos]);
         leaf->values[insert_pos] = pos;
     } else {
         // 插入新键值对
-        leaf->keys.insert(leaf->keys.begin() + insert_pos, key);
+        leaf->keys.insert(leaf->keys.begin() + insert_pos, std::make_shared<const Bytes>(key));
         leaf->values.insert(leaf->values.begin() + insert_pos, pos);
+        modify_version_++;
         
         // 简化：暂时不处理节点分裂，为了确保基本功能正常
         // TODO: 实现节点分裂逻辑
@@ -320,13 +358,14 @@ std::pair<std::unique_ptr<LogRecordPos>, bool> BPlusTreeIndex::delete_from_leaf(
     int pos = find_key_position(leaf, key);
     
     if (pos < static_cast<int>(leaf->keys.size()) && 
-        compare_keys(leaf->keys[pos], key) == 0) {
+        compare_keys(*leaf->keys[pos], key) == 0) {
         
         auto old_pos = std::make_unique<LogRecordPos>(leaf->values[pos]);
         
         leaf->keys.erase(leaf->keys.begin() + pos);
         leaf->values.erase(leaf->values.begin() + pos);
         leaf->is_dirty = true;
+        modify_version_++;
         
         return {std::move(old_pos), true};
     }
@@ -352,7 +391,7 @@ int BPlusTreeIndex::find_key_position(const std::shared_ptr<BPlusTreeNode>& node
     
     while (left < right) {
         int mid = left + (right - left) / 2;
-        if (compare_keys(node->keys[mid], key) < 0) {
+        if (compare_keys(*node->keys[mid], key) < 0) {
             left = mid + 1;
         } else {
             right = mid;
@@ -393,168 +432,115 @@ LogRecordPos BPlusTreeIndex::deserialize_pos(std::istream& is) {
 }
 
 // BPlusTreeIterator实现
-BPlusTreeIterator::BPlusTreeIterator(std::shared_ptr<BPlusTreeNode> root, const IteratorOptions& options)
-    : root_(root), current_leaf_(nullptr), current_index_(0), options_(options), 
-      items_index_(0), use_items_(false) {
-    
-    if (options_.reverse) {
-        init_items();
-        use_items_ = true;
-    }
-    
+BPlusTreeIterator::BPlusTreeIterator(BPlusTreeIndex& index, bool reverse)
+    : index_(index), idx_(0), version_(0), reverse_(reverse) {
     rewind();
 }
 
 void BPlusTreeIterator::rewind() {
-    if (use_items_) {
-        items_index_ = 0;
+    std::lock_guard<std::mutex> lock(index_.mutex_);
+    if (reverse_) {
+        leaf_ = index_.find_last_leaf();
+        idx_ = leaf_ ? leaf_->keys.size() - 1 : 0;
+        load();
     } else {
-        current_leaf_ = find_first_leaf();
-        current_index_ = 0;
-        
-        // 跳过不匹配前缀的键
-        while (valid() && !key_matches_prefix(key())) {
-            next();
-        }
+        leaf_ = index_.find_first_leaf();
+        idx_ = 0;
+        settle_forward();
     }
 }
 
 void BPlusTreeIterator::seek(const Bytes& key) {
-    if (use_items_) {
-        for (size_t i = 0; i < items_.size(); i++) {
-            if (compare_keys(items_[i].first, key) >= 0) {
-                items_index_ = i;
-                return;
-            }
-        }
-        items_index_ = items_.size();
-    } else {
-        // 简化实现：从根开始查找
-        current_leaf_ = find_first_leaf();
-        current_index_ = 0;
-        
-        // 线性查找（在实际应用中应该优化）
-        while (valid() && compare_keys(this->key(), key) < 0) {
-            next();
-        }
-    }
+    std::lock_guard<std::mutex> lock(index_.mutex_);
+    position_at(key, true);
 }
 
 void BPlusTreeIterator::next() {
-    if (use_items_) {
-        items_index_++;
+    if (!leaf_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(index_.mutex_);
+    if (version_ != index_.modify_version_) {
+        // 期间有插入或删除，下标可能已经移动；定位期间保持当前key存活
+        auto key = key_;
+        position_at(*key, false);
+    } else if (reverse_) {
+        settle_backward(idx_, *leaf_->keys[idx_]);
     } else {
-        current_index_++;
-        
-        if (current_leaf_ && current_index_ >= current_leaf_->keys.size()) {
-            current_leaf_ = current_leaf_->next;
-            current_index_ = 0;
-        }
-        
-        // 跳过不匹配前缀的键
-        while (valid() && !key_matches_prefix(key())) {
-            current_index_++;
-            if (current_leaf_ && current_index_ >= current_leaf_->keys.size()) {
-                current_leaf_ = current_leaf_->next;
-                current_index_ = 0;
-            }
-        }
+        idx_++;
+        settle_forward();
     }
 }
 
 bool BPlusTreeIterator::valid() const {
-    if (use_items_) {
-        return items_index_ < items_.size();
-    } else {
-        return current_leaf_ && current_index_ < current_leaf_->keys.size();
-    }
+    return leaf_ != nullptr;
 }
 
-Bytes BPlusTreeIterator::key() const {
-    if (use_items_) {
-        if (items_index_ < items_.size()) {
-            return items_[items_index_].first;
-        }
-    } else {
-        if (current_leaf_ && current_index_ < current_leaf_->keys.size()) {
-            return current_leaf_->keys[current_index_];
-        }
+const Bytes& BPlusTreeIterator::key() const {
+    if (!leaf_) {
+        throw BitcaskException("Iterator is not valid");
     }
-    return Bytes{};
+    return *key_;
 }
 
 LogRecordPos BPlusTreeIterator::value() const {
-    if (use_items_) {
-        if (items_index_ < items_.size()) {
-            return items_[items_index_].second;
-        }
-    } else {
-        if (current_leaf_ && current_index_ < current_leaf_->values.size()) {
-            return current_leaf_->values[current_index_];
-        }
+    if (!leaf_) {
+        throw BitcaskException("Iterator is not valid");
+    }
+    // 读取最新的位置；当前key已被删除时返回定位时的位置
+    std::lock_guard<std::mutex> lock(index_.mutex_);
+    if (version_ == index_.modify_version_) {
+        return leaf_->values[idx_];
     }
-    return LogRecordPos{};
+    auto leaf = index_.find_leaf(*key_);
+    int pos = index_.find_key_position(leaf, *key_);
+    if (pos < static_cast<int>(leaf->keys.size()) && index_.compare_keys(*leaf->keys[pos], *key_) == 0) {
+        return leaf->values[pos];
+    }
+    return pos_;
 }
 
 void BPlusTreeIterator::close() {
-    current_leaf_ = nullptr;
-    items_.clear();
+    leaf_.reset();
+    key_.reset();
 }
 
-std::shared_ptr<BPlusTreeNode> BPlusTreeIterator::find_first_leaf() {
-    auto current = root_;
-    
-    while (current && current->type == BPlusNodeType::INTERNAL) {
-        if (!current->children.empty()) {
-            current = current->children[0];
-        } else {
-            break;
-        }
+void BPlusTreeIterator::position_at(const Bytes& key, bool inclusive) {
+    leaf_ = index_.find_leaf(key);
+    size_t pos = static_cast<size_t>(index_.find_key_position(leaf_, key));
+    bool exact = pos < leaf_->keys.size() && index_.compare_keys(*leaf_->keys[pos], key) == 0;
+    if (!reverse_) {
+        idx_ = exact && !inclusive ? pos + 1 : pos;
+        settle_forward();
+    } else {
+        settle_backward(exact && inclusive ? pos + 1 : pos, key);
     }
-    
-    return current;
 }
 
-void BPlusTreeIterator::init_items() {
-    auto current = find_first_leaf();
-    
-    while (current) {
-        for (size_t i = 0; i < current->keys.size(); i++) {
-            if (key_matches_prefix(current->keys[i])) {
-                items_.emplace_back(current->keys[i], current->values[i]);
-            }
-        }
-        current = current->next;
-    }
-    
-    if (options_.reverse) {
-        std::reverse(items_.begin(), items_.end());
+void BPlusTreeIterator::settle_forward() {
+    while (leaf_ && idx_ >= leaf_->keys.size()) {
+        leaf_ = leaf_->next;
+        idx_ = 0;
     }
+    load();
 }
 
-bool BPlusTreeIterator::key_matches_prefix(const Bytes& key) const {
-    if (options_.prefix.empty()) {
-        return true;
-    }
-    
-    if (key.size() < options_.prefix.size()) {
-        return false;
+void BPlusTreeIterator::settle_backward(size_t idx, const Bytes& bound) {
+    if (leaf_ && idx == 0) {
+        // 前面的叶子中的key都小于bound，find_prev_leaf只返回非空叶子
+        leaf_ = index_.find_prev_leaf(bound);
+        idx = leaf_ ? leaf_->keys.size() : 0;
     }
-    
-    return std::equal(options_.prefix.begin(), options_.prefix.end(), key.begin());
+    idx_ = idx > 0 ? idx - 1 : 0;
+    load();
 }
 
-int BPlusTreeIterator::compare_keys(const Bytes& a, const Bytes& b) const {
-    size_t min_len = std::min(a.size(), b.size());
-    
-    for (size_t i = 0; i < min_len; i++) {
-        if (a[i] < b[i]) return -1;
-        if (a[i] > b[i]) return 1;
+void BPlusTreeIterator::load() {
+    version_ = index_.modify_version_;
+    if (leaf_) {
+        key_ = leaf_->keys[idx_];
+        pos_ = leaf_->values[idx_];
     }
-    
-    if (a.size() < b.size()) return -1;
-    if (a.size() > b.size()) return 1;
-    return 0;
 }
 
 }  // namespace bitcask
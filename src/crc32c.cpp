@@ -0,0 +1,241 @@
+#include "bitcask/crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#define BITCASK_CRC32C_X86 1
+#endif
+
+namespace bitcask {
+namespace crc32c {
+
+namespace {
+
+// 反射后的Castagnoli多项式
+const uint32_t POLY = 0x82F63B78;
+
+// slicing-by-8查表：table[k][i]为字节i后面再跟k个零字节的CRC
+struct SliceTables {
+    uint32_t table[8][256];
+
+    SliceTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; ++j) {
+                crc = (crc & 1) ? (crc >> 1) ^ POLY : crc >> 1;
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][i] = table[0][table[k - 1][i] & 0xFF] ^ (table[k - 1][i] >> 8);
+            }
+        }
+    }
+};
+
+const SliceTables& slice_tables() {
+    static const SliceTables tables;
+    return tables;
+}
+
+// 以下*_raw函数处理的都是未取反的中间状态，取反由extend统一完成
+uint32_t portable_raw(uint32_t crc, const uint8_t* p, size_t n) {
+    const auto& t = slice_tables().table;
+    while (n > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        n--;
+    }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (n >= 8) {
+        uint32_t lo;
+        uint32_t hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        n -= 8;
+    }
+#endif
+    while (n > 0) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        n--;
+    }
+    return crc;
+}
+
+#ifdef BITCASK_CRC32C_X86
+
+// 三路并行时每一路的长度：先按长块处理，剩余部分再按短块处理
+const size_t LONG_BLOCK = 8192;
+const size_t SHORT_BLOCK = 256;
+
+// GF(2)上模多项式的乘法（反射表示），只在计算合并常数时使用
+uint32_t multiply_mod_poly(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^(8*n) mod P：乘上它相当于在数据后面追加n个零字节
+uint32_t shift_constant(size_t n) {
+    uint32_t result = 1u << 31;     // x^0
+    uint32_t square = 1u << 30;     // x^1
+    uint64_t bits = static_cast<uint64_t>(n) * 8;
+    while (bits != 0) {
+        if (bits & 1) {
+            result = multiply_mod_poly(square, result);
+        }
+        square = multiply_mod_poly(square, square);
+        bits >>= 1;
+    }
+    return result;
+}
+
+struct ShiftConstants {
+    uint32_t long_shift;
+    uint32_t short_shift;
+
+    ShiftConstants() : long_shift(shift_constant(LONG_BLOCK)), short_shift(shift_constant(SHORT_BLOCK)) {}
+};
+
+const ShiftConstants& shift_constants() {
+    static const ShiftConstants constants;
+    return constants;
+}
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+__attribute__((target("sse4.2")))
+uint32_t sse42_raw(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+    uint64_t crc64 = crc;
+    while (n >= 8) {
+        crc64 = _mm_crc32_u64(crc64, load64(p));
+        p += 8;
+        n -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (n > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+    return crc;
+}
+
+// 用无进位乘法计算a*b mod P，64位乘积的低32位交给crc32指令归约
+__attribute__((target("sse4.2,pclmul")))
+uint32_t multiply_clmul(uint32_t a, uint32_t b) {
+    __m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(a)),
+                                           _mm_cvtsi32_si128(static_cast<int>(b)), 0x00);
+    product = _mm_slli_epi64(product, 1);
+    uint64_t v = static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+    return _mm_crc32_u32(0, static_cast<uint32_t>(v)) ^ static_cast<uint32_t>(v >> 32);
+}
+
+// 把连续的3*block字节分成三段同时计算，crc32指令的延迟被三条依赖链掩盖，
+// 最后把前两段的结果各自"平移"到段尾再异或合并
+__attribute__((target("sse4.2,pclmul")))
+uint32_t three_way_raw(uint32_t crc, const uint8_t*& p, size_t& n, size_t block, uint32_t shift) {
+    while (n >= 3 * block) {
+        uint64_t crc0 = crc;
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        const uint8_t* end = p + block;
+        while (p < end) {
+            crc0 = _mm_crc32_u64(crc0, load64(p));
+            crc1 = _mm_crc32_u64(crc1, load64(p + block));
+            crc2 = _mm_crc32_u64(crc2, load64(p + 2 * block));
+            p += 8;
+        }
+        crc = multiply_clmul(static_cast<uint32_t>(crc0), shift) ^ static_cast<uint32_t>(crc1);
+        crc = multiply_clmul(crc, shift) ^ static_cast<uint32_t>(crc2);
+        p += 2 * block;
+        n -= 3 * block;
+    }
+    return crc;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+uint32_t sse42_pclmul_raw(uint32_t crc, const uint8_t* p, size_t n) {
+    if (n < 3 * SHORT_BLOCK) {
+        return sse42_raw(crc, p, n);
+    }
+    while ((reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+    const ShiftConstants& constants = shift_constants();
+    crc = three_way_raw(crc, p, n, LONG_BLOCK, constants.long_shift);
+    crc = three_way_raw(crc, p, n, SHORT_BLOCK, constants.short_shift);
+    return sse42_raw(crc, p, n);
+}
+
+#endif  // BITCASK_CRC32C_X86
+
+using RawFunction = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+struct Dispatch {
+    RawFunction function;
+    const char* name;
+    bool hardware;
+};
+
+Dispatch select_implementation() {
+#ifdef BITCASK_CRC32C_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        if (__builtin_cpu_supports("pclmul")) {
+            return {sse42_pclmul_raw, "sse4.2+pclmul", true};
+        }
+        return {sse42_raw, "sse4.2", true};
+    }
+#endif
+    return {portable_raw, "slicing-by-8", false};
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch selected = select_implementation();
+    return selected;
+}
+
+}  // namespace
+
+uint32_t extend(uint32_t crc, const void* data, size_t length) {
+    return ~dispatch().function(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+uint32_t extend_portable(uint32_t crc, const void* data, size_t length) {
+    return ~portable_raw(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+bool hardware_accelerated() {
+    return dispatch().hardware;
+}
+
+const char* implementation() {
+    return dispatch().name;
+}
+
+}  // namespace crc32c
+}  // namespace bitcask
@@ -2,14 +2,63 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <dirent.h>
+#include <unistd.h>
 
 namespace bitcask {
 
+namespace {
+
+// 从完整的记录字节中解码日志记录
+ReadLogRecord decode_full_log_record(const Bytes& buf) {
+    auto [header, header_size] = decode_log_record_header(buf);
+    if (header.crc == 0 && header.key_size == 0 && header.value_size == 0) {
+        throw ReadDataFileEOFError();
+    }
+    size_t record_size = header_size + header.key_size + header.value_size;
+    if (record_size != buf.size()) {
+        throw BitcaskException("Log record size does not match its position, data may be corrupted");
+    }
+    
+    LogRecord log_record;
+    log_record.type = header.type;
+    auto key_begin = buf.begin() + header_size;
+    log_record.key.assign(key_begin, key_begin + header.key_size);
+    log_record.value.assign(key_begin + header.key_size, key_begin + header.key_size + header.value_size);
+    if (!log_record.verify_crc(header.crc)) {
+        throw InvalidCRCError();
+    }
+    return ReadLogRecord(log_record, record_size);
+}
+
+}  // namespace
+
 DataFile::DataFile(const std::string& dir_path, uint32_t file_id, IOType io_type)
-    : file_id_(file_id), write_off_(0) {
+    : file_id_(file_id), write_off_(0), write_buffer_capacity_(0), buffer_off_(0), file_size_(0),
+      sealed_(false), io_type_(io_type), concurrent_io_(io_type != IOType::MEMORY_MAP) {
     
-    std::string file_name = get_data_file_name(dir_path, file_id);
-    io_manager_ = create_io_manager(file_name, io_type);
+    file_name_ = get_data_file_name(dir_path, file_id);
+    io_manager_ = create_io_manager(file_name_, io_type);
+    load_file_size();
+}
+
+DataFile::DataFile(const std::string& file_name, IOType io_type)
+    : file_id_(0), file_name_(file_name), write_off_(0), write_buffer_capacity_(0), buffer_off_(0),
+      file_size_(0), sealed_(false), io_type_(io_type), concurrent_io_(io_type != IOType::MEMORY_MAP) {
+    io_manager_ = create_io_manager(file_name_, io_type);
+    load_file_size();
+}
+
+DataFile::~DataFile() {
+    // 析构前尽量把缓冲区中的数据写入文件
+    try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_locked();
+    } catch (const std::exception&) {
+        // 析构时忽略写入错误
+    }
 }
 
 std::unique_ptr<DataFile> DataFile::open_data_file(const std::string& dir_path, 
@@ -18,31 +67,35 @@ std::unique_ptr<DataFile> DataFile::open_data_file(const std::string& dir_path,
 }
 
 std::unique_ptr<DataFile> DataFile::open_hint_file(const std::string& dir_path) {
-    auto data_file = std::make_unique<DataFile>(dir_path, 0, IOType::STANDARD_FIO);
-    data_file->io_manager_ = create_io_manager(dir_path + "/" + HINT_FILE_NAME, IOType::STANDARD_FIO);
-    return data_file;
+    return open_file(dir_path + "/" + HINT_FILE_NAME);
 }
 
 std::unique_ptr<DataFile> DataFile::open_merge_finished_file(const std::string& dir_path) {
-    auto data_file = std::make_unique<DataFile>(dir_path, 0, IOType::STANDARD_FIO);
-    data_file->io_manager_ = create_io_manager(dir_path + "/" + MERGE_FINISHED_FILE_NAME, IOType::STANDARD_FIO);
-    return data_file;
+    return open_file(dir_path + "/" + MERGE_FINISHED_FILE_NAME);
 }
 
 std::unique_ptr<DataFile> DataFile::open_seq_no_file(const std::string& dir_path) {
-    auto data_file = std::make_unique<DataFile>(dir_path, 0, IOType::STANDARD_FIO);
-    data_file->io_manager_ = create_io_manager(dir_path + "/" + SEQ_NO_FILE_NAME, IOType::STANDARD_FIO);
-    return data_file;
+    return open_file(dir_path + "/" + SEQ_NO_FILE_NAME);
+}
+
+std::unique_ptr<DataFile> DataFile::open_file(const std::string& file_name) {
+    return std::unique_ptr<DataFile>(new DataFile(file_name, IOType::STANDARD_FIO));
 }
 
 ReadLogRecord DataFile::read_log_record(uint64_t offset) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    off_t file_size_result = io_manager_->size();
-    if (file_size_result < 0) {
-        throw BitcaskException("Failed to get file size");
+    if (sealed_.load(std::memory_order_acquire)) {
+        // 封存后的文件不再变化
+        return read_log_record_from(offset, file_size_.load(std::memory_order_acquire),
+                                    [this](size_t n, uint64_t off) { return read_file_bytes(n, off); });
     }
-    uint64_t file_size = static_cast<uint64_t>(file_size_result);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_log_record_from(offset, logical_size_locked(),
+                                [this](size_t n, uint64_t off) { return read_n_bytes(n, off); });
+}
+
+template <typename ReadFn>
+ReadLogRecord DataFile::read_log_record_from(uint64_t offset, uint64_t file_size, ReadFn read) {
     if (offset >= file_size) {
         throw ReadDataFileEOFError();
     }
@@ -54,7 +107,7 @@ ReadLogRecord DataFile::read_log_record(uint64_t offset) {
         throw ReadDataFileEOFError();
     }
     
-    Bytes header_buf = read_n_bytes(header_bytes, offset);
+    Bytes header_buf = read(header_bytes, offset);
     if (header_buf.size() < 5) {
         throw ReadDataFileEOFError();
     }
@@ -73,12 +126,9 @@ ReadLogRecord DataFile::read_log_record(uint64_t offset) {
         throw BitcaskException("Record size too large, data may be corrupted");
     }
     
-    // 检查是否有足够的数据可读（放宽检查）
     if (offset + header_size > file_size) {
-        // 如果连头部都读不完，才报错
         throw BitcaskException("Header extends beyond file size, data may be corrupted");
     }
-    // 对于key/value数据，允许部分读取
     
     // 计算记录总大小
     size_t record_size = header_size + header.key_size + header.value_size;
@@ -88,118 +138,416 @@ ReadLogRecord DataFile::read_log_record(uint64_t offset) {
     log_record.type = header.type;
     
     // 读取key和value数据
-    if (header.key_size > 0 || header.value_size > 0) {
-        size_t kv_size = header.key_size + header.value_size;
-        if (kv_size > 0) {
-            Bytes kv_buf = read_n_bytes(kv_size, offset + header_size);
-            
-            // 分离key和value，更鲁棒的处理
-            if (header.key_size > 0) {
-                if (kv_buf.size() >= header.key_size) {
-                    log_record.key.assign(kv_buf.begin(), kv_buf.begin() + header.key_size);
-                } else {
-                    // 如果key数据不完整，使用可用的数据
-                    log_record.key.assign(kv_buf.begin(), kv_buf.end());
-                }
-            }
-            if (header.value_size > 0) {
-                size_t key_actual_size = std::min(static_cast<size_t>(header.key_size), kv_buf.size());
-                if (kv_buf.size() > key_actual_size) {
-                    size_t value_start = key_actual_size;
-                    size_t value_available = kv_buf.size() - value_start;
-                    size_t value_to_read = std::min(static_cast<size_t>(header.value_size), value_available);
-                    
-                    log_record.value.assign(kv_buf.begin() + value_start, 
-                                           kv_buf.begin() + value_start + value_to_read);
-                }
-            }
+    size_t kv_size = header.key_size + header.value_size;
+    if (kv_size > 0) {
+        Bytes kv_buf = read(kv_size, offset + header_size);
+        if (kv_buf.size() < kv_size) {
+            // 记录只写了一部分（通常是崩溃时的尾部），视为文件结束
+            throw ReadDataFileEOFError();
         }
+        log_record.key.assign(kv_buf.begin(), kv_buf.begin() + header.key_size);
+        log_record.value.assign(kv_buf.begin() + header.key_size, kv_buf.end());
     }
     
-    // 验证CRC - 只有在数据完整时才进行验证
-    if (log_record.key.size() == header.key_size && 
-        log_record.value.size() == header.value_size) {
-        try {
-            uint32_t calculated_crc = log_record.get_crc();
-            if (calculated_crc != header.crc) {
-                // CRC不匹配，检查是否是明显的测试损坏数据
-                if (header.crc == 0x00000000 && calculated_crc != 0) {
-                    // 全零CRC很可能是故意损坏的测试数据
-                    throw InvalidCRCError();
-                }
-                if (header.crc == 0xDEADBEEF || header.crc == 0x12345678) {
-                    // 这看起来像是故意损坏的测试数据
-                    throw InvalidCRCError();
-                }
-                // 对于其他情况，可能是编码差异，暂时忽略
-            }
-        } catch (const InvalidCRCError&) {
-            // 重新抛出CRC错误
-            throw;
-        } catch (const std::exception&) {
-            // 其他异常暂时忽略
-        }
+    // 每条记录都校验CRC，不匹配说明数据已损坏
+    if (!log_record.verify_crc(header.crc)) {
+        throw InvalidCRCError();
     }
     
     return ReadLogRecord(log_record, record_size);
 }
 
+ReadLogRecord DataFile::read_log_record(uint64_t offset, uint32_t size) {
+    if (size == 0) {
+        return read_log_record(offset);
+    }
+    
+    if (readable_without_lock(offset + size)) {
+        Bytes buf = read_file_bytes(size, offset);
+        if (buf.size() < size) {
+            throw ReadDataFileEOFError();
+        }
+        return decode_full_log_record(buf);
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (offset + size > logical_size_locked()) {
+        throw ReadDataFileEOFError();
+    }
+    
+    // 头部、key和value一次读出，在缓冲区中解码
+    Bytes buf = read_n_bytes(size, offset);
+    return decode_full_log_record(buf);
+}
+
+ValueView DataFile::read_value_view(uint64_t offset, uint32_t size, LogRecordType& type) {
+    const ReadOnlyMapping* mapping = sealed_mapping();
+    if (mapping == nullptr || size == 0 || offset + size > mapping->size()) {
+        ReadLogRecord read_record = read_log_record(offset, size);
+        type = read_record.record.type;
+        auto value = std::make_shared<Bytes>(std::move(read_record.record.value));
+        return ValueView(value, value->data(), value->size());
+    }
+    
+    // 直接在映射上解码和校验
+    const uint8_t* record = mapping->data() + offset;
+    auto [header, header_size] = decode_log_record_header(record, size);
+    if (header.crc == 0 && header.key_size == 0 && header.value_size == 0) {
+        throw ReadDataFileEOFError();
+    }
+    if (static_cast<size_t>(header_size) + header.key_size + header.value_size != size) {
+        throw BitcaskException("Log record size does not match its position, data may be corrupted");
+    }
+    if (!verify_encoded_log_record(record, size)) {
+        throw InvalidCRCError();
+    }
+    type = header.type;
+    return ValueView(mapping_, record + header_size + header.key_size, header.value_size);
+}
+
+std::vector<ReadLogRecord> DataFile::read_log_records(const std::vector<LogRecordPos>& positions) {
+    // 所有记录都已落盘时不需要加锁
+    uint64_t max_end = 0;
+    for (const auto& pos : positions) {
+        max_end = std::max<uint64_t>(max_end, pos.offset + pos.size);
+    }
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    if (!readable_without_lock(max_end)) {
+        lock.lock();
+    }
+    
+    std::vector<Bytes> buffers(positions.size());
+    std::vector<IORequest> requests;
+    std::vector<size_t> request_index;
+    requests.reserve(positions.size());
+    request_index.reserve(positions.size());
+    
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const LogRecordPos& pos = positions[i];
+        if (pos.size == 0) {
+            throw BitcaskException("Log record position without size");
+        }
+        // 还在追加缓冲区中的记录直接从内存读取
+        if (lock.owns_lock() && !write_buffer_.empty() && pos.offset + pos.size > buffer_off_) {
+            buffers[i] = read_n_bytes(pos.size, pos.offset);
+            continue;
+        }
+        buffers[i].resize(pos.size);
+        requests.push_back(IORequest{buffers[i].data(), pos.size, static_cast<off_t>(pos.offset), -1});
+        request_index.push_back(i);
+    }
+    
+    io_manager_->read_batch(requests.data(), requests.size());
+    
+    for (size_t j = 0; j < requests.size(); ++j) {
+        if (requests[j].result < 0) {
+            throw BitcaskException("Failed to read from file at offset " + std::to_string(requests[j].offset));
+        }
+        if (static_cast<size_t>(requests[j].result) < requests[j].size) {
+            throw ReadDataFileEOFError();
+        }
+    }
+    
+    std::vector<ReadLogRecord> records;
+    records.reserve(positions.size());
+    for (const auto& buf : buffers) {
+        records.push_back(decode_full_log_record(buf));
+    }
+    return records;
+}
+
 size_t DataFile::write(const Bytes& data) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    ssize_t n = io_manager_->write(data.data(), data.size(), write_off_);
+    struct iovec iov;
+    iov.iov_base = const_cast<uint8_t*>(data.data());
+    iov.iov_len = data.size();
+    return write_locked(&iov, 1);
+}
+
+size_t DataFile::write(const struct iovec* iov, int iovcnt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_locked(iov, iovcnt);
+}
+
+size_t DataFile::write_locked(const struct iovec* iov, int iovcnt) {
+    size_t expected = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        expected += iov[i].iov_len;
+    }
+    
+    // 小记录追加到缓冲区，攒满后一次写入
+    if (write_buffer_capacity_ > 0 && expected <= write_buffer_capacity_) {
+        if (write_buffer_.size() + expected > write_buffer_capacity_) {
+            flush_locked();
+        }
+        for (int i = 0; i < iovcnt; ++i) {
+            const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+            write_buffer_.insert(write_buffer_.end(), data, data + iov[i].iov_len);
+        }
+        write_off_ += expected;
+        if (write_buffer_.size() >= write_buffer_capacity_) {
+            flush_locked();
+        }
+        return expected;
+    }
+    
+    // 大记录直接写入，先刷出缓冲区保证顺序
+    flush_locked();
+    ssize_t n = io_manager_->writev(iov, iovcnt, write_off_.load(std::memory_order_relaxed));
     if (n < 0) {
         throw BitcaskException("Failed to write data to file");
     }
     write_off_ += n;
+    buffer_off_ = write_off_;
+    extend_file_size(write_off_);
+    if (static_cast<size_t>(n) != expected) {
+        throw BitcaskException("Incomplete write: expected " + std::to_string(expected) +
+                               " bytes, wrote " + std::to_string(n));
+    }
     return static_cast<size_t>(n);
 }
 
+void DataFile::enable_write_buffer(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    write_buffer_capacity_ = capacity;
+    write_buffer_.clear();
+    write_buffer_.shrink_to_fit();
+    write_buffer_.reserve(capacity);
+}
+
+std::unique_ptr<DataFileScanner> DataFile::new_scanner(const ScannerOptions& options) {
+    flush();
+    return DataFileScanner::open(file_name_, options);
+}
+
+void DataFile::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+}
+
+void DataFile::flush_locked() {
+    if (write_buffer_.empty()) {
+        buffer_off_ = write_off_;
+        return;
+    }
+    
+    ssize_t n = io_manager_->write(write_buffer_.data(), write_buffer_.size(), buffer_off_);
+    if (n < 0 || static_cast<size_t>(n) != write_buffer_.size()) {
+        throw BitcaskException("Failed to flush write buffer to file");
+    }
+    buffer_off_ += write_buffer_.size();
+    write_buffer_.clear();
+    extend_file_size(buffer_off_);
+}
+
+uint64_t DataFile::logical_size_locked() const {
+    // 使用缓存的文件大小，读路径上不需要fstat
+    uint64_t size = file_size_.load(std::memory_order_acquire);
+    if (!write_buffer_.empty()) {
+        size = std::max(size, write_off_.load(std::memory_order_relaxed));
+    }
+    return size;
+}
+
+bool DataFile::readable_without_lock(uint64_t end) const {
+    if (end > file_size_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return concurrent_io_ || sealed_.load(std::memory_order_acquire);
+}
+
+const ReadOnlyMapping* DataFile::sealed_mapping() const {
+    if (!sealed_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return mapping_.get();
+}
+
+Bytes DataFile::read_file_bytes(size_t n, uint64_t offset) const {
+    const ReadOnlyMapping* mapping = sealed_mapping();
+    if (mapping != nullptr && offset <= mapping->size()) {
+        size_t available = static_cast<size_t>(std::min<uint64_t>(n, mapping->size() - offset));
+        return Bytes(mapping->data() + offset, mapping->data() + offset + available);
+    }
+    
+    Bytes buffer(n);
+    ssize_t bytes_read = io_manager_->read(buffer.data(), n, static_cast<off_t>(offset));
+    if (bytes_read < 0) {
+        throw BitcaskException("Failed to read from file at offset " + std::to_string(offset));
+    }
+    buffer.resize(static_cast<size_t>(bytes_read));
+    return buffer;
+}
+
+void DataFile::load_file_size() {
+    off_t size_result = io_manager_->size();
+    if (size_result < 0) {
+        throw BitcaskException("Failed to get file size");
+    }
+    file_size_.store(static_cast<uint64_t>(size_result), std::memory_order_release);
+}
+
+void DataFile::extend_file_size(uint64_t end) {
+    // 锁外的write_at可能并发完成，只允许变大
+    uint64_t current = file_size_.load(std::memory_order_relaxed);
+    while (current < end &&
+           !file_size_.compare_exchange_weak(current, end, std::memory_order_acq_rel)) {
+    }
+}
+
+size_t DataFile::write(const LogRecord& record) {
+    uint8_t header[MAX_LOG_RECORD_HEADER_SIZE];
+    size_t header_size = record.encode_header(header);
+    
+    struct iovec iov[3];
+    int iovcnt = 0;
+    iov[iovcnt].iov_base = header;
+    iov[iovcnt].iov_len = header_size;
+    iovcnt++;
+    if (!record.key.empty()) {
+        iov[iovcnt].iov_base = const_cast<uint8_t*>(record.key.data());
+        iov[iovcnt].iov_len = record.key.size();
+        iovcnt++;
+    }
+    if (!record.value.empty()) {
+        iov[iovcnt].iov_base = const_cast<uint8_t*>(record.value.data());
+        iov[iovcnt].iov_len = record.value.size();
+        iovcnt++;
+    }
+    
+    return write(iov, iovcnt);
+}
+
+uint64_t DataFile::reserve(size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    uint64_t offset = write_off_.load(std::memory_order_relaxed);
+    write_off_.store(offset + size, std::memory_order_release);
+    buffer_off_ = write_off_;
+    return offset;
+}
+
+size_t DataFile::write_at(uint64_t offset, const LogRecord& record) {
+    uint8_t header[MAX_LOG_RECORD_HEADER_SIZE];
+    size_t header_size = record.encode_header(header);
+    
+    struct iovec iov[3];
+    int iovcnt = 0;
+    iov[iovcnt].iov_base = header;
+    iov[iovcnt].iov_len = header_size;
+    iovcnt++;
+    if (!record.key.empty()) {
+        iov[iovcnt].iov_base = const_cast<uint8_t*>(record.key.data());
+        iov[iovcnt].iov_len = record.key.size();
+        iovcnt++;
+    }
+    if (!record.value.empty()) {
+        iov[iovcnt].iov_base = const_cast<uint8_t*>(record.value.data());
+        iov[iovcnt].iov_len = record.value.size();
+        iovcnt++;
+    }
+    
+    size_t expected = header_size + record.key.size() + record.value.size();
+    ssize_t n = io_manager_->writev(iov, iovcnt, static_cast<off_t>(offset));
+    if (n < 0 || static_cast<size_t>(n) != expected) {
+        throw BitcaskException("Failed to write log record at offset " + std::to_string(offset));
+    }
+    extend_file_size(offset + expected);
+    return expected;
+}
+
 void DataFile::write_hint_record(const Bytes& key, const LogRecordPos& pos) {
     LogRecord hint_record;
     hint_record.key = key;
     hint_record.value = pos.encode();
     hint_record.type = LogRecordType::NORMAL;
     
-    auto [encoded_data, size] = hint_record.encode();
-    write(encoded_data);
+    write(hint_record);
 }
 
 void DataFile::sync() {
     std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
     // 强制数据同步到磁盘，确保数据持久化
-    io_manager_->sync();
+    if (io_manager_->sync() != 0) {
+        throw BitcaskException("Failed to sync data file " + std::to_string(file_id_) + " (" + strerror(errno) + ")");
+    }
+}
+
+void DataFile::preallocate(uint64_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 预分配失败只影响性能，不影响正确性
+    io_manager_->allocate(0, static_cast<off_t>(size));
+}
+
+void DataFile::seal(bool map_read_only) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    if (map_read_only && !sealed_.load(std::memory_order_relaxed)) {
+        // 映射失败时退回普通读取
+        mapping_ = ReadOnlyMapping::open(file_name_, file_size_.load(std::memory_order_relaxed));
+    }
+    sealed_.store(true, std::memory_order_release);
 }
 
 void DataFile::close() {
     std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
     io_manager_->close(); // 忽略返回值，关闭时的错误通常不致命
 }
 
 uint64_t DataFile::file_size() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    off_t size_result = io_manager_->size();
-    if (size_result < 0) {
-        throw BitcaskException("Failed to get file size");
-    }
-    return static_cast<uint64_t>(size_result);
+    return logical_size_locked();
 }
 
 uint64_t DataFile::get_write_off() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return write_off_;
+    return write_off_.load(std::memory_order_acquire);
 }
 
 void DataFile::set_write_off(uint64_t offset) {
     std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
     write_off_ = offset;
+    buffer_off_ = offset;
 }
 
 void DataFile::set_io_manager(const std::string& dir_path, IOType io_type) {
     std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    io_manager_->close();
+    file_name_ = get_data_file_name(dir_path, file_id_);
+    io_manager_ = create_io_manager(file_name_, io_type);
+    io_type_ = io_type;
+    concurrent_io_ = io_type != IOType::MEMORY_MAP;
+    load_file_size();
+}
+
+void DataFile::set_rate_limiter(std::shared_ptr<RateLimiter> limiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_manager_ = std::make_unique<RateLimitedIOManager>(std::move(io_manager_), std::move(limiter));
+}
+
+void DataFile::wrap_io_manager(const std::function<std::unique_ptr<IOManager>(std::unique_ptr<IOManager>)>& wrap) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_manager_ = wrap(std::move(io_manager_));
+}
+
+void DataFile::truncate(uint64_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    // 内存映射的IO管理器映射了原来的长度，截断后重新打开
     io_manager_->close();
-    std::string file_name = get_data_file_name(dir_path, file_id_);
-    io_manager_ = create_io_manager(file_name, io_type);
+    if (::truncate(file_name_.c_str(), static_cast<off_t>(size)) != 0) {
+        io_manager_ = create_io_manager(file_name_, io_type_);
+        throw BitcaskException("Failed to truncate file: " + file_name_);
+    }
+    io_manager_ = create_io_manager(file_name_, io_type_);
+    load_file_size();
+    write_off_ = size;
+    buffer_off_ = size;
 }
 
 std::string DataFile::get_data_file_name(const std::string& dir_path, uint32_t file_id) {
@@ -208,17 +556,50 @@ std::string DataFile::get_data_file_name(const std::string& dir_path, uint32_t f
     return dir_path + "/" + oss.str();
 }
 
+std::vector<uint32_t> DataFile::list_data_file_ids(const std::string& dir_path) {
+    std::vector<uint32_t> file_ids;
+    DIR* dir = opendir(dir_path.c_str());
+    if (!dir) {
+        return file_ids;
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        // 文件名为十进制文件ID加后缀，且与get_data_file_name生成的名字一致
+        std::string name = entry->d_name;
+        if (name.size() <= DATA_FILE_SUFFIX.size() ||
+            name.compare(name.size() - DATA_FILE_SUFFIX.size(), DATA_FILE_SUFFIX.size(), DATA_FILE_SUFFIX) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(0, name.size() - DATA_FILE_SUFFIX.size());
+        if (digits.size() > 10 || !std::all_of(digits.begin(), digits.end(), ::isdigit)) {
+            continue;
+        }
+        uint64_t fid = std::stoull(digits);
+        if (fid > UINT32_MAX || get_data_file_name("", static_cast<uint32_t>(fid)) != "/" + name) {
+            continue;
+        }
+        file_ids.push_back(static_cast<uint32_t>(fid));
+    }
+    closedir(dir);
+    
+    std::sort(file_ids.begin(), file_ids.end());
+    return file_ids;
+}
+
+std::string DataFile::get_hint_file_name(const std::string& dir_path, uint32_t file_id) {
+    std::ostringstream oss;
+    oss << std::setfill('0') << std::setw(9) << file_id << DATA_HINT_FILE_SUFFIX;
+    return dir_path + "/" + oss.str();
+}
+
 Bytes DataFile::read_n_bytes(size_t n, uint64_t offset) {
     if (n == 0) {
         return Bytes{};
     }
     
     // 检查文件大小，防止超出范围读取
-    off_t file_size_result = io_manager_->size();
-    if (file_size_result < 0) {
-        throw BitcaskException("Failed to get file size");
-    }
-    uint64_t file_size = static_cast<uint64_t>(file_size_result);
+    uint64_t file_size = logical_size_locked();
     if (offset >= file_size) {
         throw ReadDataFileEOFError();
     }
@@ -229,8 +610,28 @@ Bytes DataFile::read_n_bytes(size_t n, uint64_t offset) {
         throw ReadDataFileEOFError();
     }
     
+    // 已刷出的部分从文件读取，其余部分从追加缓冲区读取
+    size_t file_part = actual_read_size;
+    if (!write_buffer_.empty()) {
+        file_part = offset >= buffer_off_ ? 0 :
+            static_cast<size_t>(std::min<uint64_t>(actual_read_size, buffer_off_ - offset));
+    }
+    
     Bytes buffer(actual_read_size);
-    ssize_t bytes_read = io_manager_->read(buffer.data(), actual_read_size, static_cast<off_t>(offset));
+    ssize_t bytes_read = 0;
+    if (file_part > 0) {
+        bytes_read = io_manager_->read(buffer.data(), file_part, static_cast<off_t>(offset));
+    }
+    if (bytes_read >= 0 && static_cast<size_t>(bytes_read) == file_part && file_part < actual_read_size) {
+        uint64_t buffer_pos = offset + file_part - buffer_off_;
+        size_t buffered = 0;
+        if (buffer_pos < write_buffer_.size()) {
+            buffered = std::min(actual_read_size - file_part,
+                                static_cast<size_t>(write_buffer_.size() - buffer_pos));
+            std::memcpy(buffer.data() + file_part, write_buffer_.data() + buffer_pos, buffered);
+        }
+        bytes_read += static_cast<ssize_t>(buffered);
+    }
     if (bytes_read < 0) {
         throw BitcaskException("Failed to read from file at offset " + std::to_string(offset));
     }
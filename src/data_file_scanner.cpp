@@ -0,0 +1,311 @@
+#include "bitcask/data_file_scanner.h"
+#include "bitcask/log_record.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bitcask {
+
+namespace {
+
+// 单条记录key或value的长度上限，超过说明长度字段已损坏
+const uint32_t MAX_RECORD_FIELD_SIZE = 64 * 1024 * 1024;
+
+enum class VarintResult { OK, INCOMPLETE, INVALID };
+
+// 不抛异常的varint解码
+VarintResult parse_varint(const uint8_t* data, size_t size, uint64_t& value, size_t& length) {
+    value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (i >= 10) {
+            return VarintResult::INVALID;
+        }
+        value |= static_cast<uint64_t>(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            length = i + 1;
+            return VarintResult::OK;
+        }
+    }
+    return size >= 10 ? VarintResult::INVALID : VarintResult::INCOMPLETE;
+}
+
+}  // namespace
+
+std::unique_ptr<DataFileScanner> DataFileScanner::open(const std::string& file_name,
+                                                       const ScannerOptions& options) {
+    int fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw BitcaskException("Failed to open file for scanning: " + file_name + " (" + strerror(errno) + ")");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw BitcaskException("Failed to stat file for scanning: " + file_name);
+    }
+    return std::unique_ptr<DataFileScanner>(
+        new DataFileScanner(fd, static_cast<uint64_t>(st.st_size), options));
+}
+
+DataFileScanner::DataFileScanner(int fd, uint64_t file_size, const ScannerOptions& options)
+    : fd_(fd), file_size_(file_size), offset_(0), buffer_size_(options.buffer_size),
+      rate_limiter_(options.rate_limiter),
+      buffer_off_(0), buffer_len_(0), mapped_(nullptr), corrupted_ranges_(0), corrupted_bytes_(0),
+      corrupted_end_(0), marker_search_from_(UINT64_MAX), marker_found_at_(0),
+      last_marker_(UINT64_MAX), probe_from_(UINT64_MAX), probe_found_(0) {
+    if (options.map_populate && file_size_ > 0) {
+        void* data = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd_, 0);
+        if (data != MAP_FAILED) {
+            mapped_ = static_cast<const uint8_t*>(data);
+        }
+    }
+    if (!mapped_) {
+        // 映射失败时退回分块读取
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+}
+
+DataFileScanner::~DataFileScanner() {
+    if (mapped_) {
+        munmap(const_cast<uint8_t*>(mapped_), file_size_);
+    }
+    ::close(fd_);
+}
+
+const uint8_t* DataFileScanner::fetch(uint64_t offset, size_t n) {
+    if (offset + n > file_size_) {
+        return nullptr;
+    }
+    if (mapped_) {
+        return mapped_ + offset;
+    }
+    if (offset >= buffer_off_ && offset + n <= buffer_off_ + buffer_len_) {
+        return buffer_.data() + (offset - buffer_off_);
+    }
+
+    size_t want = static_cast<size_t>(std::min<uint64_t>(std::max(buffer_size_, n), file_size_ - offset));
+    if (buffer_.size() < want) {
+        buffer_.resize(want);
+    }
+
+    // 缓冲区尾部已有的数据挪到开头，只读取缺少的部分
+    size_t kept = 0;
+    if (offset >= buffer_off_ && offset < buffer_off_ + buffer_len_) {
+        kept = static_cast<size_t>(buffer_off_ + buffer_len_ - offset);
+        std::memmove(buffer_.data(), buffer_.data() + (offset - buffer_off_), kept);
+    }
+    buffer_off_ = offset;
+    buffer_len_ = kept;
+
+    if (rate_limiter_) {
+        rate_limiter_->request(want - kept);
+    }
+    while (buffer_len_ < want) {
+        ssize_t got = ::pread(fd_, buffer_.data() + buffer_len_, want - buffer_len_,
+                              static_cast<off_t>(buffer_off_ + buffer_len_));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        buffer_len_ += static_cast<size_t>(got);
+    }
+    return buffer_len_ >= n ? buffer_.data() : nullptr;
+}
+
+ScanStatus DataFileScanner::decode_at(uint64_t offset, ScannedRecord& record) {
+    if (offset >= file_size_) {
+        return ScanStatus::END_OF_FILE;
+    }
+
+    uint64_t remaining = file_size_ - offset;
+    size_t header_bytes = static_cast<size_t>(std::min<uint64_t>(MAX_LOG_RECORD_HEADER_SIZE, remaining));
+    const uint8_t* header = fetch(offset, header_bytes);
+    if (!header) {
+        return ScanStatus::CORRUPTED;
+    }
+    if (header_bytes < 5) {
+        // 放不下最小的头部：全零是预分配的尾部，否则是写了一半的记录
+        bool all_zero = std::all_of(header, header + header_bytes, [](uint8_t b) { return b == 0; });
+        return all_zero ? ScanStatus::END_OF_FILE : ScanStatus::TORN_TAIL;
+    }
+
+    // 头部：CRC(4) + 类型(1) + key长度(varint) + value长度(varint)
+    uint32_t crc = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                   (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+    uint64_t key_size = 0;
+    uint64_t value_size = 0;
+    size_t key_len = 0;
+    size_t value_len = 0;
+    bool header_truncated = header_bytes < MAX_LOG_RECORD_HEADER_SIZE;
+
+    VarintResult result = parse_varint(header + 5, header_bytes - 5, key_size, key_len);
+    if (result == VarintResult::OK) {
+        result = parse_varint(header + 5 + key_len, header_bytes - 5 - key_len, value_size, value_len);
+    }
+    if (result != VarintResult::OK) {
+        return result == VarintResult::INCOMPLETE && header_truncated ? ScanStatus::TORN_TAIL
+                                                                      : ScanStatus::CORRUPTED;
+    }
+
+    if (crc == 0 && key_size == 0 && value_size == 0) {
+        return ScanStatus::END_OF_FILE;
+    }
+    // 类型和长度明显不对时不用再算CRC，逐字节跳过损坏数据时大部分位置在这里就被排除
+    uint8_t type = header[4];
+    if (type < static_cast<uint8_t>(LogRecordType::NORMAL) || type > static_cast<uint8_t>(LogRecordType::SYNC_MARKER) ||
+        key_size > MAX_RECORD_FIELD_SIZE || value_size > MAX_RECORD_FIELD_SIZE) {
+        return ScanStatus::CORRUPTED;
+    }
+
+    size_t header_size = 5 + key_len + value_len;
+    uint64_t record_size = header_size + key_size + value_size;
+    if (record_size > remaining) {
+        return ScanStatus::TORN_TAIL;
+    }
+
+    const uint8_t* data = fetch(offset, static_cast<size_t>(record_size));
+    if (!data || !verify_encoded_log_record(data, static_cast<size_t>(record_size))) {
+        return ScanStatus::CORRUPTED;
+    }
+
+    record.offset = offset;
+    record.size = static_cast<uint32_t>(record_size);
+    record.type = static_cast<LogRecordType>(data[4]);
+    record.key = data + header_size;
+    record.key_size = static_cast<uint32_t>(key_size);
+    record.value = record.key + key_size;
+    record.value_size = static_cast<uint32_t>(value_size);
+    return ScanStatus::OK;
+}
+
+ScanStatus DataFileScanner::next(ScannedRecord& record) {
+    ScanStatus status = decode_at(offset_, record);
+    if (status == ScanStatus::OK) {
+        offset_ += record.size;
+    } else if (status == ScanStatus::TORN_TAIL && !is_torn_tail(offset_)) {
+        // 长度字段损坏也会表现为记录超出文件末尾，后面还有有效数据时按损坏处理
+        status = ScanStatus::CORRUPTED;
+    }
+    return status;
+}
+
+bool DataFileScanner::is_torn_tail(uint64_t offset) {
+    // 头部声明的长度已经超出文件末尾（decode_at返回TORN_TAIL的条件）；写了一半的只能是最后一条记录，
+    // 后面还有同步标记说明之后写入过完整的数据，是长度字段损坏
+    uint64_t last = last_sync_marker();
+    if (last < file_size_ && last > offset) {
+        return false;
+    }
+
+    // 没有更晚的同步标记（未启用同步标记、旧文件或最后一个标记区间内）时，调用者会把这里之后的内容截掉，
+    // 必须确认后面没有能通过CRC校验的完整记录。逐位置试探时大部分位置在类型和长度检查处就被排除；
+    // 记住找到的位置，逐字节跳过损坏区间时不重复试探
+    uint64_t from = offset + 1;
+    if (from < probe_from_ || from > probe_found_) {
+        ScannedRecord probe;
+        probe_found_ = file_size_;
+        for (uint64_t pos = from; pos < file_size_; ++pos) {
+            if (decode_at(pos, probe) == ScanStatus::OK) {
+                probe_found_ = pos;
+                break;
+            }
+        }
+        probe_from_ = from;
+    }
+    return probe_found_ >= file_size_;
+}
+
+void DataFileScanner::seek(uint64_t offset) {
+    offset_ = offset;
+}
+
+uint64_t DataFileScanner::find_sync_marker(uint64_t from) {
+    if (from >= marker_search_from_ && from <= marker_found_at_) {
+        return marker_found_at_;
+    }
+
+    const Bytes& marker = encoded_sync_marker();
+    uint64_t found = file_size_;
+    uint64_t pos = from;
+    while (pos + marker.size() <= file_size_) {
+        // 分块搜索，相邻块重叠marker.size() - 1字节
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(std::max(buffer_size_, marker.size()),
+                                                              file_size_ - pos));
+        const uint8_t* data = fetch(pos, chunk);
+        if (!data) {
+            break;
+        }
+        const void* hit = memmem(data, chunk, marker.data(), marker.size());
+        if (hit) {
+            found = pos + (static_cast<const uint8_t*>(hit) - data);
+            break;
+        }
+        if (pos + chunk >= file_size_) {
+            break;
+        }
+        pos += chunk - (marker.size() - 1);
+    }
+
+    marker_search_from_ = from;
+    marker_found_at_ = found;
+    return found;
+}
+
+uint64_t DataFileScanner::last_sync_marker() {
+    if (last_marker_ != UINT64_MAX) {
+        return last_marker_;
+    }
+
+    const Bytes& marker = encoded_sync_marker();
+    last_marker_ = file_size_;
+    uint64_t end = file_size_;
+    while (end >= marker.size()) {
+        // 从后向前分块搜索，相邻块重叠marker.size() - 1字节，块内取最后一次出现的位置
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(std::max(buffer_size_, marker.size()), end));
+        uint64_t pos = end - chunk;
+        const uint8_t* data = fetch(pos, chunk);
+        if (!data) {
+            break;
+        }
+        const uint8_t* last_hit = nullptr;
+        const uint8_t* from = data;
+        while (const void* hit = memmem(from, static_cast<size_t>(data + chunk - from), marker.data(), marker.size())) {
+            last_hit = static_cast<const uint8_t*>(hit);
+            from = last_hit + 1;
+        }
+        if (last_hit) {
+            last_marker_ = pos + (last_hit - data);
+            break;
+        }
+        if (pos == 0) {
+            break;
+        }
+        end = pos + marker.size() - 1;
+    }
+    return last_marker_;
+}
+
+void DataFileScanner::skip_corrupted() {
+    uint64_t start = offset_;
+    uint64_t next = find_sync_marker(start + 1);
+    if (start + 1 >= probe_from_ && start + 1 <= probe_found_ && probe_found_ < next) {
+        // 判断尾部时已经试探出后面第一条完整记录，直接跳过去，不再逐字节重复解码
+        next = probe_found_;
+    } else if (next >= file_size_) {
+        next = start + 1;
+    }
+
+    if (start != corrupted_end_ || corrupted_ranges_ == 0) {
+        corrupted_ranges_++;
+    }
+    corrupted_bytes_ += next - start;
+    corrupted_end_ = next;
+    offset_ = next;
+}
+
+}  // namespace bitcask
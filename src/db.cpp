@@ -1,29 +1,154 @@
 #include "bitcask/db.h"
 #include "bitcask/utils.h"
 #include "bitcask/bplus_tree_index.h"
+#include "bitcask/crc32c.h"
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/file.h>
+#include <sys/stat.h>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <cstring>
+#include <cerrno>
 #include <iostream>
 #include <unordered_map>
+#include <map>
 #include <cstdio>
 #include <climits>
+#include <chrono>
 
 namespace bitcask {
 
 // 常量定义
 static const std::string SEQ_NO_KEY = "seq.no";
 
+// merge写出文件时的追加缓冲区大小
+static const size_t MERGE_WRITE_BUFFER_SIZE = 1024 * 1024;
+
+// 修补写入失败的区域时单条填充记录的最大长度
+static const size_t MAX_PADDING_RECORD_SIZE = 1024 * 1024;
+
+// fold每批读取的记录数，同一文件中的读请求一次提交给IO管理器
+static const size_t FOLD_READ_BATCH_SIZE = 64;
+
+// 计算整个文件校验和时每次读取的长度
+static const size_t CHECKSUM_READ_SIZE = 1024 * 1024;
+
+// 文件前length字节的CRC32C，读取失败或文件不足length字节时返回false
+static bool file_checksum(const std::string& path, uint64_t length, uint32_t& crc) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    Bytes buffer(static_cast<size_t>(std::min<uint64_t>(length, CHECKSUM_READ_SIZE)));
+    crc = 0;
+    uint64_t offset = 0;
+    while (offset < length) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), length - offset));
+        ssize_t n = pread(fd, buffer.data(), want, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        crc = crc32c::extend(crc, buffer.data(), static_cast<size_t>(n));
+        offset += static_cast<uint64_t>(n);
+    }
+    ::close(fd);
+    return offset == length;
+}
+
+// 从提示文件的结束标记中取出生成时数据文件的大小和整个文件的CRC，没有结束标记或未记录CRC时返回false
+static bool hint_file_checksum(const std::string& hint_path, uint32_t fid, uint64_t& size, uint32_t& crc) {
+    try {
+        auto scanner = DataFileScanner::open(hint_path);
+        ScannedRecord record;
+        while (scanner->next(record) == ScanStatus::OK) {
+            if (record.key_size != 0) {
+                continue;
+            }
+            LogRecordPos pos = LogRecordPos::decode(record.value_bytes());
+            size = pos.offset;
+            crc = pos.size;
+            // 旧版本生成的提示文件在这里记录的是0
+            return pos.fid == fid && crc != 0;
+        }
+    } catch (const std::exception&) {
+        // 提示文件损坏时当作没有校验和
+    }
+    return false;
+}
+
+// 备份目录中的旧数据文件是否与源文件相同：上次备份时硬链接过来的同一个inode，
+// 或者两边的提示文件记录了相同的大小和整个文件的CRC（提示文件跟着数据文件复制到备份中，
+// merge重写数据文件时删除旧的提示文件）。无法确认时返回false，由调用者重新复制
+static bool backup_file_unchanged(const std::string& src_dir, const std::string& dst_dir, uint32_t fid) {
+    std::string src = DataFile::get_data_file_name(src_dir, fid);
+    std::string dst = DataFile::get_data_file_name(dst_dir, fid);
+    if (utils::same_file(src, dst)) {
+        return true;
+    }
+    struct stat src_stat;
+    struct stat dst_stat;
+    if (stat(src.c_str(), &src_stat) != 0 || stat(dst.c_str(), &dst_stat) != 0 ||
+        src_stat.st_size != dst_stat.st_size) {
+        return false;
+    }
+    uint64_t src_size = 0;
+    uint64_t dst_size = 0;
+    uint32_t src_crc = 0;
+    uint32_t dst_crc = 0;
+    return hint_file_checksum(DataFile::get_hint_file_name(src_dir, fid), fid, src_size, src_crc) &&
+           hint_file_checksum(DataFile::get_hint_file_name(dst_dir, fid), fid, dst_size, dst_crc) &&
+           src_size == static_cast<uint64_t>(src_stat.st_size) && dst_size == src_size && dst_crc == src_crc;
+}
+
+// 后台IO自适应限速且有后台任务时，前台操作在作用域结束时向限速器报告自己的延迟
+class ForegroundLatencySample {
+public:
+    explicit ForegroundLatencySample(RateLimiter* limiter)
+        : limiter_(limiter && limiter->sampling() ? limiter : nullptr) {
+        if (limiter_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ForegroundLatencySample() {
+        if (limiter_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            limiter_->report_latency(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        }
+    }
+
+private:
+    RateLimiter* limiter_;
+    std::chrono::steady_clock::time_point start_;
+};
+
 // DB实现
 DB::DB(const Options& options) 
-    : options_(options), seq_no_(NON_TRANSACTION_SEQ_NO), is_merging_(false),
+    : options_(options),
+      data_file_table_(std::make_shared<DataFileTable>()),
+      next_append_ticket_(0), published_append_ticket_(0), pending_appends_(0), append_failed_(false),
+      seq_no_(NON_TRANSACTION_SEQ_NO), is_merging_(false),
       seq_no_file_exists_(false), is_initial_(false), file_lock_fd_(-1),
-      bytes_write_(0), reclaim_size_(0) {
+      bytes_write_(0), reclaim_size_(0), file_epoch_(0),
+      corrupted_ranges_(0), corrupted_bytes_(0), truncated_tail_bytes_(0),
+      commit_leader_active_(false),
+      sync_group_num_(0), sync_group_records_(0), sync_group_max_size_(0),
+      sync_group_total_latency_us_(0), sync_group_max_latency_us_(0),
+      bg_stop_(false), next_file_id_(-1), next_file_creating_(false), sealed_syncing_(0) {
+    if (options_.value_cache_size > 0) {
+        value_cache_ = std::make_unique<ValueCache>(options_.value_cache_size);
+    }
+    if (options_.background_io_rate > 0) {
+        io_limiter_ = std::make_shared<RateLimiter>(options_.background_io_rate,
+                                                    options_.background_io_latency_target_us);
+    }
 }
 
 DB::~DB() {
@@ -91,32 +216,62 @@ void DB::init() {
         load_seq_no();
         // 注意：不要在这里设置写入偏移，写入偏移应该在load_index_from_data_files中正确设置
     }
+    
+    // 启动后台文件轮转，提前准备好下一个数据文件
+    if (options_.background_file_rotation) {
+        start_background_worker();
+        if (active_file_) {
+            request_next_data_file(active_file_->get_file_id() + 1);
+        }
+    }
 }
 
 void DB::put(const Bytes& key, const Bytes& value) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    
+    ForegroundLatencySample sample(io_limiter_.get());
     if (key.empty()) {
         throw KeyEmptyError();
     }
     
     // 构造日志记录
-    LogRecord log_record;
-    log_record.key = log_record_key_with_seq(key, NON_TRANSACTION_SEQ_NO);
-    log_record.value = value;
-    log_record.type = LogRecordType::NORMAL;
+    CommitRequest request;
+    request.key = key;
+    request.record.key = log_record_key_with_seq(key, NON_TRANSACTION_SEQ_NO);
+    request.record.value = value;
+    request.record.type = LogRecordType::NORMAL;
+    
+    // 需要同步时走组提交，多个写请求共享一次fdatasync
+    if (options_.sync_writes) {
+        group_commit(request);
+        return;
+    }
     
-    // 追加写入到活跃数据文件
-    LogRecordPos pos = append_log_record_internal(log_record);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    apply_commit_request(request);
+}
+
+void DB::put(Bytes&& key, Bytes&& value) {
+    ForegroundLatencySample sample(io_limiter_.get());
+    if (key.empty()) {
+        throw KeyEmptyError();
+    }
     
-    // 更新内存索引
-    auto old_pos = index_->put(key, pos);
-    if (old_pos) {
-        reclaim_size_ += old_pos->size;
+    // 值可以直接接管，key要另外编码上序列号
+    CommitRequest request;
+    request.record = LogRecord(log_record_key_with_seq(key, NON_TRANSACTION_SEQ_NO), std::move(value),
+                               LogRecordType::NORMAL);
+    request.key = std::move(key);
+    
+    if (options_.sync_writes) {
+        group_commit(request);
+        return;
     }
+    
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    apply_commit_request(request);
 }
 
 Bytes DB::get(const Bytes& key) {
+    ForegroundLatencySample sample(io_limiter_.get());
     std::shared_lock<std::shared_mutex> lock(mutex_);
     
     if (key.empty()) {
@@ -133,35 +288,197 @@ Bytes DB::get(const Bytes& key) {
     return get_value_by_position(*pos);
 }
 
-void DB::remove(const Bytes& key) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
+ValueView DB::get_view(const Bytes& key) {
+    ForegroundLatencySample sample(io_limiter_.get());
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     
     if (key.empty()) {
         throw KeyEmptyError();
     }
     
-    // 检查key是否存在
     auto pos = index_->get(key);
     if (!pos) {
-        return; // key不存在，直接返回
+        throw KeyNotFoundError();
+    }
+    
+    auto files = data_files();
+    auto it = files->files.find(pos->fid);
+    if (it == files->files.end()) {
+        throw DataFileNotFoundError();
+    }
+    
+    LogRecordType type;
+    ValueView view = it->second->read_value_view(pos->offset, pos->size, type);
+    if (type == LogRecordType::DELETED) {
+        throw KeyNotFoundError();
+    }
+    return view;
+}
+
+void DB::remove(const Bytes& key) {
+    ForegroundLatencySample sample(io_limiter_.get());
+    if (key.empty()) {
+        throw KeyEmptyError();
     }
     
     // 构造删除日志记录
-    LogRecord log_record;
-    log_record.key = log_record_key_with_seq(key, NON_TRANSACTION_SEQ_NO);
-    log_record.type = LogRecordType::DELETED;
+    CommitRequest request;
+    request.key = key;
+    request.record.key = log_record_key_with_seq(key, NON_TRANSACTION_SEQ_NO);
+    request.record.type = LogRecordType::DELETED;
+    
+    if (options_.sync_writes) {
+        group_commit(request);
+        return;
+    }
     
-    // 写入到数据文件
-    LogRecordPos del_pos = append_log_record_internal(log_record);
-    reclaim_size_ += del_pos.size;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    apply_commit_request(request);
+}
+
+void DB::apply_commit_request(CommitRequest& request) {
+    if (skip_commit_request(request)) {
+        return;
+    }
+    
+    std::vector<const LogRecord*> records{&request.record};
+    append_log_records(records, AppendSync::POLICY,
+                       [this, &request](const std::vector<LogRecordPos>& positions) {
+        update_index_for_request(request, positions[0]);
+    });
+}
+
+bool DB::skip_commit_request(const CommitRequest& request) {
+    // 检查key是否存在，不存在则无需写入删除记录
+    return request.record.type == LogRecordType::DELETED && !index_->get(request.key);
+}
+
+void DB::update_index_for_request(const CommitRequest& request, const LogRecordPos& pos) {
+    const Bytes& key = request.key;
     
-    // 从内存索引中删除
-    auto [old_pos, ok] = index_->remove(key);
-    if (!ok) {
-        throw IndexUpdateFailedError();
+    if (request.record.type == LogRecordType::DELETED) {
+        mark_dead(pos);
+        
+        // 从内存索引中删除；并发的删除可能已经先删掉了这个key，此时无需处理
+        auto [old_pos, ok] = index_->remove(key);
+        if (ok && old_pos) {
+            mark_dead(*old_pos);
+        }
+        return;
     }
+    
+    // 更新内存索引
+    auto old_pos = index_->put(key, pos);
     if (old_pos) {
-        reclaim_size_ += old_pos->size;
+        mark_dead(*old_pos);
+    }
+}
+
+void DB::mark_dead(const LogRecordPos& pos) {
+    reclaim_size_ += pos.size;
+    std::lock_guard<std::mutex> dead_lock(dead_bytes_mutex_);
+    dead_bytes_[pos.fid] += pos.size;
+}
+
+void DB::group_commit(CommitRequest& request) {
+    std::unique_lock<std::mutex> commit_lock(commit_mutex_);
+    commit_queue_.push_back(&request);
+    
+    // 等待leader处理完本请求，或者当前没有leader时自己成为leader
+    commit_cv_.wait(commit_lock, [this, &request]() {
+        return request.done || !commit_leader_active_;
+    });
+    if (request.done) {
+        if (request.error) {
+            std::rethrow_exception(request.error);
+        }
+        return;
+    }
+    
+    // 成为leader，取走当前排队的所有请求（包括自己的）
+    commit_leader_active_ = true;
+    std::vector<CommitRequest*> group;
+    group.swap(commit_queue_);
+    commit_lock.unlock();
+    
+    auto start = std::chrono::steady_clock::now();
+    std::exception_ptr sync_error;
+    
+    // 整组记录一次预留、连续写入
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<CommitRequest*> writes;
+        std::vector<const LogRecord*> records;
+        for (auto* req : group) {
+            try {
+                if (!skip_commit_request(*req)) {
+                    writes.push_back(req);
+                    records.push_back(&req->record);
+                }
+            } catch (...) {
+                req->error = std::current_exception();
+            }
+        }
+        
+        if (!records.empty()) {
+            try {
+                append_log_records(records, AppendSync::DEFER,
+                                   [this, &writes](const std::vector<LogRecordPos>& positions) {
+                    for (size_t i = 0; i < writes.size(); ++i) {
+                        try {
+                            update_index_for_request(*writes[i], positions[i]);
+                        } catch (...) {
+                            writes[i]->error = std::current_exception();
+                        }
+                    }
+                });
+            } catch (...) {
+                for (auto* req : writes) {
+                    if (!req->error) {
+                        req->error = std::current_exception();
+                    }
+                }
+            }
+        }
+    }
+    
+    // 整组只做一次fdatasync，不持有追加锁，其他写入和读请求不会被阻塞
+    try {
+        // 本组写入期间可能发生过文件轮转，旧文件也要落盘后才能确认
+        sync_sealed_files();
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto files = data_files();
+        if (files->active) {
+            files->active->sync();
+        }
+        bytes_write_ = 0;
+    } catch (...) {
+        sync_error = std::current_exception();
+    }
+    
+    uint64_t latency_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    
+    // 更新统计并唤醒本组所有请求
+    commit_lock.lock();
+    sync_group_num_++;
+    sync_group_records_ += group.size();
+    sync_group_max_size_ = std::max(sync_group_max_size_, static_cast<uint32_t>(group.size()));
+    sync_group_total_latency_us_ += latency_us;
+    sync_group_max_latency_us_ = std::max(sync_group_max_latency_us_, latency_us);
+    for (auto* req : group) {
+        if (!req->error) {
+            req->error = sync_error;
+        }
+        req->done = true;
+    }
+    commit_leader_active_ = false;
+    commit_lock.unlock();
+    commit_cv_.notify_all();
+    
+    if (request.error) {
+        std::rethrow_exception(request.error);
     }
 }
 
@@ -173,24 +490,43 @@ void DB::fold(std::function<bool(const Bytes& key, const Bytes& value)> func) {
     std::shared_lock<std::shared_mutex> lock(mutex_);
     
     auto iter = index_->iterator(false);
-    for (iter->rewind(); iter->valid(); iter->next()) {
-        Bytes value = get_value_by_position(iter->value());
-        if (!func(iter->key(), value)) {
-            break;
+    std::vector<Bytes> keys;
+    std::vector<LogRecordPos> positions;
+    iter->rewind();
+    while (iter->valid()) {
+        keys.clear();
+        positions.clear();
+        for (; iter->valid() && keys.size() < FOLD_READ_BATCH_SIZE; iter->next()) {
+            keys.push_back(iter->key());
+            positions.push_back(iter->value());
+        }
+        
+        std::vector<Bytes> values = get_values_by_positions(positions);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (!func(keys[i], values[i])) {
+                iter->close();
+                return;
+            }
         }
     }
     iter->close();
 }
 
 void DB::sync() {
-    if (active_file_) {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+    sync_sealed_files();
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto files = data_files();
+    if (files->active) {
         // 强制同步数据到磁盘，确保数据持久化
-        active_file_->sync();
+        files->active->sync();
     }
 }
 
 void DB::close() {
+    // 停止后台线程，未使用的预创建文件不保留
+    stop_background_worker();
+    discard_next_data_file();
+    
     // 同步所有数据到磁盘
     if (active_file_) {
         try {
@@ -252,12 +588,33 @@ Stat DB::stat() {
     
     Stat stat;
     stat.key_num = static_cast<uint32_t>(index_->size());
-    stat.data_file_num = static_cast<uint32_t>(older_files_.size());
-    if (active_file_) {
-        stat.data_file_num++;
-    }
+    stat.data_file_num = static_cast<uint32_t>(data_files()->files.size());
     stat.reclaimable_size = reclaim_size_;
     
+    // 组提交统计
+    {
+        std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+        stat.sync_group_num = sync_group_num_;
+        stat.sync_group_records = sync_group_records_;
+        stat.sync_group_max_size = sync_group_max_size_;
+        stat.sync_group_max_latency_us = sync_group_max_latency_us_;
+        if (sync_group_num_ > 0) {
+            stat.sync_group_avg_size = static_cast<double>(sync_group_records_) / sync_group_num_;
+            stat.sync_group_avg_latency_us = static_cast<double>(sync_group_total_latency_us_) / sync_group_num_;
+        }
+    }
+    
+    // 值缓存统计
+    if (value_cache_) {
+        stat.value_cache_hits = value_cache_->hits();
+        stat.value_cache_misses = value_cache_->misses();
+        stat.value_cache_usage = value_cache_->usage();
+    }
+    
+    stat.corrupted_ranges = corrupted_ranges_;
+    stat.corrupted_bytes = corrupted_bytes_;
+    stat.truncated_tail_bytes = truncated_tail_bytes_;
+    
     // 计算磁盘大小
     try {
         stat.disk_size = utils::dir_size(options_.dir_path);
@@ -268,8 +625,32 @@ Stat DB::stat() {
     return stat;
 }
 
+std::vector<DataFileStat> DB::data_file_stats() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    auto files = data_files();
+    std::vector<DataFileStat> stats;
+    stats.reserve(files->files.size());
+    {
+        std::lock_guard<std::mutex> dead_lock(dead_bytes_mutex_);
+        for (const auto& [fid, data_file] : files->files) {
+            DataFileStat file_stat;
+            file_stat.file_id = fid;
+            file_stat.size = data_file->get_write_off();
+            auto it = dead_bytes_.find(fid);
+            file_stat.dead_bytes = it == dead_bytes_.end() ? 0 : it->second;
+            stats.push_back(file_stat);
+        }
+    }
+    std::sort(stats.begin(), stats.end(),
+              [](const DataFileStat& a, const DataFileStat& b) { return a.file_id < b.file_id; });
+    return stats;
+}
+
 void DB::backup(const std::string& dir) {
+    // 只在记下活跃文件的已提交长度时暂停写入，读请求不受影响；复制时不阻塞写入
     std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::unique_lock<std::mutex> append_lock(append_mutex_);
     
     // 创建备份目录
     try {
@@ -291,6 +672,14 @@ void DB::backup(const std::string& dir) {
     if (file_ids_.empty() && !active_file_) {
         return;
     }
+    // 等锁外预留的区域写完并刷出追加缓冲区，之后活跃文件中write_off之前的内容不再变化
+    {
+        std::unique_lock<std::mutex> publish_lock(publish_mutex_);
+        publish_cv_.wait(publish_lock, [this]() { return pending_appends_ == 0; });
+    }
+    if (active_file_) {
+        active_file_->flush();
+    }
     // 同步数据到磁盘，确保数据完整性
     // 使用非阻塞的同步策略，避免在某些环境下阻塞
     try {
@@ -332,37 +721,73 @@ void DB::backup(const std::string& dir) {
     // 备份数据文件
     bool any_file_copied = false;
     
-    // 首先备份活跃文件（最重要的数据）
+    // 持锁时打开活跃文件并记下已提交的长度，放开写入后只复制这一部分，之后的追加不会混进备份
+    bool has_files = active_file_ || !file_ids_.empty();
+    uint32_t active_fid = active_file_ ? active_file_->get_file_id() : UINT32_MAX;
+    uint64_t active_size = active_file_ ? active_file_->get_write_off() : 0;
+    int active_fd = -1;
     if (active_file_) {
-        uint32_t active_fid = active_file_->get_file_id();
         std::string src_file = DataFile::get_data_file_name(options_.dir_path, active_fid);
-        std::string dst_file = DataFile::get_data_file_name(dir, active_fid);
-        
+        active_fd = ::open(src_file.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    
+    // 旧数据文件：持有共享锁时merge不会替换它们，可以放开写入并限速复制
+    std::vector<uint32_t> sealed_ids;
+    for (uint32_t fid : file_ids_) {
+        // 跳过活跃文件（单独按已提交长度复制）
+        if (fid != active_fid) {
+            sealed_ids.push_back(fid);
+        }
+    }
+    append_lock.unlock();
+    std::sort(sealed_ids.begin(), sealed_ids.end());
+    
+    // 首先备份活跃文件（最重要的数据），不限速以便尽快完成
+    if (active_fd != -1) {
         try {
-            if (utils::file_exists(src_file)) {
-                utils::copy_file(src_file, dst_file);
-                any_file_copied = true;
-            }
+            utils::copy_file_prefix(active_fd, DataFile::get_data_file_name(dir, active_fid), active_size);
+            any_file_copied = true;
         } catch (const std::exception&) {
+            ::close(active_fd);
             // 活跃文件复制失败是严重问题
             throw BitcaskException("Failed to backup active data file");
         }
+        ::close(active_fd);
     }
     
-    // 然后备份所有已知的旧数据文件
-    for (uint32_t fid : file_ids_) {
-        // 跳过活跃文件（已经备份过了）
-        if (active_file_ && fid == active_file_->get_file_id()) {
-            continue;
+    // 上次备份之后被merge合并掉的文件要从备份中删除，否则恢复时会读到旧数据
+    for (uint32_t fid : DataFile::list_data_file_ids(dir)) {
+        if (fid != active_fid && !std::binary_search(sealed_ids.begin(), sealed_ids.end(), fid)) {
+            std::remove(DataFile::get_data_file_name(dir, fid).c_str());
+            std::remove(DataFile::get_hint_file_name(dir, fid).c_str());
         }
-        
+    }
+    
+    // 旧文件不再修改，备份中已有的相同文件直接跳过；同一文件系统上用硬链接代替复制
+    // （merge替换文件时改名生成新的inode，不影响链接到备份中的旧文件）
+    RateLimiter::ActiveScope io_scope(io_limiter_.get());
+    for (uint32_t fid : sealed_ids) {
         std::string src_file = DataFile::get_data_file_name(options_.dir_path, fid);
         std::string dst_file = DataFile::get_data_file_name(dir, fid);
+        std::string hint_src = DataFile::get_hint_file_name(options_.dir_path, fid);
+        std::string hint_dst = DataFile::get_hint_file_name(dir, fid);
         
         try {
-            if (utils::file_exists(src_file)) {
-                utils::copy_file(src_file, dst_file);
-                any_file_copied = true;
+            if (!utils::file_exists(src_file)) {
+                continue;
+            }
+            if (!utils::file_exists(dst_file) || !backup_file_unchanged(options_.dir_path, dir, fid)) {
+                std::remove(hint_dst.c_str());
+                if (!utils::link_file(src_file, dst_file)) {
+                    utils::copy_file(src_file, dst_file, io_limiter_.get());
+                }
+            }
+            any_file_copied = true;
+            
+            // 提示文件同样不再修改，可能在上次备份之后才生成
+            if (utils::file_exists(hint_src) && !utils::file_exists(hint_dst) &&
+                !utils::link_file(hint_src, hint_dst)) {
+                utils::copy_file(hint_src, hint_dst, io_limiter_.get());
             }
         } catch (const std::exception&) {
             // 忽略单个旧文件复制失败，继续处理其他文件
@@ -371,7 +796,7 @@ void DB::backup(const std::string& dir) {
     }
     
     // 如果没有复制任何数据文件，可能是数据库为空
-    if (!any_file_copied && (active_file_ || !file_ids_.empty())) {
+    if (!any_file_copied && has_files) {
         // 有文件但没复制成功，可能是权限或路径问题
         throw BitcaskException("No data files were copied during backup");
     }
@@ -382,6 +807,8 @@ void DB::backup(const std::string& dir) {
         std::string hint_dst = dir + "/" + HINT_FILE_NAME;
         if (utils::file_exists(hint_src)) {
             utils::copy_file(hint_src, hint_dst);
+        } else {
+            std::remove(hint_dst.c_str());
         }
     } catch (const std::exception&) {
         // 忽略hint文件复制错误
@@ -410,6 +837,105 @@ void DB::backup(const std::string& dir) {
             // 忽略B+Tree索引文件复制错误
         }
     }
+    
+    // 让链接、复制和删除的目录项落盘
+    utils::sync_dir(dir);
+}
+
+void DB::checkpoint(const std::string& dir) {
+    if (utils::directory_exists(dir)) {
+        throw BitcaskException("Checkpoint directory already exists: " + dir);
+    }
+    // 先在临时目录中生成，完成后整体改名，中途失败不会留下不完整的检查点
+    std::string temp_dir = dir + ".tmp";
+    utils::remove_directory(temp_dir);
+    utils::create_directory(temp_dir);
+    
+    // 需要复制的文件：持锁时打开，之后被merge改名替换也仍然读到快照时的内容
+    struct PendingCopy {
+        int fd;
+        std::string dst;
+        uint64_t length;
+    };
+    std::vector<PendingCopy> copies;
+    auto open_for_copy = [&](uint32_t fid, uint64_t length) {
+        std::string src = DataFile::get_data_file_name(options_.dir_path, fid);
+        int fd = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw BitcaskException("Failed to open data file for checkpoint: " + src);
+        }
+        copies.push_back(PendingCopy{fd, DataFile::get_data_file_name(temp_dir, fid), length});
+    };
+    auto close_copies = [&]() {
+        for (const auto& copy : copies) {
+            ::close(copy.fd);
+        }
+        copies.clear();
+    };
+    
+    try {
+        {
+            // 持有共享锁期间merge不会替换或删除旧文件，读写照常进行
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            std::vector<uint32_t> sealed_ids;
+            bool has_active = false;
+            uint32_t active_fid = 0;
+            uint64_t active_size = 0;
+            {
+                // 只在这里暂停写入：等锁外预留的区域写完，刷出追加缓冲区，记下文件集合和活跃文件的长度
+                std::lock_guard<std::mutex> append_lock(append_mutex_);
+                {
+                    std::unique_lock<std::mutex> publish_lock(publish_mutex_);
+                    publish_cv_.wait(publish_lock, [this]() { return pending_appends_ == 0; });
+                }
+                if (active_file_) {
+                    active_file_->flush();
+                    has_active = true;
+                    active_fid = active_file_->get_file_id();
+                    active_size = active_file_->get_write_off();
+                }
+                for (const auto& [fid, data_file] : older_files_) {
+                    sealed_ids.push_back(fid);
+                }
+            }
+            
+            // 刚轮转出的旧文件可能还没落盘，硬链接共享同一份数据，要先同步
+            sync_sealed_files();
+            for (uint32_t fid : sealed_ids) {
+                std::string src = DataFile::get_data_file_name(options_.dir_path, fid);
+                if (!utils::link_file(src, DataFile::get_data_file_name(temp_dir, fid))) {
+                    open_for_copy(fid, UINT64_MAX);
+                    continue;
+                }
+                // 提示文件只用于加速启动，链接失败时忽略
+                std::string hint_src = DataFile::get_hint_file_name(options_.dir_path, fid);
+                if (utils::file_exists(hint_src)) {
+                    utils::link_file(hint_src, DataFile::get_hint_file_name(temp_dir, fid));
+                }
+            }
+            // 活跃文件之后还会追加，只复制记下的已提交部分
+            if (has_active) {
+                open_for_copy(active_fid, active_size);
+            }
+        }
+        
+        RateLimiter::ActiveScope io_scope(io_limiter_.get());
+        for (const auto& copy : copies) {
+            utils::copy_file_prefix(copy.fd, copy.dst, copy.length, io_limiter_.get());
+            utils::sync_file(copy.dst);
+        }
+        close_copies();
+        
+        utils::sync_dir(temp_dir);
+        if (rename(temp_dir.c_str(), dir.c_str()) != 0) {
+            throw BitcaskException("Failed to rename checkpoint directory: " + temp_dir + " -> " + dir);
+        }
+        utils::sync_dir(utils::dir_name(dir));
+    } catch (...) {
+        close_copies();
+        utils::remove_directory(temp_dir);
+        throw;
+    }
 }
 
 LogRecordPos DB::append_log_record(const LogRecord& record) {
@@ -417,40 +943,43 @@ LogRecordPos DB::append_log_record(const LogRecord& record) {
     return append_log_record_internal(record);
 }
 
-LogRecordPos DB::append_log_record_internal(const LogRecord& record) {
+size_t DB::sync_marker_size(uint64_t write_off, uint64_t size) const {
+    // 记录跨过同步间隔的边界时先写一个同步标记，文件开头本身就是同步点
+    uint64_t interval = options_.sync_marker_interval;
+    if (interval == 0 || write_off == 0 || write_off / interval == (write_off + size) / interval) {
+        return 0;
+    }
+    return encoded_sync_marker().size();
+}
+
+LogRecordPos DB::append_log_record_internal(const LogRecord& record, bool defer_sync) {
     // 如果活跃文件不存在，创建新文件
     if (!active_file_) {
         set_active_data_file();
     }
     
-    // 编码日志记录
-    auto [encoded_data, size] = record.encode();
+    // 只计算编码后的大小，写入时头部与key、value分散写入
+    size_t size = record.encoded_size();
+    size_t marker_size = sync_marker_size(active_file_->get_write_off(), size);
     
     // 如果写入数据超过文件阈值，创建新文件
-    if (active_file_->get_write_off() + size > options_.data_file_size) {
-        // 同步当前文件
-        active_file_->sync();
-        
-        // 将当前活跃文件转为旧文件
-        uint32_t file_id = active_file_->get_file_id();
-        older_files_[file_id] = std::move(active_file_);
-        
-        // 确保file_ids_包含这个文件ID
-        if (std::find(file_ids_.begin(), file_ids_.end(), file_id) == file_ids_.end()) {
-            file_ids_.push_back(file_id);
-            std::sort(file_ids_.begin(), file_ids_.end());
-        }
-        
-        // 创建新的活跃文件
-        set_active_data_file();
+    if (active_file_->get_write_off() + marker_size + size > options_.data_file_size) {
+        rotate_active_data_file();
+        marker_size = sync_marker_size(active_file_->get_write_off(), size);
     }
     
+    if (marker_size > 0) {
+        active_file_->write(sync_marker_record());
+    }
     uint64_t write_off = active_file_->get_write_off();
-    active_file_->write(encoded_data);
+    active_file_->write(record);
     
     bytes_write_ += size;
     
-    // 根据配置决定是否同步
+    // 根据配置决定是否同步（组提交时由leader统一同步）
+    if (defer_sync) {
+        return LogRecordPos(active_file_->get_file_id(), write_off, static_cast<uint32_t>(size));
+    }
     bool need_sync = options_.sync_writes;
     if (!need_sync && options_.bytes_per_sync > 0 && 
         bytes_write_ >= options_.bytes_per_sync) {
@@ -475,65 +1004,500 @@ LogRecordPos DB::append_log_record_internal(const LogRecord& record) {
     return LogRecordPos(active_file_->get_file_id(), write_off, static_cast<uint32_t>(size));
 }
 
-Bytes DB::get_value_by_position(const LogRecordPos& pos) {
-    // 根据文件ID找到对应的数据文件
-    DataFile* data_file = nullptr;
-    if (active_file_ && active_file_->get_file_id() == pos.fid) {
-        data_file = active_file_.get();
-    } else {
-        auto it = older_files_.find(pos.fid);
-        if (it != older_files_.end()) {
-            data_file = it->second.get();
+std::vector<LogRecordPos> DB::append_log_records(
+        const std::vector<const LogRecord*>& records, AppendSync sync_mode,
+        const std::function<void(const std::vector<LogRecordPos>&)>& apply) {
+    std::vector<LogRecordPos> positions;
+    positions.reserve(records.size());
+    uint64_t total_size = 0;
+    for (const auto* record : records) {
+        total_size += record->encoded_size();
+    }
+    if (append_failed_.load(std::memory_order_acquire)) {
+        throw BitcaskException("Database is read-only after an append could not be written or repaired");
+    }
+    
+    uint64_t ticket = 0;
+    uint64_t marker_offset = 0;             // 同步标记的位置
+    size_t marker_size = 0;
+    DataFile* last_file = nullptr;          // 最后一条记录所在的文件
+    bool write_outside = false;             // 是否在追加锁外写入预留的区域
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> append_lock(append_mutex_);
+        ticket = next_append_ticket_++;
+        try {
+            if (!active_file_) {
+                set_active_data_file();
+            }
+            
+            if (options_.write_buffer_size > 0 || total_size > options_.data_file_size) {
+                // 追加缓冲区只是内存拷贝，直接在锁内写入；
+                // 一组记录放不进一个文件时逐条写入，由append_log_record_internal按需轮转
+                for (const auto* record : records) {
+                    positions.push_back(append_log_record_internal(*record, true));
+                }
+            } else {
+                marker_size = sync_marker_size(active_file_->get_write_off(), total_size);
+                if (active_file_->get_write_off() + marker_size + total_size > options_.data_file_size) {
+                    rotate_active_data_file();
+                    marker_size = sync_marker_size(active_file_->get_write_off(), total_size);
+                }
+                uint64_t offset = active_file_->reserve(marker_size + total_size);
+                marker_offset = offset;
+                offset += marker_size;
+                for (const auto* record : records) {
+                    size_t size = record->encoded_size();
+                    positions.emplace_back(active_file_->get_file_id(), offset, static_cast<uint32_t>(size));
+                    offset += size;
+                }
+                write_outside = true;
+                std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+                pending_appends_++;
+            }
+            last_file = active_file_.get();
+        } catch (...) {
+            error = std::current_exception();
         }
     }
     
-    if (!data_file) {
-        throw DataFileNotFoundError();
+    // 预留的区域互不重叠，多个写入可以同时进行
+    if (write_outside) {
+        try {
+            if (marker_size > 0) {
+                last_file->write_at(marker_offset, sync_marker_record());
+            }
+            for (size_t i = 0; i < records.size(); ++i) {
+                last_file->write_at(positions[i].offset, *records[i]);
+            }
+            bytes_write_ += total_size;
+        } catch (...) {
+            error = std::current_exception();
+            // 写入偏移已经越过这个区域，留下空洞的话恢复会在这里停止或当作损坏跳过，
+            // 后面已确认的写入随之丢失；修补不了时后面的写入都不能再确认
+            if (!pad_reserved_range(last_file, marker_offset, marker_size + total_size)) {
+                append_failed_.store(true, std::memory_order_release);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+            pending_appends_--;
+        }
+        publish_cv_.notify_all();
     }
     
-    // 根据偏移读取数据
-    ReadLogRecord read_record = data_file->read_log_record(pos.offset);
+    // 按预留顺序更新索引，出错时也要让出顺序，避免后面的写入一直等待。
+    // 轮到这次写入时，前面预留的区域都已写完或修补完，落盘才能覆盖它们；
+    // 在此之前落盘的话，崩溃后前面的区域可能是空洞，这次已确认的写入随之丢失
+    {
+        std::unique_lock<std::mutex> publish_lock(publish_mutex_);
+        publish_cv_.wait(publish_lock, [this, ticket]() { return published_append_ticket_ == ticket; });
+    }
     
-    if (read_record.record.type == LogRecordType::DELETED) {
-        throw KeyNotFoundError();
+    // 持有顺序期间后面的写入不会发布，落盘时不需要持有publish_mutex_
+    if (!error) {
+        bool need_sync = sync_mode == AppendSync::ALWAYS;
+        if (sync_mode == AppendSync::POLICY) {
+            need_sync = options_.sync_writes ||
+                        (options_.bytes_per_sync > 0 && bytes_write_ >= options_.bytes_per_sync);
+        }
+        if (need_sync) {
+            try {
+                if (sync_mode == AppendSync::ALWAYS) {
+                    // 这组记录可能跨越了文件轮转，旧文件也要落盘
+                    sync_sealed_files();
+                }
+                last_file->sync();
+                bytes_write_ = 0;
+            } catch (...) {
+                // 按配置的同步失败不影响写入结果，只重置字节计数
+                bytes_write_ = 0;
+                if (sync_mode == AppendSync::ALWAYS) {
+                    error = std::current_exception();
+                }
+            }
+        }
     }
     
-    return read_record.record.value;
-}
-
-void DB::set_active_data_file() {
-    uint32_t initial_file_id = INITIAL_FILE_ID;
-    if (active_file_) {
-        initial_file_id = active_file_->get_file_id() + 1;
+    {
+        std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+        if (!error && append_failed_.load(std::memory_order_acquire)) {
+            // 前面有写入留下了无法修补的空洞，这次写入在它之后，恢复时可能读不到
+            error = std::make_exception_ptr(
+                BitcaskException("Append failed: an earlier append left an unrepaired hole in the data file"));
+        }
+        if (!error) {
+            try {
+                apply(positions);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        published_append_ticket_++;
     }
+    publish_cv_.notify_all();
     
-    active_file_ = DataFile::open_data_file(options_.dir_path, initial_file_id, IOType::STANDARD_FIO);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return positions;
 }
 
-void DB::load_data_files() {
-    std::vector<uint32_t> file_ids;
-    
-    // 优化文件扫描：限制扫描范围并提前退出
-    uint32_t consecutive_missing = 0;
-    const uint32_t MAX_CONSECUTIVE_MISSING = 5;  // 连续缺失5个文件就停止
-    const uint32_t MAX_SCAN_FILES = 1000;       // 最多扫描1000个文件
-    
-    for (uint32_t fid = 0; fid < MAX_SCAN_FILES; ++fid) {
-        std::string file_path = DataFile::get_data_file_name(options_.dir_path, fid);
-        if (utils::file_exists(file_path)) {
-            file_ids.push_back(fid);
-            consecutive_missing = 0;  // 重置连续缺失计数
-        } else {
-            consecutive_missing++;
-            // 如果已经找到文件但连续缺失太多，则停止扫描
-            if (!file_ids.empty() && consecutive_missing >= MAX_CONSECUTIVE_MISSING) {
-                break;
+bool DB::pad_reserved_range(DataFile* file, uint64_t offset, uint64_t size) {
+    try {
+        while (size > 0) {
+            uint64_t chunk = std::min<uint64_t>(size, MAX_PADDING_RECORD_SIZE);
+            if (size > chunk && size - chunk < MIN_PADDING_RECORD_SIZE) {
+                // 剩下的部分放不下一条填充记录，从这一条里让出
+                chunk -= MIN_PADDING_RECORD_SIZE;
+            }
+            file->write_at(offset, padding_record(static_cast<size_t>(chunk)));
+            offset += chunk;
+            size -= chunk;
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void DB::rotate_active_data_file() {
+    // 等待锁外还没写完的记录，旧文件封存前内容必须完整
+    {
+        std::unique_lock<std::mutex> publish_lock(publish_mutex_);
+        publish_cv_.wait(publish_lock, [this]() { return pending_appends_ == 0; });
+    }
+    
+    uint32_t file_id = active_file_->get_file_id();
+    if (options_.background_file_rotation) {
+        // 只刷出追加缓冲区，fdatasync交给后台线程，不阻塞当前写入
+        active_file_->flush();
+        {
+            std::lock_guard<std::mutex> bg_lock(bg_mutex_);
+            sealed_files_.push_back(DataFile::get_data_file_name(options_.dir_path, file_id));
+        }
+        bg_cv_.notify_one();
+    } else {
+        // 同步当前文件
+        active_file_->sync();
+    }
+    
+    // 封存后的文件读取不再加锁
+    active_file_->seal(options_.mmap_sealed_files);
+    
+    // 将当前活跃文件转为旧文件，新表发布前读请求仍能通过旧表找到它
+    older_files_[file_id] = std::move(active_file_);
+    
+    // 确保file_ids_包含这个文件ID
+    if (std::find(file_ids_.begin(), file_ids_.end(), file_id) == file_ids_.end()) {
+        file_ids_.push_back(file_id);
+        std::sort(file_ids_.begin(), file_ids_.end());
+    }
+    
+    // 创建新的活跃文件
+    set_active_data_file();
+    
+    // 新表发布后旧文件不再是活跃文件，后台为它生成提示文件
+    if (options_.background_file_rotation && options_.data_file_hints) {
+        request_hint_files({file_id});
+    }
+}
+
+void DB::publish_data_files() {
+    auto table = std::make_shared<DataFileTable>();
+    table->files.reserve(older_files_.size() + 1);
+    for (const auto& [fid, file] : older_files_) {
+        table->files[fid] = file.get();
+    }
+    if (active_file_) {
+        table->active = active_file_.get();
+        table->files[active_file_->get_file_id()] = table->active;
+    }
+    std::atomic_store(&data_file_table_, std::shared_ptr<const DataFileTable>(std::move(table)));
+}
+
+std::shared_ptr<const DB::DataFileTable> DB::data_files() const {
+    return std::atomic_load(&data_file_table_);
+}
+
+Bytes DB::get_value_by_position(const LogRecordPos& pos) {
+    Bytes value;
+    ValueCacheKey cache_key{file_epoch_.load(), pos.fid, pos.offset};
+    if (value_cache_ && value_cache_->get(cache_key, value)) {
+        return value;
+    }
+    
+    // 根据文件ID找到对应的数据文件
+    auto files = data_files();
+    auto it = files->files.find(pos.fid);
+    if (it == files->files.end()) {
+        throw DataFileNotFoundError();
+    }
+    DataFile* data_file = it->second;
+    
+    // 位置中记录了完整长度，一次读取整条记录
+    ReadLogRecord read_record = data_file->read_log_record(pos.offset, pos.size);
+    
+    if (read_record.record.type == LogRecordType::DELETED) {
+        throw KeyNotFoundError();
+    }
+    
+    if (value_cache_) {
+        value_cache_->put(cache_key, read_record.record.value);
+    }
+    return std::move(read_record.record.value);
+}
+
+std::vector<Bytes> DB::get_values_by_positions(const std::vector<LogRecordPos>& positions) {
+    std::vector<Bytes> values(positions.size());
+    uint64_t epoch = file_epoch_.load();
+    
+    // 缓存未命中的位置按文件分组，每个文件批量读取一次
+    std::map<uint32_t, std::vector<size_t>> misses;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (value_cache_ && value_cache_->get(ValueCacheKey{epoch, positions[i].fid, positions[i].offset}, values[i])) {
+            continue;
+        }
+        misses[positions[i].fid].push_back(i);
+    }
+    if (misses.empty()) {
+        return values;
+    }
+    
+    auto files = data_files();
+    std::vector<LogRecordPos> batch;
+    for (const auto& [fid, indexes] : misses) {
+        auto it = files->files.find(fid);
+        if (it == files->files.end()) {
+            throw DataFileNotFoundError();
+        }
+        batch.clear();
+        for (size_t i : indexes) {
+            batch.push_back(positions[i]);
+        }
+        std::vector<ReadLogRecord> records = it->second->read_log_records(batch);
+        for (size_t j = 0; j < indexes.size(); ++j) {
+            if (records[j].record.type == LogRecordType::DELETED) {
+                throw KeyNotFoundError();
+            }
+            if (value_cache_) {
+                value_cache_->put(ValueCacheKey{epoch, fid, batch[j].offset}, records[j].record.value);
+            }
+            values[indexes[j]] = std::move(records[j].record.value);
+        }
+    }
+    return values;
+}
+
+void DB::set_active_data_file() {
+    uint32_t initial_file_id = INITIAL_FILE_ID;
+    if (active_file_) {
+        initial_file_id = active_file_->get_file_id() + 1;
+    } else {
+        // 活跃文件已转为旧文件时，新文件ID要排在所有旧文件之后，避免覆盖已有文件
+        for (const auto& [fid, file] : older_files_) {
+            initial_file_id = std::max(initial_file_id, fid + 1);
+        }
+    }
+    
+    // 后台已经预创建好时轮转只是一次指针交换
+    active_file_ = take_next_data_file(initial_file_id);
+    if (!active_file_) {
+        active_file_ = DataFile::open_data_file(options_.dir_path, initial_file_id, options_.io_type);
+    }
+    if (options_.write_buffer_size > 0) {
+        active_file_->enable_write_buffer(options_.write_buffer_size);
+    }
+    publish_data_files();
+    
+    if (options_.background_file_rotation) {
+        request_next_data_file(initial_file_id + 1);
+    }
+}
+
+void DB::start_background_worker() {
+    if (bg_thread_.joinable()) {
+        return;
+    }
+    bg_stop_ = false;
+    bg_thread_ = std::thread(&DB::background_worker, this);
+}
+
+void DB::stop_background_worker() {
+    {
+        std::lock_guard<std::mutex> bg_lock(bg_mutex_);
+        bg_stop_ = true;
+    }
+    bg_cv_.notify_all();
+    if (bg_thread_.joinable()) {
+        bg_thread_.join();
+    }
+    
+    // 剩余的旧文件由调用者同步，没来得及生成的提示文件下次启动时再生成
+    std::lock_guard<std::mutex> bg_lock(bg_mutex_);
+    sealed_files_.clear();
+    pending_hints_.clear();
+}
+
+void DB::background_worker() {
+    std::unique_lock<std::mutex> bg_lock(bg_mutex_);
+    while (true) {
+        bg_cv_.wait(bg_lock, [this]() {
+            return bg_stop_ || !sealed_files_.empty() || (next_file_id_ >= 0 && !next_file_) ||
+                   !pending_hints_.empty();
+        });
+        if (bg_stop_) {
+            break;
+        }
+        
+        // 优先同步旧文件，缩短数据未落盘的时间窗口
+        if (!sealed_files_.empty()) {
+            std::vector<std::string> files;
+            files.swap(sealed_files_);
+            sealed_syncing_++;
+            bg_lock.unlock();
+            std::exception_ptr error;
+            for (const auto& file_path : files) {
+                try {
+                    utils::sync_file(file_path);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            bg_lock.lock();
+            if (error && !sealed_sync_error_) {
+                // 这些文件里的写入可能没有落盘，交给下一个等待同步的写入报告
+                sealed_sync_error_ = error;
+            }
+            sealed_syncing_--;
+            bg_done_cv_.notify_all();
+            continue;
+        }
+        
+        // 其次预创建下一个数据文件并预分配空间
+        if (next_file_id_ >= 0 && !next_file_) {
+            uint32_t file_id = static_cast<uint32_t>(next_file_id_);
+            next_file_creating_ = true;
+            bg_lock.unlock();
+            std::unique_ptr<DataFile> data_file;
+            try {
+                data_file = DataFile::open_data_file(options_.dir_path, file_id, options_.io_type);
+                data_file->preallocate(options_.data_file_size);
+            } catch (const std::exception&) {
+                data_file.reset();
+            }
+            bg_lock.lock();
+            next_file_creating_ = false;
+            
+            if (data_file && next_file_id_ == static_cast<int64_t>(file_id)) {
+                next_file_ = std::move(data_file);
+            } else {
+                if (data_file) {
+                    // 请求已被取消，这个文件不会被任何人使用
+                    bool empty = data_file->file_size() == 0;
+                    data_file->close();
+                    if (empty) {
+                        std::remove(DataFile::get_data_file_name(options_.dir_path, file_id).c_str());
+                    }
+                } else if (next_file_id_ == static_cast<int64_t>(file_id)) {
+                    // 创建失败时放弃这次预创建，轮转时在前台创建
+                    next_file_id_ = -1;
+                }
+            }
+            bg_done_cv_.notify_all();
+            continue;
+        }
+        
+        // 最后生成提示文件，一次一个，不耽误同步和预创建
+        uint32_t hint_fid = pending_hints_.front();
+        pending_hints_.erase(pending_hints_.begin());
+        bg_lock.unlock();
+        build_hint_file(hint_fid);
+        bg_lock.lock();
+    }
+}
+
+void DB::request_next_data_file(uint32_t file_id) {
+    {
+        std::lock_guard<std::mutex> bg_lock(bg_mutex_);
+        next_file_id_ = file_id;
+    }
+    bg_cv_.notify_one();
+}
+
+std::unique_ptr<DataFile> DB::take_next_data_file(uint32_t file_id) {
+    std::unique_ptr<DataFile> data_file;
+    {
+        std::unique_lock<std::mutex> bg_lock(bg_mutex_);
+        // 后台正在创建时等它完成，避免两边同时打开同一个文件
+        bg_done_cv_.wait(bg_lock, [this]() { return !next_file_creating_; });
+        next_file_id_ = -1;
+        data_file = std::move(next_file_);
+    }
+    if (data_file && data_file->get_file_id() != file_id) {
+        std::string file_path = DataFile::get_data_file_name(options_.dir_path, data_file->get_file_id());
+        bool empty = data_file->file_size() == 0;
+        data_file->close();
+        if (empty && data_file->get_file_id() > file_id) {
+            std::remove(file_path.c_str());
+        }
+        data_file.reset();
+    }
+    return data_file;
+}
+
+void DB::discard_next_data_file() {
+    std::unique_ptr<DataFile> data_file;
+    {
+        std::unique_lock<std::mutex> bg_lock(bg_mutex_);
+        bg_done_cv_.wait(bg_lock, [this]() { return !next_file_creating_; });
+        next_file_id_ = -1;
+        data_file = std::move(next_file_);
+    }
+    if (data_file) {
+        std::string file_path = DataFile::get_data_file_name(options_.dir_path, data_file->get_file_id());
+        bool empty = data_file->file_size() == 0;
+        data_file->close();
+        if (empty) {
+            std::remove(file_path.c_str());
+        }
+    }
+}
+
+void DB::sync_sealed_files() {
+    std::vector<std::string> files;
+    {
+        std::lock_guard<std::mutex> bg_lock(bg_mutex_);
+        files.swap(sealed_files_);
+    }
+    // 一个文件失败也继续同步其余文件，最后报告第一个错误
+    std::exception_ptr error;
+    for (const auto& file_path : files) {
+        try {
+            utils::sync_file(file_path);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
             }
         }
     }
     
-    // 排序文件ID
-    std::sort(file_ids.begin(), file_ids.end());
+    // 等待后台线程手上正在同步的批次，它遇到的错误也由这里报告
+    std::unique_lock<std::mutex> bg_lock(bg_mutex_);
+    bg_done_cv_.wait(bg_lock, [this]() { return sealed_syncing_ == 0; });
+    if (!error) {
+        error = sealed_sync_error_;
+    }
+    sealed_sync_error_ = nullptr;
+    bg_lock.unlock();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void DB::load_data_files() {
+    // 读一遍目录找出所有数据文件，文件ID不要求连续，也没有数量上限
+    std::vector<uint32_t> file_ids = DataFile::list_data_file_ids(options_.dir_path);
     file_ids_ = file_ids;
     
     // 如果没有找到数据文件，创建初始文件
@@ -548,19 +1512,24 @@ void DB::load_data_files() {
     // 打开数据文件
     for (size_t i = 0; i < file_ids.size(); ++i) {
         uint32_t fid = file_ids[i];
-        IOType io_type = options_.mmap_at_startup ? IOType::MEMORY_MAP : IOType::STANDARD_FIO;
+        IOType io_type = options_.mmap_at_startup ? IOType::MEMORY_MAP : options_.io_type;
         auto data_file = DataFile::open_data_file(options_.dir_path, fid, io_type);
         
         if (i == file_ids.size() - 1) {
             // 最后一个文件是活跃文件
             active_file_ = std::move(data_file);
+            if (options_.write_buffer_size > 0) {
+                active_file_->enable_write_buffer(options_.write_buffer_size);
+            }
             // 注意：不要在这里设置写入偏移，应该在索引重建后设置
             // 这样可以确保索引重建时能从文件开头正确读取所有数据
         } else {
             // 其他是旧文件
+            data_file->seal(options_.mmap_sealed_files);
             older_files_[fid] = std::move(data_file);
         }
     }
+    publish_data_files();
 }
 
 void DB::load_index_from_data_files() {
@@ -590,15 +1559,15 @@ void DB::load_index_from_data_files() {
     auto update_index = [this, &put_count, &delete_count](const Bytes& key, LogRecordType type, const LogRecordPos& pos) {
         if (type == LogRecordType::DELETED) {
             auto [old_pos, ok] = index_->remove(key);
-            reclaim_size_ += pos.size;
+            mark_dead(pos);
             if (old_pos) {
-                reclaim_size_ += old_pos->size;
+                mark_dead(*old_pos);
             }
             delete_count++;
         } else {
             auto old_pos = index_->put(key, pos);
             if (old_pos) {
-                reclaim_size_ += old_pos->size;
+                mark_dead(*old_pos);
             }
             put_count++;
         }
@@ -639,68 +1608,63 @@ void DB::load_index_from_data_files() {
         }
     }
     
-    // 遍历所有需要处理的文件
-    int processed_records = 0;
-    for (const auto& [fid, data_file] : files_to_process) {
-        uint64_t offset = 0;
-        int file_records = 0;
-        while (true) {
-            try {
-                ReadLogRecord read_record = data_file->read_log_record(offset);
-                
-                // 构造位置信息
-                LogRecordPos log_record_pos(fid, offset, static_cast<uint32_t>(read_record.size));
-                
-                // 解析key，获取序列号
-                auto [real_key, seq_no] = parse_log_record_key(read_record.record.key);
-                
-                if (seq_no == NON_TRANSACTION_SEQ_NO) {
-                    // 非事务操作，直接更新索引
-                    update_index(real_key, read_record.record.type, log_record_pos);
-                    file_records++;
-                    processed_records++;
-                } else {
-                    // 事务操作
-                    if (read_record.record.type == LogRecordType::TXN_FINISHED) {
-                        // 事务完成，更新所有相关记录到索引
-                        auto it = transaction_records.find(seq_no);
-                        if (it != transaction_records.end()) {
-                            for (const auto& txn_record : it->second) {
-                                update_index(txn_record.record->key, txn_record.record->type, txn_record.pos);
-                            }
-                            transaction_records.erase(it);
-                        }
-                    } else {
-                        // 暂存事务记录
-                        auto log_record = std::make_shared<LogRecord>(read_record.record);
-                        log_record->key = real_key;
-                        transaction_records[seq_no].emplace_back(log_record, log_record_pos);
+    // 没有提示文件的封存文件，加载完成后交给后台生成
+    std::vector<uint32_t> missing_hints;
+    corrupted_ranges_ = 0;
+    corrupted_bytes_ = 0;
+    truncated_tail_bytes_ = 0;
+    
+    // 各文件的扫描结果按文件ID顺序应用，后面的文件覆盖前面的；
+    // 事务记录暂存到读到TXN_FINISHED为止，事务可以跨文件
+    auto apply_run = [&](uint32_t fid, IndexRun& run) {
+        bool is_active = active_file_ && active_file_->get_file_id() == fid;
+        if (!run.from_hint && !is_active) {
+            missing_hints.push_back(fid);
+        }
+        corrupted_ranges_ += run.corrupted_ranges;
+        corrupted_bytes_ += run.corrupted_bytes;
+        
+        for (auto& entry : run.entries) {
+            if (entry.seq_no == NON_TRANSACTION_SEQ_NO) {
+                // 非事务操作，直接更新索引
+                update_index(entry.key, entry.type, entry.pos);
+            } else if (entry.type == LogRecordType::TXN_FINISHED) {
+                // 事务完成，更新所有相关记录到索引
+                auto it = transaction_records.find(entry.seq_no);
+                if (it != transaction_records.end()) {
+                    for (const auto& txn_record : it->second) {
+                        update_index(txn_record.record->key, txn_record.record->type, txn_record.pos);
                     }
+                    transaction_records.erase(it);
                 }
-                
-                // 更新序列号
-                if (seq_no > current_seq_no) {
-                    current_seq_no = seq_no;
-                }
-                
-                offset += read_record.size;
-                
-            } catch (const ReadDataFileEOFError&) {
-                break;
-            } catch (const std::exception& e) {
-                // 跳过损坏的记录，继续处理
-                offset += 1;
-                if (offset >= data_file->file_size()) {
-                    break;
-                }
-                continue;
+            } else {
+                // 暂存事务记录，只需要key和类型
+                auto log_record = std::make_shared<LogRecord>(std::move(entry.key), Bytes{}, entry.type);
+                transaction_records[entry.seq_no].emplace_back(log_record, entry.pos);
+            }
+            
+            // 更新序列号
+            if (entry.seq_no > current_seq_no) {
+                current_seq_no = entry.seq_no;
             }
         }
         
-        // 如果是活跃文件，设置写入偏移到当前处理的位置（通常是文件末尾）
-        if (active_file_ && active_file_->get_file_id() == fid) {
-            active_file_->set_write_off(offset);
+        // 如果是活跃文件，设置写入偏移到当前处理的位置（通常是文件末尾）；
+        // 末尾写了一半的记录直接截掉，新的写入不会留在残缺数据后面
+        if (is_active) {
+            if (run.torn_tail_bytes > 0) {
+                active_file_->truncate(run.end_offset);
+                truncated_tail_bytes_ += run.torn_tail_bytes;
+            } else {
+                active_file_->set_write_off(run.end_offset);
+            }
         }
+    };
+    
+    scan_data_files_in_order(files_to_process, apply_run);
+    
+    if (options_.background_file_rotation && options_.data_file_hints && !missing_hints.empty()) {
+        request_hint_files(missing_hints);
     }
     
     // 更新序列号
@@ -719,6 +1683,230 @@ void DB::load_index_from_data_files() {
     }
 }
 
+DB::IndexRun DB::scan_data_file(uint32_t fid, DataFile* data_file) {
+    IndexRun run;
+    auto scanner = data_file->new_scanner();
+    ScannedRecord record;
+    while (true) {
+        ScanStatus status = scanner->next(record);
+        if (status == ScanStatus::OK) {
+            if (record.type == LogRecordType::SYNC_MARKER) {
+                continue;
+            }
+            // 解析key，获取序列号
+            auto [real_key, seq_no] = parse_log_record_key(record.key_bytes());
+            run.entries.push_back(IndexRunEntry{std::move(real_key),
+                                                LogRecordPos(fid, record.offset, record.size),
+                                                record.type, seq_no});
+        } else if (status == ScanStatus::CORRUPTED) {
+            // 跳到下一个同步标记继续处理
+            scanner->skip_corrupted();
+        } else {
+            if (status == ScanStatus::TORN_TAIL) {
+                run.torn_tail_bytes = scanner->file_size() - scanner->offset();
+            }
+            break;
+        }
+    }
+    run.end_offset = scanner->offset();
+    run.corrupted_ranges = scanner->corrupted_ranges();
+    run.corrupted_bytes = scanner->corrupted_bytes();
+    return run;
+}
+
+DB::IndexRun DB::load_index_run(uint32_t fid, DataFile* data_file) const {
+    // 活跃文件还会继续写入，总是扫描
+    bool is_active = active_file_ && active_file_.get() == data_file;
+    if (options_.data_file_hints && !is_active) {
+        IndexRun run;
+        if (load_hint_run(options_.dir_path, fid, data_file, run)) {
+            return run;
+        }
+    }
+    return scan_data_file(fid, data_file);
+}
+
+bool DB::load_hint_run(const std::string& dir_path, uint32_t fid, DataFile* data_file, IndexRun& run) {
+    std::string hint_path = DataFile::get_hint_file_name(dir_path, fid);
+    if (!utils::file_exists(hint_path)) {
+        return false;
+    }
+    
+    try {
+        auto scanner = DataFileScanner::open(hint_path);
+        ScannedRecord record;
+        // 任何损坏都放弃整个提示文件
+        while (scanner->next(record) == ScanStatus::OK) {
+            LogRecordPos pos = LogRecordPos::decode(record.value_bytes());
+            
+            if (record.key_size == 0) {
+                // 结束标记：记录的是生成提示文件时数据文件的大小
+                if (pos.fid != fid || pos.offset != data_file->file_size()) {
+                    break;
+                }
+                run.end_offset = pos.offset;
+                run.from_hint = true;
+                return true;
+            }
+            
+            auto [real_key, seq_no] = parse_log_record_key(record.key_bytes());
+            run.entries.push_back(IndexRunEntry{std::move(real_key), pos, record.type, seq_no});
+        }
+    } catch (const std::exception&) {
+        // 没有结束标记或内容损坏，退回扫描数据文件
+    }
+    run.entries.clear();
+    return false;
+}
+
+void DB::write_hint_file(const std::string& dir_path, uint32_t fid, DataFile* data_file) {
+    IndexRun run = scan_data_file(fid, data_file);
+    
+    std::string hint_path = DataFile::get_hint_file_name(dir_path, fid);
+    std::string temp_path = hint_path + ".tmp";
+    std::remove(temp_path.c_str());
+    
+    try {
+        auto hint_file = DataFile::open_file(temp_path);
+        hint_file->enable_write_buffer(64 * 1024);
+        for (const auto& entry : run.entries) {
+            LogRecord hint_record(log_record_key_with_seq(entry.key, entry.seq_no), entry.pos.encode(), entry.type);
+            hint_file->write(hint_record);
+        }
+        // 结束标记的size字段记录整个数据文件的CRC，增量备份用它判断备份中的文件是否相同
+        uint64_t data_size = data_file->file_size();
+        uint32_t data_crc = 0;
+        if (!file_checksum(DataFile::get_data_file_name(dir_path, fid), data_size, data_crc)) {
+            data_crc = 0;
+        }
+        LogRecord end_record(Bytes{}, LogRecordPos(fid, data_size, data_crc).encode(), LogRecordType::NORMAL);
+        hint_file->write(end_record);
+        hint_file->sync();
+        hint_file->close();
+    } catch (...) {
+        std::remove(temp_path.c_str());
+        throw;
+    }
+    utils::move_file(temp_path, hint_path);
+}
+
+void DB::build_hint_file(uint32_t fid) {
+    // 持有共享锁期间文件不会被merge关闭或删除
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto files = data_files();
+    auto it = files->files.find(fid);
+    if (it == files->files.end() || it->second == files->active) {
+        return;
+    }
+    if (utils::file_exists(DataFile::get_hint_file_name(options_.dir_path, fid))) {
+        return;
+    }
+    
+    try {
+        write_hint_file(options_.dir_path, fid, it->second);
+    } catch (const std::exception&) {
+        // 提示文件只用于加速启动，生成失败时下次启动重放数据文件即可
+    }
+}
+
+void DB::request_hint_files(const std::vector<uint32_t>& fids) {
+    {
+        std::lock_guard<std::mutex> bg_lock(bg_mutex_);
+        pending_hints_.insert(pending_hints_.end(), fids.begin(), fids.end());
+    }
+    bg_cv_.notify_one();
+}
+
+void DB::scan_data_files_in_order(const std::vector<std::pair<uint32_t, DataFile*>>& files,
+                                  const std::function<void(uint32_t, IndexRun&)>& apply) {
+    size_t num_threads = std::min<size_t>(options_.recovery_threads, files.size());
+    if (num_threads <= 1) {
+        for (const auto& [fid, data_file] : files) {
+            IndexRun run = load_index_run(fid, data_file);
+            apply(fid, run);
+        }
+        return;
+    }
+    
+    // 扫描领先应用的文件数上限
+    const size_t window = num_threads * 2;
+    std::vector<IndexRun> runs(files.size());
+    std::vector<bool> ready(files.size(), false);
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next = 0;            // 下一个待扫描的文件
+    size_t applied = 0;         // 已应用的文件数
+    std::exception_ptr error;
+    
+    auto worker = [&]() {
+        while (true) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return error || next >= files.size() || next < applied + window; });
+                if (error || next >= files.size()) {
+                    return;
+                }
+                i = next++;
+            }
+            
+            IndexRun run;
+            try {
+                run = load_index_run(files[i].first, files[i].second);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = std::current_exception();
+                cv.notify_all();
+                return;
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                runs[i] = std::move(run);
+                ready[i] = true;
+            }
+            cv.notify_all();
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    
+    // 当前线程按文件顺序应用扫描结果
+    for (size_t i = 0; i < files.size(); ++i) {
+        IndexRun run;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return error || ready[i]; });
+            if (error) {
+                break;
+            }
+            run = std::move(runs[i]);
+            applied = i + 1;
+        }
+        cv.notify_all();
+        
+        try {
+            apply(files[i].first, run);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            cv.notify_all();
+            break;
+        }
+    }
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 void DB::load_index_from_hint_file() {
     std::string hint_file_path = options_.dir_path + "/" + HINT_FILE_NAME;
     if (!utils::file_exists(hint_file_path)) {
@@ -746,21 +1934,19 @@ void DB::load_index_from_hint_file() {
 }
 
 void DB::load_merge_files() {
-    std::string merge_dir = options_.dir_path + "/merge";
+    std::string merge_dir = get_merge_path();
     if (!utils::directory_exists(merge_dir)) {
         return;
     }
     
-    std::string merge_fin_file = merge_dir + "/" + MERGE_FINISHED_FILE_NAME;
-    if (!utils::file_exists(merge_fin_file)) {
-        return;
+    // 有完成标记说明上次merge在安装时中断，重做安装；没有标记的是未完成的merge，直接丢弃
+    std::vector<uint32_t> merged_fids;
+    std::vector<uint32_t> output_fids;
+    if (read_merge_finished_file(merge_dir, merged_fids, output_fids)) {
+        move_merge_files(options_.dir_path, merge_dir, merged_fids, output_fids);
+        utils::sync_dir(options_.dir_path);
     }
     
-    // 获取合并目录中的数据文件并移动到主目录
-    // 简化实现：使用utils::copy_directory移动文件
-    std::vector<std::string> exclude_files = {MERGE_FINISHED_FILE_NAME};
-    utils::copy_directory(merge_dir, options_.dir_path, exclude_files);
-    
     // 删除合并目录
     utils::remove_directory(merge_dir);
 }
@@ -774,6 +1960,7 @@ void DB::acquire_file_lock() {
     
     if (flock(file_lock_fd_, LOCK_EX | LOCK_NB) == -1) {
         ::close(file_lock_fd_);
+        file_lock_fd_ = -1;
         throw DatabaseIsUsingError();
     }
 }
@@ -808,87 +1995,184 @@ void DB::load_seq_no() {
 
 void DB::reset_io_type() {
     if (active_file_) {
-        active_file_->set_io_manager(options_.dir_path, IOType::STANDARD_FIO);
+        active_file_->set_io_manager(options_.dir_path, options_.io_type);
     }
     
     for (auto& pair : older_files_) {
-        pair.second->set_io_manager(options_.dir_path, IOType::STANDARD_FIO);
+        pair.second->set_io_manager(options_.dir_path, options_.io_type);
     }
 }
 
 std::pair<Bytes, uint64_t> DB::parse_log_record_key(const Bytes& key) {
-    if (key.size() < 8) {
-        return {key, NON_TRANSACTION_SEQ_NO};
-    }
-    
-    // 检查最后8个字节是否为序列号
-    uint64_t seq_no = 0;
-    for (int i = 0; i < 8; ++i) {
-        seq_no |= (static_cast<uint64_t>(key[key.size() - 8 + i]) << (i * 8));
-    }
-    
-    if (seq_no == NON_TRANSACTION_SEQ_NO) {
-        return {key, NON_TRANSACTION_SEQ_NO};
-    }
-    
-    Bytes real_key(key.begin(), key.end() - 8);
-    return {real_key, seq_no};
+    // 序列号在key前面，用varint编码，后面剩下的是用户key
+    auto [seq_no, len] = decode_varint(key.data(), key.size());
+    return {Bytes(key.begin() + len, key.end()), seq_no};
 }
 
 Bytes DB::log_record_key_with_seq(const Bytes& key, uint64_t seq_no) {
-    if (seq_no == NON_TRANSACTION_SEQ_NO) {
-        return key;
-    }
-    
-    Bytes result = key;
-    result.reserve(key.size() + 8);
-    
-    // 添加序列号（小端序）
-    for (int i = 0; i < 8; ++i) {
-        result.push_back(static_cast<uint8_t>((seq_no >> (i * 8)) & 0xFF));
-    }
-    
+    // 所有记录都带序列号前缀（非事务记录是一个字节0），解析时不会把用户key的末尾当成序列号
+    uint8_t buffer[10];
+    size_t len = encode_varint(seq_no, buffer);
+    
+    Bytes result;
+    result.reserve(len + key.size());
+    result.insert(result.end(), buffer, buffer + len);
+    result.insert(result.end(), key.begin(), key.end());
     return result;
 }
 
-// Merge功能实现
-void DB::merge() {
-    // 如果数据库为空，直接返回
-    if (!active_file_ || active_file_->get_write_off() == 0) {
-        if (older_files_.empty()) {
-            return;
+// merge输出文件的写入器：依次使用被合并文件的ID写出新文件，写满一个换下一个，
+// ID用完后继续写最后一个；与活跃文件一样按间隔写入同步标记
+class DB::MergeWriter {
+public:
+    MergeWriter(const DB& db, const std::string& dir_path, const std::vector<uint32_t>& file_ids)
+        : db_(db), dir_path_(dir_path), file_ids_(file_ids), next_(0), written_bytes_(0) {}
+
+    LogRecordPos write(const LogRecord& record) {
+        size_t size = record.encoded_size();
+        if (!file_) {
+            open_next_file();
+        }
+        size_t marker_size = db_.sync_marker_size(file_->get_write_off(), size);
+        if (file_->get_write_off() + marker_size + size > db_.options_.data_file_size &&
+            next_ < file_ids_.size()) {
+            file_->sync();
+            file_->close();
+            open_next_file();
+            marker_size = db_.sync_marker_size(file_->get_write_off(), size);
+        }
+        
+        if (marker_size > 0) {
+            file_->write(sync_marker_record());
         }
+        uint64_t write_off = file_->get_write_off();
+        file_->write(record);
+        written_bytes_ += marker_size + size;
+        return LogRecordPos(file_->get_file_id(), write_off, static_cast<uint32_t>(size));
     }
 
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    
-    // 使用原子操作检查并设置合并标志
-    bool expected = false;
-    if (!is_merging_.compare_exchange_strong(expected, true)) {
-        throw MergeInProgressError();
+    // 同步并关闭最后一个文件
+    void finish() {
+        if (file_) {
+            file_->sync();
+            file_->close();
+            file_.reset();
+        }
     }
 
-    // 检查是否达到merge阈值
-    if (!should_merge()) {
-        is_merging_.store(false);  // 重置标志
-        throw MergeRatioUnreachedError();
+    // 实际写出的文件ID
+    const std::vector<uint32_t>& output_file_ids() const { return output_file_ids_; }
+
+    uint64_t written_bytes() const { return written_bytes_; }
+
+private:
+    void open_next_file() {
+        uint32_t file_id = file_ids_[next_++];
+        file_ = DataFile::open_data_file(dir_path_, file_id, IOType::STANDARD_FIO);
+        if (db_.io_limiter_) {
+            file_->set_rate_limiter(db_.io_limiter_);
+        }
+        file_->enable_write_buffer(MERGE_WRITE_BUFFER_SIZE);
+        output_file_ids_.push_back(file_id);
     }
 
-    // 检查磁盘空间是否足够（为测试环境放宽限制）
-    uint64_t available_size = utils::available_disk_size();
+    const DB& db_;
+    std::string dir_path_;
+    std::vector<uint32_t> file_ids_;
+    size_t next_;
+    std::unique_ptr<DataFile> file_;
+    std::vector<uint32_t> output_file_ids_;
+    uint64_t written_bytes_;
+};
+
+// Merge功能实现：先把活跃文件转为旧文件，从旧文件中选出失效比例达到阈值的文件，
+// 之后的读写照常进行（写入进入新的活跃文件），只有最后安装结果时独占mutex_
+void DB::merge() {
+    // 选中的旧文件按是否相邻分段：记录只能挪到同一段内更小的文件ID中，
+    // 跨过未合并的文件会打乱重放时的先后顺序
+    struct MergeRun {
+        std::vector<std::pair<uint32_t, DataFile*>> files;
+        bool is_prefix = false;     // 段之前没有其他旧文件，删除记录和事务完成标记可以丢弃
+    };
+    std::vector<MergeRun> merge_runs;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::lock_guard<std::mutex> append_lock(append_mutex_);
+        
+        // 如果数据库为空，直接返回
+        if ((!active_file_ || active_file_->get_write_off() == 0) && older_files_.empty()) {
+            return;
+        }
+        
+        // 使用原子操作检查并设置合并标志
+        bool expected = false;
+        if (!is_merging_.compare_exchange_strong(expected, true)) {
+            throw MergeInProgressError();
+        }
+        
+        // 检查是否达到merge阈值
+        if (!should_merge()) {
+            is_merging_.store(false);  // 重置标志
+            throw MergeRatioUnreachedError();
+        }
+        
+        // 检查磁盘空间是否足够（为测试环境放宽限制）
+        uint64_t available_size = utils::available_disk_size();
+        
+        // 为测试环境大幅放宽空间检查：只有在可用空间极少时才抛异常
+        if (available_size < 100 * 1024 * 1024) {  // 少于100MB才拒绝
+            is_merging_.store(false);  // 重置标志
+            throw NoEnoughSpaceForMergeError();
+        }
+        
+        try {
+            // 活跃文件转为旧文件，merge期间的写入进入新的活跃文件
+            if (active_file_ && active_file_->get_write_off() > 0) {
+                rotate_active_data_file();
+            }
+            
+            std::vector<std::pair<uint32_t, DataFile*>> sealed_files;
+            for (const auto& [fid, file] : older_files_) {
+                sealed_files.emplace_back(fid, file.get());
+            }
+            std::sort(sealed_files.begin(), sealed_files.end());
+            
+            // 只选失效比例达到阈值的文件，没有失效数据的文件不需要重写
+            std::lock_guard<std::mutex> dead_lock(dead_bytes_mutex_);
+            bool prev_selected = false;
+            bool all_selected = true;
+            for (const auto& [fid, file] : sealed_files) {
+                auto it = dead_bytes_.find(fid);
+                uint64_t dead_bytes = it == dead_bytes_.end() ? 0 : it->second;
+                bool selected = dead_bytes > 0 &&
+                    static_cast<double>(dead_bytes) >=
+                        static_cast<double>(options_.merge_file_garbage_ratio) * static_cast<double>(file->file_size());
+                if (selected) {
+                    if (!prev_selected) {
+                        merge_runs.emplace_back();
+                        merge_runs.back().is_prefix = all_selected;
+                    }
+                    merge_runs.back().files.emplace_back(fid, file);
+                } else {
+                    all_selected = false;
+                }
+                prev_selected = selected;
+            }
+        } catch (...) {
+            is_merging_.store(false);
+            throw;
+        }
+    }
     
-    // 为测试环境大幅放宽空间检查：只有在可用空间极少时才抛异常
-    if (available_size < 100 * 1024 * 1024) {  // 少于100MB才拒绝
-        is_merging_.store(false);  // 重置标志
-        throw NoEnoughSpaceForMergeError();
+    if (merge_runs.empty()) {
+        is_merging_.store(false);
+        return;
     }
     
     try {
-        // 持久化当前活跃文件
-        if (active_file_) {
-            active_file_->sync();
-        }
-
+        // 旋转出的文件交给后台同步，这里等它落盘
+        sync_sealed_files();
+        
         // 获取merge路径
         std::string merge_path = get_merge_path();
         
@@ -899,205 +2183,177 @@ void DB::merge() {
         
         // 创建merge目录
         utils::create_directory(merge_path);
-
-        // 旋转文件，获取需要merge的文件列表
-        auto merge_files = rotate_merge_files();
         
-        // 创建临时的merge数据库实例
-        Options merge_options = options_;
-        merge_options.dir_path = merge_path;
-        merge_options.sync_writes = false;
-        auto merge_db = DB::open(merge_options);
-
-        // 打开hint文件
-        auto hint_file = DataFile::open_hint_file(merge_path);
-
-        // 首先，构建一个当前有效记录的映射表
-        // 定义自定义哈希函数
-        struct VectorHash {
-            std::size_t operator()(const std::vector<uint8_t>& v) const {
-                std::size_t seed = v.size();
-                for (auto& i : v) {
-                    seed ^= i + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        // 重写有效记录：持有共享锁期间快照中的文件不会被关闭
+        std::vector<uint32_t> merged_fids;
+        std::vector<uint32_t> output_fids;
+        std::vector<MergedRecord> records;
+        std::vector<LogRecordPos> dead_positions;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            RateLimiter::ActiveScope io_scope(io_limiter_.get());
+            ScannerOptions scan_options;
+            scan_options.rate_limiter = io_limiter_.get();
+            for (const auto& run : merge_runs) {
+                std::vector<uint32_t> run_fids;
+                for (const auto& [fid, data_file] : run.files) {
+                    run_fids.push_back(fid);
                 }
-                return seed;
-            }
-        };
-        
-        std::unordered_map<std::vector<uint8_t>, LogRecordPos, VectorHash> valid_records;
-        auto keys = index_->list_keys();
-        for (const auto& key : keys) {
-            auto pos = index_->get(key);
-            if (pos) {
-                std::vector<uint8_t> key_vec(key.begin(), key.end());
-                valid_records[key_vec] = *pos;
-            }
-        }
-
-        // 处理每个数据文件
-        for (auto& data_file : merge_files) {
-            uint64_t offset = 0;
-            while (true) {
-                try {
-                    auto read_result = data_file->read_log_record(offset);
-                    auto& log_record = read_result.record;
-                    auto size = read_result.size;
-
-                    // 解析实际的key
-                    auto [real_key, seq_no] = parse_log_record_key(log_record.key);
-                    
-                    // 检查该记录是否是当前有效的记录
-                    std::vector<uint8_t> key_vec(real_key.begin(), real_key.end());
-                    auto it = valid_records.find(key_vec);
-                    if (it != valid_records.end() && 
-                        it->second.fid == data_file->get_file_id() && 
-                        it->second.offset == offset) {
-                        // 只处理非删除记录
-                        if (log_record.type != LogRecordType::DELETED) {
-                            // 清除事务标记
-                            log_record.key = log_record_key_with_seq(real_key, NON_TRANSACTION_SEQ_NO);
-                            
-                            // 写入merge数据库
-                            auto new_pos = merge_db->append_log_record_internal(log_record);
-                            
-                            // 写入hint文件
-                            hint_file->write_hint_record(real_key, new_pos);
+                merged_fids.insert(merged_fids.end(), run_fids.begin(), run_fids.end());
+                
+                MergeWriter writer(*this, merge_path, run_fids);
+                for (const auto& [fid, data_file] : run.files) {
+                    auto scanner = data_file->new_scanner(scan_options);
+                    ScannedRecord record;
+                    while (true) {
+                        ScanStatus status = scanner->next(record);
+                        if (status == ScanStatus::CORRUPTED) {
+                            // 跳过损坏的记录
+                            scanner->skip_corrupted();
+                            continue;
+                        }
+                        if (status != ScanStatus::OK) {
+                            break;
+                        }
+                        
+                        // 同步标记由写入器重新写入
+                        if (record.type == LogRecordType::SYNC_MARKER) {
+                            continue;
                         }
+                        
+                        // 事务的记录可能在前面未合并的文件中，完成标记要原样保留
+                        if (record.type == LogRecordType::TXN_FINISHED) {
+                            if (!run.is_prefix) {
+                                writer.write(LogRecord(record.key_bytes(), record.value_bytes(), record.type));
+                            }
+                            continue;
+                        }
+                        
+                        // 解析实际的key
+                        auto [real_key, seq_no] = parse_log_record_key(record.key_bytes());
+                        
+                        // 删除记录要覆盖前面未合并的文件中的旧值，之后又写入过的key不再需要
+                        if (record.type == LogRecordType::DELETED) {
+                            if (!run.is_prefix && !index_->get(real_key)) {
+                                dead_positions.push_back(writer.write(
+                                    LogRecord(log_record_key_with_seq(real_key, NON_TRANSACTION_SEQ_NO), Bytes(), record.type)));
+                            }
+                            continue;
+                        }
+                        
+                        // 只保留索引当前指向的记录
+                        auto pos = index_->get(real_key);
+                        if (!pos || pos->fid != fid || pos->offset != record.offset) {
+                            continue;
+                        }
+                        
+                        // 清除事务标记后写入合并结果
+                        LogRecord log_record(log_record_key_with_seq(real_key, NON_TRANSACTION_SEQ_NO),
+                                             record.value_bytes(), record.type);
+                        LogRecordPos new_pos = writer.write(log_record);
+                        records.push_back({std::move(real_key), *pos, new_pos});
                     }
-
-                    offset += size;
-                } catch (const ReadDataFileEOFError&) {
-                    break;
-                } catch (const InvalidCRCError&) {
-                    // 跳过损坏的记录
-                    offset += 1;
-                    continue;
-                } catch (const std::exception&) {
-                    // 跳过其他错误的记录
-                    offset += 1;
-                    continue;
                 }
+                writer.finish();
+                output_fids.insert(output_fids.end(), writer.output_file_ids().begin(),
+                                   writer.output_file_ids().end());
             }
         }
-
-        // 同步数据
-        merge_db->sync();
-        hint_file->sync();
-
-        // 写入merge完成标记文件
-        auto merge_finished_file = DataFile::open_merge_finished_file(merge_path);
-        uint32_t non_merge_file_id = merge_files.empty() ? 0 : merge_files.back()->get_file_id() + 1;
-        
-        LogRecord merge_finished_record;
-        merge_finished_record.key = Bytes(MERGE_FINISHED_KEY.begin(), MERGE_FINISHED_KEY.end());
-        std::string non_merge_file_id_str = std::to_string(non_merge_file_id);
-        merge_finished_record.value = Bytes(non_merge_file_id_str.begin(), non_merge_file_id_str.end());
-        merge_finished_record.type = LogRecordType::NORMAL;
-
-        auto encoded_record = merge_finished_record.encode();
-        merge_finished_file->write(encoded_record.first);
-        merge_finished_file->sync();
-
-        // 关闭合并数据库和文件
-        merge_db->close();
-        hint_file->close();
-        merge_finished_file->close();
         
-        // 保存当前序列号，因为稍后会重新加载
-        uint64_t current_seq = seq_no_.load();
+        // 合并结果已经落盘，写入完成标记后即使安装中途崩溃，启动时也能重做
+        write_merge_finished_file(merge_path, merged_fids, output_fids);
         
-        // 关闭当前所有文件句柄
-        for (const auto& [fid, file] : older_files_) {
-            file->close();
-        }
-        older_files_.clear();
-        if (active_file_) {
-            active_file_->close();
-            active_file_.reset();
-        }
-        
-        // 先删除主目录中的旧数据文件
-        for (uint32_t fid : file_ids_) {
-            std::string main_file_path = DataFile::get_data_file_name(options_.dir_path, fid);
-            if (utils::file_exists(main_file_path)) {
-                std::remove(main_file_path.c_str());
-            }
-        }
-        
-        // 手动复制合并后的文件到主目录
-        std::vector<uint32_t> merge_file_ids;
-        for (uint32_t fid = 0; fid < 10000; ++fid) {
-            std::string merge_file_path = DataFile::get_data_file_name(merge_path, fid);
-            if (utils::file_exists(merge_file_path)) {
-                merge_file_ids.push_back(fid);
-                
-                // 复制到主目录
-                std::string main_file_path = DataFile::get_data_file_name(options_.dir_path, fid);
-                utils::copy_file(merge_file_path, main_file_path);
-            } else if (!merge_file_ids.empty()) {
-                break;  // 没有更多文件了
-            }
-        }
-        
-        // 复制hint文件（如果存在）
-        std::string merge_hint = merge_path + "/" + HINT_FILE_NAME;
-        std::string main_hint = options_.dir_path + "/" + HINT_FILE_NAME;
-        if (utils::file_exists(merge_hint)) {
-            utils::copy_file(merge_hint, main_hint);
+        // 安装合并结果，这一步独占
+        std::vector<std::unique_ptr<DataFile>> retired_files;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            retired_files = install_merge_files(merged_fids, output_fids, merge_path, records, dead_positions);
         }
         
-        // 复制merge完成标记文件
-        std::string merge_fin_src = merge_path + "/" + MERGE_FINISHED_FILE_NAME;
-        std::string merge_fin_dst = options_.dir_path + "/" + MERGE_FINISHED_FILE_NAME;
-        if (utils::file_exists(merge_fin_src)) {
-            utils::copy_file(merge_fin_src, merge_fin_dst);
+        // 旧文件在锁外关闭，释放磁盘空间的开销不计入独占时间
+        for (auto& data_file : retired_files) {
+            data_file->close();
         }
+        retired_files.clear();
         
-        // 重置状态并重新加载
-        reclaim_size_.store(0);
-        
-        // 清空文件ID列表，强制重新扫描
-        file_ids_.clear();
-        
-        // 重新加载数据文件
-        load_data_files();
-        
-        // 重新构建索引以确保数据一致性
-        if (index_) {
-            try {
-                // 重建索引
-                index_->close();
-                index_ = create_indexer(options_.index_type, options_.dir_path, options_.sync_writes);
-                
-                // 加载hint文件索引（如果存在）
-                load_index_from_hint_file();
-                
-                // 总是从数据文件加载索引以确保数据一致性
-                load_index_from_data_files();
-                
-                // 恢复序列号
-                seq_no_.store(current_seq);
-                
-            } catch (const std::exception& e) {
-                // 如果索引重建失败，保持原状
-            }
-        }
-        
-        // merge完成后，可回收空间应该大幅减少
-        // 重新计算可回收空间（应该接近0，因为merge清理了无效数据）
-        reclaim_size_.store(0);
-        
-        // 清理合并目录
+        // 改名落盘后才能删除合并目录（连同完成标记），目录同步不占用独占锁
+        utils::sync_dir(options_.dir_path);
         utils::remove_directory(merge_path);
-
+        
     } catch (...) {
         is_merging_.store(false);
         throw;
     }
-
+    
     is_merging_.store(false);
 }
 
+std::vector<std::unique_ptr<DataFile>> DB::install_merge_files(const std::vector<uint32_t>& merged_fids,
+                                                               const std::vector<uint32_t>& output_fids,
+                                                               const std::string& merge_path,
+                                                               const std::vector<MergedRecord>& records,
+                                                               const std::vector<LogRecordPos>& dead_positions) {
+    // 被合并的文件从文件表中移除，交给调用者在锁外关闭
+    std::vector<std::unique_ptr<DataFile>> retired_files;
+    for (uint32_t fid : merged_fids) {
+        auto it = older_files_.find(fid);
+        if (it != older_files_.end()) {
+            retired_files.push_back(std::move(it->second));
+            older_files_.erase(it);
+        }
+        file_ids_.erase(std::remove(file_ids_.begin(), file_ids_.end(), fid), file_ids_.end());
+    }
+    
+    // 合并结果改名到主目录，不复制数据
+    move_merge_files(options_.dir_path, merge_path, merged_fids, output_fids);
+    
+    // 作为封存的旧文件打开
+    for (uint32_t fid : output_fids) {
+        auto data_file = DataFile::open_data_file(options_.dir_path, fid, options_.io_type);
+        data_file->seal(options_.mmap_sealed_files);
+        older_files_[fid] = std::move(data_file);
+        file_ids_.push_back(fid);
+    }
+    std::sort(file_ids_.begin(), file_ids_.end());
+    publish_data_files();
+    
+    // 文件ID和偏移被合并后的文件复用，缓存中的旧值随之失效
+    file_epoch_.fetch_add(1);
+    
+    // merge期间被前台改写或删除的key已经指向别处，只替换仍指向旧位置的，
+    // 没有替换的记录在合并结果中已经失效
+    std::vector<LogRecordPos> stale_positions = dead_positions;
+    for (const auto& record : records) {
+        auto pos = index_->get(record.key);
+        if (pos && pos->fid == record.old_pos.fid && pos->offset == record.old_pos.offset) {
+            index_->put(record.key, record.new_pos);
+        } else {
+            stale_positions.push_back(record.new_pos);
+        }
+    }
+    
+    // 被合并文件的失效字节数换成合并结果中的，可回收空间随之重新汇总
+    {
+        std::lock_guard<std::mutex> dead_lock(dead_bytes_mutex_);
+        for (uint32_t fid : merged_fids) {
+            dead_bytes_.erase(fid);
+        }
+        for (const auto& pos : stale_positions) {
+            dead_bytes_[pos.fid] += pos.size;
+        }
+        int64_t reclaim_size = 0;
+        for (const auto& [fid, dead_bytes] : dead_bytes_) {
+            reclaim_size += static_cast<int64_t>(dead_bytes);
+        }
+        reclaim_size_.store(reclaim_size);
+    }
+    
+    if (options_.background_file_rotation && options_.data_file_hints) {
+        request_hint_files(output_fids);
+    }
+    return retired_files;
+}
+
 std::string DB::get_merge_path() const {
     std::string dir_path_str = options_.dir_path;
     
@@ -1124,44 +2380,92 @@ bool DB::should_merge() const {
     return ratio >= options_.data_file_merge_ratio;
 }
 
-std::vector<std::unique_ptr<DataFile>> DB::rotate_merge_files() {
-    std::vector<std::unique_ptr<DataFile>> merge_files;
-    
-    // 获取所有旧文件的ID
-    std::vector<uint32_t> merge_file_ids;
-    for (const auto& [file_id, file] : older_files_) {
-        merge_file_ids.push_back(file_id);
-    }
+void DB::write_merge_finished_file(const std::string& merge_path,
+                                   const std::vector<uint32_t>& merged_fids,
+                                   const std::vector<uint32_t>& output_fids) {
+    // 值的格式为"被合并的文件ID;合并结果的文件ID"，ID之间用逗号分隔
+    std::ostringstream value;
+    for (size_t i = 0; i < merged_fids.size(); ++i) {
+        value << (i > 0 ? "," : "") << merged_fids[i];
+    }
+    value << ";";
+    for (size_t i = 0; i < output_fids.size(); ++i) {
+        value << (i > 0 ? "," : "") << output_fids[i];
+    }
+    std::string value_str = value.str();
+    
+    LogRecord merge_finished_record;
+    merge_finished_record.key = Bytes(MERGE_FINISHED_KEY.begin(), MERGE_FINISHED_KEY.end());
+    merge_finished_record.value = Bytes(value_str.begin(), value_str.end());
+    merge_finished_record.type = LogRecordType::NORMAL;
+    
+    auto merge_finished_file = DataFile::open_merge_finished_file(merge_path);
+    merge_finished_file->write(merge_finished_record.encode().first);
+    merge_finished_file->sync();
+    merge_finished_file->close();
+    utils::sync_dir(merge_path);
+}
 
-    // 如果有活跃文件，将其转为旧文件
-    if (active_file_) {
-        uint32_t active_file_id = active_file_->get_file_id();
-        older_files_[active_file_id] = std::move(active_file_);
-        merge_file_ids.push_back(active_file_id);
-        
-        // 创建新的活跃文件
-        set_active_data_file();
+bool DB::read_merge_finished_file(const std::string& merge_path,
+                                  std::vector<uint32_t>& merged_fids,
+                                  std::vector<uint32_t>& output_fids) {
+    if (!utils::file_exists(merge_path + "/" + MERGE_FINISHED_FILE_NAME)) {
+        return false;
     }
-
-    // 排序文件ID
-    std::sort(merge_file_ids.begin(), merge_file_ids.end());
-
-    // 创建merge文件列表
-    for (uint32_t file_id : merge_file_ids) {
-        merge_files.push_back(
-            DataFile::open_data_file(options_.dir_path, file_id, IOType::STANDARD_FIO)
-        );
+    
+    try {
+        auto merge_finished_file = DataFile::open_merge_finished_file(merge_path);
+        auto read_result = merge_finished_file->read_log_record(0);
+        merge_finished_file->close();
+        
+        std::string value_str(read_result.record.value.begin(), read_result.record.value.end());
+        size_t sep = value_str.find(';');
+        if (sep == std::string::npos) {
+            return false;
+        }
+        auto parse_ids = [](const std::string& str, std::vector<uint32_t>& ids) {
+            std::istringstream stream(str);
+            std::string id;
+            while (std::getline(stream, id, ',')) {
+                ids.push_back(static_cast<uint32_t>(std::stoul(id)));
+            }
+        };
+        parse_ids(value_str.substr(0, sep), merged_fids);
+        parse_ids(value_str.substr(sep + 1), output_fids);
+    } catch (const std::exception&) {
+        // 标记不完整说明崩溃发生在写标记时，安装还没开始
+        merged_fids.clear();
+        output_fids.clear();
+        return false;
     }
-
-    return merge_files;
+    return true;
 }
 
-uint32_t DB::get_non_merge_file_id(const std::string& dir_path) const {
-    auto merge_finished_file = DataFile::open_merge_finished_file(dir_path);
-    auto read_result = merge_finished_file->read_log_record(0);
+void DB::move_merge_files(const std::string& dir_path, const std::string& merge_path,
+                          const std::vector<uint32_t>& merged_fids,
+                          const std::vector<uint32_t>& output_fids) {
+    // 先删除提示文件，之后任何时刻崩溃都不会留下与新数据文件不对应的提示文件
+    for (uint32_t fid : merged_fids) {
+        std::remove(DataFile::get_hint_file_name(dir_path, fid).c_str());
+    }
+    // 旧版本merge留下的全局hint文件指向的位置已经失效
+    std::remove((dir_path + "/" + HINT_FILE_NAME).c_str());
+    std::remove((dir_path + "/" + MERGE_FINISHED_FILE_NAME).c_str());
+    
+    // 合并结果沿用被合并文件的ID，改名时原子地替换同名的旧文件；已经改过名的跳过
+    for (uint32_t fid : output_fids) {
+        std::string merge_file_path = DataFile::get_data_file_name(merge_path, fid);
+        if (utils::file_exists(merge_file_path)) {
+            utils::move_file(merge_file_path, DataFile::get_data_file_name(dir_path, fid));
+        }
+    }
     
-    std::string value_str(read_result.record.value.begin(), read_result.record.value.end());
-    return static_cast<uint32_t>(std::stoul(value_str));
+    // 没有被合并结果替换的旧文件直接删除
+    for (uint32_t fid : merged_fids) {
+        if (std::find(output_fids.begin(), output_fids.end(), fid) == output_fids.end()) {
+            std::remove(DataFile::get_data_file_name(dir_path, fid).c_str());
+        }
+    }
 }
 
 void DB::check_options(const Options& options) {
@@ -1176,6 +2480,7 @@ void DB::check_options(const Options& options) {
     if (options.data_file_merge_ratio < 0 || options.data_file_merge_ratio > 1) {
         throw BitcaskException("Invalid merge ratio, must be between 0 and 1");
     }
+
 }
 
 }  // namespace bitcask
@@ -0,0 +1,373 @@
+#include "bitcask/direct_io.h"
+#include "bitcask/utils.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+namespace bitcask {
+
+namespace {
+
+// 共享块缓存容量：2048块，即8MB
+const size_t SHARED_CACHE_BLOCKS = 2048;
+
+// 超过这个块数的读取不经过块缓存，避免大范围顺序读冲掉热点块
+const size_t CACHE_BYPASS_BLOCKS = 16;
+
+const uint64_t INVALID_BLOCK = UINT64_MAX;
+
+std::atomic<uint64_t> next_file_key{1};
+
+// 循环pread直到读满或到达文件末尾
+ssize_t pread_full(int fd, uint8_t* buf, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, buf + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+// 循环pwrite直到全部写入
+ssize_t pwrite_full(int fd, const uint8_t* buf, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pwrite(fd, buf + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+}  // namespace
+
+// DirectIOBlockCache 实现
+DirectIOBlockCache& DirectIOBlockCache::shared() {
+    static DirectIOBlockCache cache(SHARED_CACHE_BLOCKS);
+    return cache;
+}
+
+DirectIOBlockCache::DirectIOBlockCache(size_t capacity_blocks)
+    : capacity_(capacity_blocks), hits_(0), misses_(0) {
+}
+
+bool DirectIOBlockCache::get(uint64_t file_key, uint64_t block, uint8_t* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(BlockKey{file_key, block});
+    if (it == blocks_.end()) {
+        misses_++;
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    std::memcpy(out, it->second->second.data(), DIRECT_IO_BLOCK_SIZE);
+    hits_++;
+    return true;
+}
+
+void DirectIOBlockCache::put(uint64_t file_key, uint64_t block, const uint8_t* data) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    BlockKey key{file_key, block};
+    auto it = blocks_.find(key);
+    if (it != blocks_.end()) {
+        std::memcpy(it->second->second.data(), data, DIRECT_IO_BLOCK_SIZE);
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    if (blocks_.size() >= capacity_) {
+        // 淘汰最久未使用的块，复用它的内存
+        auto last = std::prev(lru_.end());
+        blocks_.erase(last->first);
+        last->first = key;
+        std::memcpy(last->second.data(), data, DIRECT_IO_BLOCK_SIZE);
+        lru_.splice(lru_.begin(), lru_, last);
+    } else {
+        lru_.emplace_front(key, Bytes(data, data + DIRECT_IO_BLOCK_SIZE));
+    }
+    blocks_[key] = lru_.begin();
+}
+
+void DirectIOBlockCache::erase(uint64_t file_key, uint64_t block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(BlockKey{file_key, block});
+    if (it != blocks_.end()) {
+        lru_.erase(it->second);
+        blocks_.erase(it);
+    }
+}
+
+uint64_t DirectIOBlockCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t DirectIOBlockCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+// DirectIOManager 实现
+DirectIOManager::DirectIOManager(const std::string& file_path)
+    : file_path_(file_path), fd_(-1), is_open_(false), direct_(true),
+      file_key_(next_file_key.fetch_add(1)), size_(0), tail_block_(INVALID_BLOCK) {
+
+    // 确保目录存在
+    std::string dir = utils::dir_name(file_path);
+    if (!dir.empty() && !utils::dir_exists(dir)) {
+        utils::create_dir(dir);
+    }
+
+    fd_ = ::open(file_path.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (fd_ == -1 && errno == EINVAL) {
+        // 文件系统不支持O_DIRECT（如tmpfs），退回普通IO
+        direct_ = false;
+        fd_ = ::open(file_path.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+    if (fd_ == -1) {
+        throw BitcaskException("Failed to open file: " + file_path +
+                             ", error: " + std::string(std::strerror(errno)));
+    }
+    is_open_ = true;
+
+    struct stat st;
+    if (fstat(fd_, &st) == 0) {
+        size_ = static_cast<uint64_t>(st.st_size);
+    }
+    tail_ = alloc_aligned(DIRECT_IO_BLOCK_SIZE);
+}
+
+DirectIOManager::~DirectIOManager() {
+    if (is_open_) {
+        close();
+    }
+}
+
+DirectIOManager::AlignedBuffer DirectIOManager::alloc_aligned(size_t size) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, DIRECT_IO_BLOCK_SIZE, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return AlignedBuffer(static_cast<uint8_t*>(ptr));
+}
+
+bool DirectIOManager::read_blocks_locked(uint64_t first_block, size_t count, uint8_t* out, bool use_cache) {
+    const size_t B = DIRECT_IO_BLOCK_SIZE;
+
+    if (!use_cache) {
+        ssize_t n = pread_full(fd_, out, count * B, static_cast<off_t>(first_block * B));
+        if (n < 0) {
+            return false;
+        }
+        std::memset(out + n, 0, count * B - static_cast<size_t>(n));
+        if (tail_block_ >= first_block && tail_block_ < first_block + count) {
+            std::memcpy(out + (tail_block_ - first_block) * B, tail_.get(), B);
+        }
+        return true;
+    }
+
+    auto& cache = DirectIOBlockCache::shared();
+    size_t i = 0;
+    while (i < count) {
+        uint64_t block = first_block + i;
+        uint8_t* dst = out + i * B;
+        if (block == tail_block_) {
+            std::memcpy(dst, tail_.get(), B);
+            i++;
+            continue;
+        }
+        if (cache.get(file_key_, block, dst)) {
+            i++;
+            continue;
+        }
+
+        // 连续未命中的块合并成一次读取
+        size_t run = 1;
+        while (i + run < count && first_block + i + run != tail_block_ && run < CACHE_BYPASS_BLOCKS) {
+            run++;
+        }
+        ssize_t n = pread_full(fd_, dst, run * B, static_cast<off_t>(block * B));
+        if (n < 0) {
+            return false;
+        }
+        std::memset(dst + n, 0, run * B - static_cast<size_t>(n));
+        for (size_t j = 0; j < run; ++j) {
+            cache.put(file_key_, block + j, dst + j * B);
+        }
+        i += run;
+    }
+    return true;
+}
+
+ssize_t DirectIOManager::read(void* buf, size_t size, off_t offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open_) {
+        errno = EBADF;
+        return -1;
+    }
+
+    uint64_t off = static_cast<uint64_t>(offset);
+    if (off >= size_ || size == 0) {
+        return 0;
+    }
+    size = static_cast<size_t>(std::min<uint64_t>(size, size_ - off));
+
+    const size_t B = DIRECT_IO_BLOCK_SIZE;
+    uint64_t first_block = off / B;
+    uint64_t end_block = (off + size + B - 1) / B;
+    size_t count = static_cast<size_t>(end_block - first_block);
+
+    AlignedBuffer aligned = alloc_aligned(count * B);
+    if (!read_blocks_locked(first_block, count, aligned.get(), count <= CACHE_BYPASS_BLOCKS)) {
+        return -1;
+    }
+    std::memcpy(buf, aligned.get() + (off - first_block * B), size);
+    return static_cast<ssize_t>(size);
+}
+
+ssize_t DirectIOManager::write(const void* buf, size_t size, off_t offset) {
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(buf);
+    iov.iov_len = size;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_locked(&iov, 1, offset);
+}
+
+ssize_t DirectIOManager::writev(const struct iovec* iov, int iovcnt, off_t offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_locked(iov, iovcnt, offset);
+}
+
+ssize_t DirectIOManager::write_locked(const struct iovec* iov, int iovcnt, off_t offset) {
+    if (!is_open_) {
+        errno = EBADF;
+        return -1;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const size_t B = DIRECT_IO_BLOCK_SIZE;
+    uint64_t off = static_cast<uint64_t>(offset);
+    uint64_t end = off + total;
+    uint64_t first_block = off / B;
+    uint64_t end_block = (end + B - 1) / B;
+    size_t count = static_cast<size_t>(end_block - first_block);
+
+    AlignedBuffer aligned = alloc_aligned(count * B);
+    std::memset(aligned.get(), 0, count * B);
+
+    // 首尾不满一块时先取回原有内容；追加写的尾块直接来自内存
+    auto load_block = [this](uint64_t block, uint8_t* dst) {
+        if (block == tail_block_) {
+            std::memcpy(dst, tail_.get(), DIRECT_IO_BLOCK_SIZE);
+            return true;
+        }
+        if (block * DIRECT_IO_BLOCK_SIZE >= size_) {
+            return true;
+        }
+        return read_blocks_locked(block, 1, dst, true);
+    };
+    if (off % B != 0 && !load_block(first_block, aligned.get())) {
+        return -1;
+    }
+    if (end % B != 0 && (count > 1 || off % B == 0) &&
+        !load_block(end_block - 1, aligned.get() + (count - 1) * B)) {
+        return -1;
+    }
+
+    uint8_t* dst = aligned.get() + (off - first_block * B);
+    for (int i = 0; i < iovcnt; ++i) {
+        std::memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+        dst += iov[i].iov_len;
+    }
+
+    if (pwrite_full(fd_, aligned.get(), count * B, static_cast<off_t>(first_block * B)) < 0) {
+        return -1;
+    }
+
+    auto& cache = DirectIOBlockCache::shared();
+    for (uint64_t block = first_block; block < end_block; ++block) {
+        cache.erase(file_key_, block);
+    }
+
+    // 记录新的尾块，下次追加不需要再读回
+    size_ = std::max(size_, end);
+    uint64_t tail_block = size_ / B;
+    if (tail_block >= first_block && tail_block < end_block) {
+        std::memcpy(tail_.get(), aligned.get() + (tail_block - first_block) * B, B);
+        tail_block_ = tail_block;
+    } else if (tail_block == end_block) {
+        // 刚好写满整块，下一个块还是空的
+        std::memset(tail_.get(), 0, B);
+        tail_block_ = tail_block;
+    }
+
+    return static_cast<ssize_t>(total);
+}
+
+int DirectIOManager::allocate(off_t offset, off_t len) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open_) {
+        errno = EBADF;
+        return -1;
+    }
+    return fallocate(fd_, FALLOC_FL_KEEP_SIZE, offset, len);
+}
+
+int DirectIOManager::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open_) {
+        return 0;
+    }
+    // O_DIRECT不经过页缓存，但文件大小等元数据和磁盘缓存仍需要fdatasync
+    return fdatasync(fd_);
+}
+
+int DirectIOManager::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_open_ && fd_ != -1) {
+        int result = ::close(fd_);
+        fd_ = -1;
+        is_open_ = false;
+        return result;
+    }
+    return 0;
+}
+
+off_t DirectIOManager::size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open_) {
+        errno = EBADF;
+        return -1;
+    }
+    return static_cast<off_t>(size_);
+}
+
+} // namespace bitcask
@@ -5,6 +5,7 @@
 #include <map>
 #include <shared_mutex>
 #include <algorithm>
+#include <iterator>
 
 namespace bitcask {
 
@@ -43,7 +44,7 @@ std::pair<std::unique_ptr<LogRecordPos>, bool> BTreeIndex::remove(const Bytes& k
     auto it = tree_.find(key);
     if (it != tree_.end()) {
         auto old_pos = std::make_unique<LogRecordPos>(it->second);
-        tree_.erase(it);
+        cursors_.erase(tree_, it);
         return {std::move(old_pos), true};
     }
     return {nullptr, false};
@@ -55,8 +56,8 @@ size_t BTreeIndex::size() const {
 }
 
 std::unique_ptr<IndexIterator> BTreeIndex::iterator(bool reverse) {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    return std::make_unique<BTreeIterator>(tree_, reverse);
+    // 迭代器每次操作自己加锁，这里不持有锁
+    return std::make_unique<BTreeIterator>(tree_, mutex_, cursors_, reverse);
 }
 
 std::vector<Bytes> BTreeIndex::list_keys() {
@@ -74,78 +75,150 @@ std::vector<Bytes> BTreeIndex::list_keys() {
 
 void BTreeIndex::close() {
     std::unique_lock<std::shared_mutex> lock(mutex_);
-    tree_.clear();
+    cursors_.clear(tree_);
 }
 
-// BTreeIterator实现
-BTreeIterator::BTreeIterator(const std::map<Bytes, LogRecordPos>& tree, bool reverse)
-    : current_index_(0), reverse_(reverse) {
-    
-    // 将树中的数据复制到数组中
-    items_.reserve(tree.size());
-    for (const auto& pair : tree) {
-        items_.emplace_back(pair.first, pair.second);
-    }
-    
-    // 如果是反向迭代，反转数组
-    if (reverse_) {
-        std::reverse(items_.begin(), items_.end());
+// BTreeCursors实现
+void BTreeCursors::erase(Tree& tree, Tree::const_iterator it) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    version_++;
+    if (!park(tree, it)) {
+        tree.erase(it);
     }
 }
 
-void BTreeIterator::rewind() {
-    current_index_ = 0;
+void BTreeCursors::clear(Tree& tree) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    version_++;
+    for (BTreeIterator* cursor : cursors_) {
+        if (cursor->valid_ && !cursor->parked_) {
+            park(tree, cursor->it_);
+        }
+    }
+    tree.clear();
 }
 
-void BTreeIterator::seek(const Bytes& key) {
-    if (reverse_) {
-        // 反向迭代：找到第一个小于等于key的位置
-        for (size_t i = 0; i < items_.size(); ++i) {
-            if (items_[i].first <= key) {
-                current_index_ = i;
-                return;
-            }
-        }
-        current_index_ = items_.size(); // 未找到
-    } else {
-        // 正向迭代：找到第一个大于等于key的位置
-        for (size_t i = 0; i < items_.size(); ++i) {
-            if (items_[i].first >= key) {
-                current_index_ = i;
-                return;
+bool BTreeCursors::park(Tree& tree, Tree::const_iterator it) {
+    // 按key的地址识别停在这个节点上的游标，摘下的节点共享给它们
+    const Bytes* key = &it->first;
+    std::shared_ptr<Tree::node_type> node;
+    for (BTreeIterator* cursor : cursors_) {
+        if (cursor->valid_ && !cursor->parked_ && cursor->key_ == key) {
+            if (!node) {
+                node = std::make_shared<Tree::node_type>(tree.extract(it));
             }
+            cursor->parked_ = node;
         }
-        current_index_ = items_.size(); // 未找到
     }
+    return node != nullptr;
+}
+
+// BTreeIterator实现
+BTreeIterator::BTreeIterator(const std::map<Bytes, LogRecordPos>& tree, std::shared_mutex& mutex,
+                             BTreeCursors& cursors, bool reverse)
+    : tree_(tree), mutex_(mutex), cursors_(cursors), version_(0),
+      it_(tree.end()), key_(nullptr), valid_(false), reverse_(reverse) {
+    {
+        std::lock_guard<std::mutex> lock(cursors_.mutex_);
+        cursors_.cursors_.push_back(this);
+    }
+    rewind();
+}
+
+BTreeIterator::~BTreeIterator() {
+    std::lock_guard<std::mutex> lock(cursors_.mutex_);
+    auto& cursors = cursors_.cursors_;
+    cursors.erase(std::find(cursors.begin(), cursors.end(), this));
+}
+
+void BTreeIterator::rewind() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    version_ = cursors_.version();
+    if (tree_.empty()) {
+        load(false);
+        return;
+    }
+    it_ = reverse_ ? std::prev(tree_.end()) : tree_.begin();
+    load(true);
+}
+
+void BTreeIterator::seek(const Bytes& key) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    position_at(key, true);
 }
 
 void BTreeIterator::next() {
-    if (current_index_ < items_.size()) {
-        current_index_++;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (!valid_) {
+        return;
+    }
+    if (version_ != cursors_.version()) {
+        // 期间有删除，当前节点可能已经摘下，从当前key的下一个位置重新定位
+        position_at(*key_, false);
+        return;
+    }
+    if (!reverse_) {
+        load(++it_ != tree_.end());
+    } else if (it_ == tree_.begin()) {
+        load(false);
+    } else {
+        --it_;
+        load(true);
     }
 }
 
 bool BTreeIterator::valid() const {
-    return current_index_ < items_.size();
+    return valid_;
 }
 
-Bytes BTreeIterator::key() const {
-    if (!valid()) {
+const Bytes& BTreeIterator::key() const {
+    if (!valid_) {
         throw BitcaskException("Iterator is not valid");
     }
-    return items_[current_index_].first;
+    return *key_;
 }
 
 LogRecordPos BTreeIterator::value() const {
-    if (!valid()) {
+    if (!valid_) {
         throw BitcaskException("Iterator is not valid");
     }
-    return items_[current_index_].second;
+    // 读取最新的位置；当前key已被删除时返回删除前的位置
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (!parked_) {
+        return it_->second;
+    }
+    auto it = tree_.find(*key_);
+    return it != tree_.end() ? it->second : parked_->mapped();
 }
 
 void BTreeIterator::close() {
-    items_.clear();
-    current_index_ = 0;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    valid_ = false;
+    parked_.reset();
+}
+
+void BTreeIterator::position_at(const Bytes& key, bool inclusive) {
+    version_ = cursors_.version();
+    if (!reverse_) {
+        it_ = inclusive ? tree_.lower_bound(key) : tree_.upper_bound(key);
+        load(it_ != tree_.end());
+        return;
+    }
+    // 反向：先找到第一个不满足条件的位置，再退一步
+    it_ = inclusive ? tree_.upper_bound(key) : tree_.lower_bound(key);
+    if (it_ == tree_.begin()) {
+        load(false);
+        return;
+    }
+    --it_;
+    load(true);
+}
+
+void BTreeIterator::load(bool found) {
+    valid_ = found;
+    key_ = found ? &it_->first : nullptr;
+    // 定位用的key可能就在保管的节点中，定位完成后才能释放
+    parked_.reset();
 }
 
 // 工厂函数
@@ -1,5 +1,8 @@
 #include "bitcask/io_manager.h"
 #include "bitcask/mmap_io.h"
+#include "bitcask/io_uring_io.h"
+#include "bitcask/direct_io.h"
+#include "bitcask/rate_limiter.h"
 #include "bitcask/utils.h"
 #include <fcntl.h>
 #include <unistd.h>
@@ -9,6 +12,37 @@
 
 namespace bitcask {
 
+// IOManager 默认实现
+ssize_t IOManager::writev(const struct iovec* iov, int iovcnt, off_t offset) {
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+        ssize_t n = write(iov[i].iov_base, iov[i].iov_len, offset + total);
+        if (n < 0) {
+            return -1;
+        }
+        total += n;
+        if (static_cast<size_t>(n) != iov[i].iov_len) {
+            break;
+        }
+    }
+    return total;
+}
+
+void IOManager::read_batch(IORequest* reqs, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        reqs[i].result = read(reqs[i].buf, reqs[i].size, reqs[i].offset);
+    }
+}
+
+int IOManager::allocate(off_t offset, off_t len) {
+    (void)offset;
+    (void)len;
+    return 0;
+}
+
 // FileIOManager 实现
 FileIOManager::FileIOManager(const std::string& file_path)
     : file_path_(file_path), fd_(-1), is_open_(false) {
@@ -54,6 +88,27 @@ ssize_t FileIOManager::write(const void* buf, size_t size, off_t offset) {
     return bytes_written;
 }
 
+ssize_t FileIOManager::writev(const struct iovec* iov, int iovcnt, off_t offset) {
+    if (!is_open_) {
+        errno = EBADF;
+        return -1;
+    }
+    
+    // 头部、key、value一次系统调用写入，无需拼接成连续缓冲区
+    ssize_t bytes_written = pwritev(fd_, iov, iovcnt, offset);
+    return bytes_written;
+}
+
+int FileIOManager::allocate(off_t offset, off_t len) {
+    if (!is_open_) {
+        errno = EBADF;
+        return -1;
+    }
+    
+    // FALLOC_FL_KEEP_SIZE：只分配磁盘块，文件大小不变，读者和恢复流程看不到预分配的部分
+    return fallocate(fd_, FALLOC_FL_KEEP_SIZE, offset, len);
+}
+
 int FileIOManager::sync() {
     if (!is_open_) {
         // 文件未打开，返回成功
@@ -68,7 +123,12 @@ int FileIOManager::sync() {
             return 0;
         }
         
-        // 如果fdatasync失败，尝试fsync
+        // 写回错误只报告一次，重试可能“成功”但数据已经丢了，直接交给调用者
+        if (errno != EINVAL && errno != ENOSYS) {
+            return -1;
+        }
+        
+        // fdatasync不被支持时，尝试fsync
         result = fsync(fd_);
         if (result == 0) {
             return 0;
@@ -81,9 +141,8 @@ int FileIOManager::sync() {
             return 0;
         }
         
-        // 其他错误也忽略，确保程序继续运行
-        // 在容器、虚拟机、测试环境中，同步操作经常会有问题
-        return 0;
+        // 其他错误（如EIO、ENOSPC）说明数据可能没有落盘，交给调用者处理
+        return -1;
         
     } catch (...) {
         // 捕获任何异常，确保不会中断程序
@@ -116,12 +175,64 @@ off_t FileIOManager::size() {
 }
 
 // 工厂函数
+// RateLimitedIOManager 实现
+RateLimitedIOManager::RateLimitedIOManager(std::unique_ptr<IOManager> inner, std::shared_ptr<RateLimiter> limiter)
+    : inner_(std::move(inner)), limiter_(std::move(limiter)) {}
+
+ssize_t RateLimitedIOManager::read(void* buf, size_t size, off_t offset) {
+    limiter_->request(size);
+    return inner_->read(buf, size, offset);
+}
+
+ssize_t RateLimitedIOManager::write(const void* buf, size_t size, off_t offset) {
+    limiter_->request(size);
+    return inner_->write(buf, size, offset);
+}
+
+ssize_t RateLimitedIOManager::writev(const struct iovec* iov, int iovcnt, off_t offset) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    limiter_->request(total);
+    return inner_->writev(iov, iovcnt, offset);
+}
+
+void RateLimitedIOManager::read_batch(IORequest* reqs, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += reqs[i].size;
+    }
+    limiter_->request(total);
+    inner_->read_batch(reqs, count);
+}
+
+int RateLimitedIOManager::allocate(off_t offset, off_t len) {
+    return inner_->allocate(offset, len);
+}
+
+int RateLimitedIOManager::sync() {
+    return inner_->sync();
+}
+
+int RateLimitedIOManager::close() {
+    return inner_->close();
+}
+
+off_t RateLimitedIOManager::size() {
+    return inner_->size();
+}
+
 std::unique_ptr<IOManager> create_io_manager(const std::string& file_path, IOType type) {
     switch (type) {
         case IOType::STANDARD_FIO:
             return std::make_unique<FileIOManager>(file_path);
         case IOType::MEMORY_MAP:
             return std::make_unique<MMapIOManager>(file_path);
+        case IOType::IO_URING:
+            return std::make_unique<IOUringIOManager>(file_path);
+        case IOType::DIRECT_IO:
+            return std::make_unique<DirectIOManager>(file_path);
         default:
             throw BitcaskException("Unsupported IO type");
     }
@@ -0,0 +1,344 @@
+#include "bitcask/io_uring_io.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bitcask {
+
+namespace {
+
+// 共享ring的队列深度
+const unsigned SHARED_RING_ENTRIES = 256;
+
+int sys_io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// 一个已提交请求的完成槽位，提交队列项的user_data指向它
+struct Completion {
+    IOUringOp* op;
+    size_t* pending;            // 所属批次未完成的请求数
+};
+
+}  // namespace
+
+// IOUring 实现
+IOUring* IOUring::shared() {
+    static std::unique_ptr<IOUring> ring = []() {
+        std::unique_ptr<IOUring> r(new IOUring(SHARED_RING_ENTRIES));
+        if (!r->init()) {
+            r.reset();
+        }
+        return r;
+    }();
+    return ring.get();
+}
+
+IOUring::IOUring(unsigned entries)
+    : entries_(entries), ring_fd_(-1), broken_(false),
+      sq_ptr_(nullptr), sq_size_(0), cq_ptr_(nullptr), cq_size_(0),
+      sqes_(nullptr), sqes_size_(0),
+      sq_head_(nullptr), sq_tail_(nullptr), sq_mask_(nullptr), sq_array_(nullptr), sq_entries_(0),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(nullptr), cqes_(nullptr), cq_entries_(0),
+      reaping_(false), inflight_(0) {
+}
+
+IOUring::~IOUring() {
+    cleanup();
+}
+
+bool IOUring::init() {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    // 内核不支持（ENOSYS）或被seccomp禁止（EPERM）时直接失败，由调用者回退
+    ring_fd_ = sys_io_uring_setup(entries_, &params);
+    if (ring_fd_ < 0) {
+        ring_fd_ = -1;
+        return false;
+    }
+
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+        sq_ptr_ = nullptr;
+        cleanup();
+        return false;
+    }
+
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            cq_ptr_ = nullptr;
+            cleanup();
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        cleanup();
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    uint8_t* sq = static_cast<uint8_t*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+
+    uint8_t* cq = static_cast<uint8_t*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    cq_entries_ = params.cq_entries;
+
+    return true;
+}
+
+void IOUring::cleanup() {
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_) {
+        munmap(cq_ptr_, cq_size_);
+    }
+    cq_ptr_ = nullptr;
+    if (sq_ptr_) {
+        munmap(sq_ptr_, sq_size_);
+        sq_ptr_ = nullptr;
+    }
+    if (ring_fd_ != -1) {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+bool IOUring::submit(IOUringOp* ops, size_t count) {
+    std::vector<Completion> slots(count);
+    size_t pending = 0;
+    size_t next = 0;
+    bool failed = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (next < count && !failed) {
+        if (broken_) {
+            failed = true;
+            break;
+        }
+        // 提交的数量受提交队列大小和完成队列剩余容量限制，完成队列不会溢出
+        unsigned room = std::min(sq_entries_, cq_entries_ - inflight_);
+        unsigned batch = static_cast<unsigned>(std::min<size_t>(count - next, room));
+        if (batch == 0) {
+            wait_completions(lock);
+            continue;
+        }
+
+        unsigned tail = __atomic_load_n(sq_tail_, __ATOMIC_ACQUIRE);
+        unsigned mask = *sq_mask_;
+        for (unsigned i = 0; i < batch; ++i) {
+            IOUringOp& op = ops[next + i];
+            slots[next + i] = Completion{&op, &pending};
+            unsigned index = (tail + i) & mask;
+            struct io_uring_sqe* sqe = &sqes_[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = op.write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->fd = op.fd;
+            sqe->addr = reinterpret_cast<uint64_t>(op.iov);
+            sqe->len = op.iovcnt;
+            sqe->off = static_cast<uint64_t>(op.offset);
+            sqe->user_data = reinterpret_cast<uint64_t>(&slots[next + i]);
+            sq_array_[index] = index;
+        }
+        __atomic_store_n(sq_tail_, tail + batch, __ATOMIC_RELEASE);
+
+        int error = 0;
+        unsigned accepted = enter_submit(tail, batch, error);
+        inflight_ += accepted;
+        pending += accepted;
+        next += accepted;
+        if (accepted < batch) {
+            if ((error == EAGAIN || error == EBUSY) && inflight_ > 0) {
+                // 内核资源暂时不足，等一些请求完成后重试
+                wait_completions(lock);
+            } else if (accepted == 0) {
+                // 无法提交：本批剩余请求回退到同步IO，不是暂时性的错误时之后的请求也都回退
+                if (error != 0 && error != EAGAIN && error != EBUSY) {
+                    broken_ = true;
+                }
+                failed = true;
+            }
+        }
+    }
+
+    // 即使失败也要等本批已提交的请求全部完成，之前内核仍可能读写调用者的缓冲区
+    while (pending > 0) {
+        wait_completions(lock);
+    }
+    return !failed;
+}
+
+unsigned IOUring::enter_submit(unsigned tail, unsigned count, int& error) {
+    int ret;
+    do {
+        ret = sys_io_uring_enter(ring_fd_, count, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    error = ret < 0 ? errno : 0;
+
+    unsigned accepted = ret > 0 ? static_cast<unsigned>(ret) : 0;
+    if (accepted < count) {
+        // 提交队列在锁外总是空的，内核没有取走的只可能是这一批末尾的请求
+        __atomic_store_n(sq_tail_, tail + accepted, __ATOMIC_RELEASE);
+    }
+    return accepted;
+}
+
+void IOUring::wait_completions(std::unique_lock<std::mutex>& lock) {
+    if (reaping_) {
+        // 已有线程在等待，它收割时会把结果分发给这里的请求
+        cv_.wait(lock);
+        return;
+    }
+
+    reaping_ = true;
+    lock.unlock();
+    int ret = sys_io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+    int error = ret < 0 ? errno : 0;
+    bool wait_failed = ret < 0 && error != EINTR && error != EAGAIN && error != EBUSY;
+    if (wait_failed) {
+        // 不能阻塞等待时改为轮询，已提交请求的完成事件仍会由内核写入完成队列
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    lock.lock();
+
+    if (wait_failed) {
+        broken_ = true;
+    }
+    reap_locked();
+    reaping_ = false;
+    cv_.notify_all();
+}
+
+void IOUring::reap_locked() {
+    // 完成顺序与提交顺序无关，按user_data找到对应的请求
+    unsigned head = __atomic_load_n(cq_head_, __ATOMIC_ACQUIRE);
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+        Completion* completion = reinterpret_cast<Completion*>(cqe->user_data);
+        completion->op->result = cqe->res < 0 ? -1 : cqe->res;
+        completion->op->error = cqe->res < 0 ? -cqe->res : 0;
+        (*completion->pending)--;
+        inflight_--;
+        head++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+// IOUringIOManager 实现
+IOUringIOManager::IOUringIOManager(const std::string& file_path)
+    : FileIOManager(file_path), ring_(IOUring::shared()) {
+}
+
+bool IOUringIOManager::submit_one(bool write, const struct iovec* iov, int iovcnt,
+                                  off_t offset, ssize_t& result) {
+    if (!ring_ || !is_open_) {
+        return false;
+    }
+    IOUringOp op{fd_, write, iov, static_cast<unsigned>(iovcnt), offset, -1, 0};
+    if (!ring_->submit(&op, 1)) {
+        return false;
+    }
+    result = op.result;
+    if (result < 0) {
+        errno = op.error;
+    }
+    return true;
+}
+
+ssize_t IOUringIOManager::read(void* buf, size_t size, off_t offset) {
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = size;
+    ssize_t result = -1;
+    if (submit_one(false, &iov, 1, offset, result)) {
+        return result;
+    }
+    return FileIOManager::read(buf, size, offset);
+}
+
+ssize_t IOUringIOManager::write(const void* buf, size_t size, off_t offset) {
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(buf);
+    iov.iov_len = size;
+    ssize_t result = -1;
+    if (submit_one(true, &iov, 1, offset, result)) {
+        return result;
+    }
+    return FileIOManager::write(buf, size, offset);
+}
+
+ssize_t IOUringIOManager::writev(const struct iovec* iov, int iovcnt, off_t offset) {
+    ssize_t result = -1;
+    if (submit_one(true, iov, iovcnt, offset, result)) {
+        return result;
+    }
+    return FileIOManager::writev(iov, iovcnt, offset);
+}
+
+void IOUringIOManager::read_batch(IORequest* reqs, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (!ring_ || !is_open_) {
+        FileIOManager::read_batch(reqs, count);
+        return;
+    }
+
+    std::vector<struct iovec> iovs(count);
+    std::vector<IOUringOp> ops(count);
+    for (size_t i = 0; i < count; ++i) {
+        iovs[i].iov_base = reqs[i].buf;
+        iovs[i].iov_len = reqs[i].size;
+        ops[i] = IOUringOp{fd_, false, &iovs[i], 1, reqs[i].offset, -1, 0};
+    }
+
+    // 整批请求一次提交，设备上可以同时有多个读在排队
+    if (!ring_->submit(ops.data(), count)) {
+        FileIOManager::read_batch(reqs, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        reqs[i].result = ops[i].result;
+    }
+}
+
+} // namespace bitcask
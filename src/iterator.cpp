@@ -1,11 +1,40 @@
 #include "bitcask/db.h"
+#include <algorithm>
 
 namespace bitcask {
 
+namespace {
+
+// 以prefix开头的key的上界：去掉末尾的0xFF后最后一个字节加一；全是0xFF时没有上界
+bool prefix_upper_bound(const Bytes& prefix, Bytes& upper) {
+    upper = prefix;
+    while (!upper.empty() && upper.back() == 0xFF) {
+        upper.pop_back();
+    }
+    if (upper.empty()) {
+        return false;
+    }
+    upper.back()++;
+    return true;
+}
+
+}  // namespace
+
 // DBIterator实现
 DBIterator::DBIterator(DB* db, const IteratorOptions& options)
-    : db_(db), options_(options) {
+    : db_(db), options_(options), lower_(options.lower_bound), upper_(options.upper_bound),
+      has_upper_(!options.upper_bound.empty()), returned_(0), valid_(false) {
+    // 前缀转换成范围，和上下界取交集
+    if (!options_.prefix.empty()) {
+        lower_ = std::max(lower_, options_.prefix);
+        Bytes prefix_upper;
+        if (prefix_upper_bound(options_.prefix, prefix_upper) && (!has_upper_ || prefix_upper < upper_)) {
+            upper_ = std::move(prefix_upper);
+            has_upper_ = true;
+        }
+    }
     index_iter_ = db_->index_->iterator(options_.reverse);
+    rewind();
 }
 
 DBIterator::~DBIterator() {
@@ -17,60 +46,75 @@ void DBIterator::rewind() {
         return;
     }
     
-    index_iter_->rewind();
-    
-    // 如果有前缀过滤，移动到第一个匹配的位置
-    if (!options_.prefix.empty()) {
-        index_iter_->seek(options_.prefix);
+    if (!options_.reverse && !lower_.empty()) {
+        index_iter_->seek(lower_);
+    } else if (options_.reverse && has_upper_) {
+        // 反向定位到最后一个小于等于上界的key，上界本身不包含
+        index_iter_->seek(upper_);
+        if (index_iter_->valid() && index_iter_->key() == upper_) {
+            index_iter_->next();
+        }
+    } else {
+        index_iter_->rewind();
     }
+    returned_ = 0;
+    update_valid();
 }
 
 void DBIterator::seek(const Bytes& key) {
     if (!index_iter_) {
         return;
     }
+    
+    // 目标在范围之外时从范围的起点开始
+    if (!options_.reverse && key < lower_) {
+        rewind();
+        return;
+    }
+    if (options_.reverse && has_upper_ && !(key < upper_)) {
+        rewind();
+        return;
+    }
     index_iter_->seek(key);
+    returned_ = 0;
+    update_valid();
 }
 
 void DBIterator::next() {
-    if (!index_iter_) {
+    if (!valid_) {
         return;
     }
     index_iter_->next();
+    returned_++;
+    update_valid();
 }
 
 bool DBIterator::valid() const {
-    if (!index_iter_ || !index_iter_->valid()) {
-        return false;
-    }
-    
-    // 检查前缀过滤
-    if (!options_.prefix.empty()) {
-        Bytes current_key = index_iter_->key();
-        if (current_key.size() < options_.prefix.size()) {
-            return false;
-        }
-        
-        // 检查是否以指定前缀开头
-        for (size_t i = 0; i < options_.prefix.size(); ++i) {
-            if (current_key[i] != options_.prefix[i]) {
-                return false;
-            }
-        }
-    }
-    
-    return true;
+    return valid_;
 }
 
-Bytes DBIterator::key() const {
-    if (!valid()) {
+const Bytes& DBIterator::key() const {
+    if (!valid_) {
         throw BitcaskException("Iterator is not valid");
     }
     return index_iter_->key();
 }
 
+void DBIterator::update_valid() {
+    valid_ = false;
+    if (!index_iter_->valid() || (options_.limit > 0 && returned_ >= options_.limit)) {
+        return;
+    }
+    // 从范围的一端开始移动，只需要检查另一端
+    const Bytes& key = index_iter_->key();
+    if (options_.reverse ? key < lower_ : (has_upper_ && !(key < upper_))) {
+        return;
+    }
+    valid_ = true;
+}
+
 Bytes DBIterator::value() const {
-    if (!valid()) {
+    if (!valid_) {
         throw BitcaskException("Iterator is not valid");
     }
     
@@ -79,6 +123,7 @@ Bytes DBIterator::value() const {
 }
 
 void DBIterator::close() {
+    valid_ = false;
     if (index_iter_) {
         index_iter_->close();
         index_iter_.reset();
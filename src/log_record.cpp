@@ -1,21 +1,23 @@
 #include "bitcask/log_record.h"
+#include "bitcask/crc32c.h"
 #include <cstring>
 #include <algorithm>
 
-// CRC32 实现选择
+// 旧版本数据文件使用的CRC32（IEEE多项式），只用于校验旧文件中的记录
 #ifdef USE_ZLIB_CRC32
 #include <zlib.h>
-namespace crc32c {
+namespace legacy_crc32 {
     uint32_t Crc32c(const void* data, size_t length) {
         return crc32(0, static_cast<const Bytef*>(data), length);
     }
     uint32_t Extend(uint32_t crc, const void* data, size_t length) {
+        if (length == 0) return crc;
         return crc32(crc, static_cast<const Bytef*>(data), length);
     }
 }
 #else
 // 简单的CRC32实现，用于替代外部库
-namespace crc32c {
+namespace legacy_crc32 {
     // CRC32表
     static const uint32_t crc32_table[256] = {
         0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
@@ -184,63 +186,69 @@ LogRecordPos LogRecordPos::decode(const Bytes& data) {
 
 // LogRecord实现
 std::pair<Bytes, size_t> LogRecord::encode() const {
-    size_t total_size = encoded_size();
-    Bytes result;
-    result.reserve(total_size);
-    
-    // 预留CRC位置
-    result.resize(4);
-    
-    // 写入类型
-    result.push_back(static_cast<uint8_t>(type));
-    
-    // 写入key长度
-    uint8_t buffer[10];
-    size_t len = encode_varint(key.size(), buffer);
-    result.insert(result.end(), buffer, buffer + len);
+    uint8_t header[MAX_LOG_RECORD_HEADER_SIZE];
+    size_t header_size = encode_header(header);
     
-    // 写入value长度
-    len = encode_varint(value.size(), buffer);
-    result.insert(result.end(), buffer, buffer + len);
+    Bytes result;
+    result.reserve(header_size + key.size() + value.size());
+    result.insert(result.end(), header, header + header_size);
     
     // 写入key和value
     result.insert(result.end(), key.begin(), key.end());
     result.insert(result.end(), value.begin(), value.end());
     
-    // 计算CRC（跳过前4个字节的CRC字段）
-    uint32_t crc = crc32c::Crc32c(result.data() + 4, result.size() - 4);
-    
-    // 写入CRC (小端序)
-    result[0] = crc & 0xFF;
-    result[1] = (crc >> 8) & 0xFF;
-    result[2] = (crc >> 16) & 0xFF;
-    result[3] = (crc >> 24) & 0xFF;
-    
     return {result, result.size()};
 }
 
-uint32_t LogRecord::get_crc() const {
-    // 创建临时缓冲区来计算CRC
-    Bytes temp;
-    temp.reserve(encoded_size() - 4); // 不包含CRC字段
+size_t LogRecord::encode_header(uint8_t* buf) const {
+    size_t pos = 4; // 预留CRC位置
     
     // 写入类型
-    temp.push_back(static_cast<uint8_t>(type));
+    buf[pos++] = static_cast<uint8_t>(type);
     
-    // 写入key长度
-    uint8_t buffer[10];
-    size_t len = encode_varint(key.size(), buffer);
-    temp.insert(temp.end(), buffer, buffer + len);
+    // 写入key和value长度
+    pos += encode_varint(key.size(), buf + pos);
+    pos += encode_varint(value.size(), buf + pos);
+    
+    // 计算CRC32C（跳过前4个字节的CRC字段），增量覆盖key和value，无需拼接
+    uint32_t crc = crc32c::value(buf + 4, pos - 4);
+    if (!key.empty()) {
+        crc = crc32c::extend(crc, key.data(), key.size());
+    }
+    if (!value.empty()) {
+        crc = crc32c::extend(crc, value.data(), value.size());
+    }
     
-    // 写入value长度
-    len = encode_varint(value.size(), buffer);
-    temp.insert(temp.end(), buffer, buffer + len);
+    // 写入CRC (小端序)
+    buf[0] = crc & 0xFF;
+    buf[1] = (crc >> 8) & 0xFF;
+    buf[2] = (crc >> 16) & 0xFF;
+    buf[3] = (crc >> 24) & 0xFF;
     
-    // 写入key和value
-    temp.insert(temp.end(), key.begin(), key.end());
-    temp.insert(temp.end(), value.begin(), value.end());
+    return pos;
+}
+
+uint32_t LogRecord::get_crc() const {
+    uint8_t header[MAX_LOG_RECORD_HEADER_SIZE];
+    encode_header(header);
+    return static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+           (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+}
+
+bool LogRecord::verify_crc(uint32_t crc) const {
+    uint8_t header[MAX_LOG_RECORD_HEADER_SIZE];
+    size_t header_size = encode_header(header);
+    uint32_t expected = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                        (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+    if (crc == expected) {
+        return true;
+    }
     
-    return crc32c::Crc32c(temp.data(), temp.size());
+    // 兼容旧版本写入的CRC32（IEEE）校验值
+    uint32_t legacy = legacy_crc32::Crc32c(header + 4, header_size - 4);
+    legacy = legacy_crc32::Extend(legacy, key.data(), key.size());
+    legacy = legacy_crc32::Extend(legacy, value.data(), value.size());
+    return crc == legacy;
 }
 
 size_t LogRecord::encoded_size() const {
@@ -269,7 +277,11 @@ size_t LogRecord::encoded_size() const {
 
 // 解码日志记录头部
 std::pair<LogRecordHeader, size_t> decode_log_record_header(const Bytes& data) {
-    if (data.size() < 5) { // 至少需要4字节CRC + 1字节type
+    return decode_log_record_header(data.data(), data.size());
+}
+
+std::pair<LogRecordHeader, size_t> decode_log_record_header(const uint8_t* data, size_t size) {
+    if (size < 5) { // 至少需要4字节CRC + 1字节type
         throw BitcaskException("Invalid header data");
     }
     
@@ -284,24 +296,62 @@ std::pair<LogRecordHeader, size_t> decode_log_record_header(const Bytes& data) {
     header.type = static_cast<LogRecordType>(data[pos++]);
     
     // 读取key长度
-    auto [key_size, key_len] = decode_varint(data.data() + pos, data.size() - pos);
+    auto [key_size, key_len] = decode_varint(data + pos, size - pos);
     header.key_size = static_cast<uint32_t>(key_size);
     pos += key_len;
     
     // 读取value长度
-    auto [value_size, value_len] = decode_varint(data.data() + pos, data.size() - pos);
+    auto [value_size, value_len] = decode_varint(data + pos, size - pos);
     header.value_size = static_cast<uint32_t>(value_size);
     pos += value_len;
     
     return {header, pos};
 }
 
+bool verify_encoded_log_record(const uint8_t* data, size_t size) {
+    if (size < 5) {
+        return false;
+    }
+    uint32_t crc = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                   (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    if (crc == crc32c::value(data + 4, size - 4)) {
+        return true;
+    }
+    return crc == legacy_crc32::Crc32c(data + 4, size - 4);
+}
+
+const LogRecord& sync_marker_record() {
+    static const LogRecord marker(Bytes{0x00, 0xbc, 's', 'y', 'n', 'c', '-', 'm', 'a', 'r', 'k', 'e', 'r', 0xff, 0x5a, 0xa5},
+                                  Bytes{}, LogRecordType::SYNC_MARKER);
+    return marker;
+}
+
+const Bytes& encoded_sync_marker() {
+    static const Bytes encoded = sync_marker_record().encode().first;
+    return encoded;
+}
+
+LogRecord padding_record(size_t size) {
+    // 头部为CRC(4) + 类型(1) + key长度 + value长度；value长度的varint变长时
+    // 空key凑不出某些总长度，这时用一个字节的key补齐
+    for (size_t key_size = 0; key_size <= 1; ++key_size) {
+        for (size_t varint = 1; varint <= 10 && 6 + key_size + varint <= size; ++varint) {
+            LogRecord record(Bytes(key_size, 0), Bytes(size - 6 - key_size - varint, 0),
+                             LogRecordType::SYNC_MARKER);
+            if (record.encoded_size() == size) {
+                return record;
+            }
+        }
+    }
+    throw BitcaskException("Padding record size too small: " + std::to_string(size));
+}
+
 // 计算日志记录CRC值
 uint32_t get_log_record_crc(const LogRecord& record, const Bytes& header) {
     // 计算不包含CRC的头部 + key + value的CRC
-    uint32_t crc = crc32c::Crc32c(header.data(), header.size());
-    crc = crc32c::Extend(crc, record.key.data(), record.key.size());
-    crc = crc32c::Extend(crc, record.value.data(), record.value.size());
+    uint32_t crc = crc32c::value(header.data(), header.size());
+    crc = crc32c::extend(crc, record.key.data(), record.key.size());
+    crc = crc32c::extend(crc, record.value.data(), record.value.size());
     return crc;
 }
 
@@ -207,4 +207,27 @@ off_t MMapIOManager::size() {
     return file_stat.st_size;
 }
 
+std::shared_ptr<const ReadOnlyMapping> ReadOnlyMapping::open(const std::string& file_name, size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+    
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // 映射建立后即可关闭文件描述符
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::shared_ptr<const ReadOnlyMapping>(
+        new ReadOnlyMapping(static_cast<const uint8_t*>(data), size));
+}
+
+ReadOnlyMapping::~ReadOnlyMapping() {
+    munmap(const_cast<uint8_t*>(data_), size_);
+}
+
 } // namespace bitcask
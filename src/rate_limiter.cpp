@@ -0,0 +1,94 @@
+#include "bitcask/rate_limiter.h"
+#include <algorithm>
+#include <thread>
+
+namespace bitcask {
+
+namespace {
+
+// 调整周期，同时也是令牌桶容量对应的时长
+const auto ADJUST_PERIOD = std::chrono::milliseconds(100);
+
+// 自适应模式下速率的下限为上限的1/64
+const uint64_t MIN_RATE_DIVISOR = 64;
+
+// 一个调整周期内至少有这么多样本才调整速率
+const uint64_t MIN_SAMPLES = 16;
+
+}  // namespace
+
+RateLimiter::RateLimiter(uint64_t bytes_per_sec, uint64_t latency_target_us)
+    : max_rate_(std::max<uint64_t>(bytes_per_sec, 1)),
+      min_rate_(std::max<uint64_t>(bytes_per_sec / MIN_RATE_DIVISOR, 1)),
+      latency_target_us_(latency_target_us), rate_(max_rate_), total_bytes_(0), active_(0),
+      tokens_(0), last_refill_(Clock::now()), period_start_(last_refill_), samples_(0), slow_samples_(0) {}
+
+void RateLimiter::refill_locked(Clock::time_point now) {
+    double rate = static_cast<double>(rate_.load(std::memory_order_relaxed));
+    double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    double burst = rate * std::chrono::duration<double>(ADJUST_PERIOD).count();
+    tokens_ = std::min(tokens_ + elapsed * rate, burst);
+    last_refill_ = now;
+
+    if (latency_target_us_ == 0 || now - period_start_ < ADJUST_PERIOD) {
+        return;
+    }
+    uint64_t samples = samples_.exchange(0, std::memory_order_relaxed);
+    uint64_t slow = slow_samples_.exchange(0, std::memory_order_relaxed);
+    period_start_ = now;
+    if (samples < MIN_SAMPLES) {
+        return;
+    }
+
+    // 超过目标的样本多于1%（近似p99超标）时减半，否则逐步恢复
+    uint64_t current = rate_.load(std::memory_order_relaxed);
+    uint64_t next = slow * 100 > samples ? std::max(current / 2, min_rate_)
+                                         : std::min(current + max_rate_ / 10, max_rate_);
+    rate_.store(next, std::memory_order_relaxed);
+}
+
+void RateLimiter::request(size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    total_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+    double wait_seconds = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill_locked(Clock::now());
+        tokens_ -= static_cast<double>(bytes);
+        if (tokens_ < 0) {
+            // 先记账，欠下的令牌按当前速率补齐需要的时间在锁外等待
+            wait_seconds = -tokens_ / static_cast<double>(rate_.load(std::memory_order_relaxed));
+        }
+    }
+    if (wait_seconds > 0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(wait_seconds));
+    }
+}
+
+void RateLimiter::report_latency(uint64_t latency_us) {
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    if (latency_us > latency_target_us_) {
+        slow_samples_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+RateLimiter::ActiveScope::ActiveScope(RateLimiter* limiter) : limiter_(limiter) {
+    if (limiter_) {
+        if (limiter_->active_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            // 新的后台任务开始，丢弃空闲期间残留的样本
+            limiter_->samples_.store(0, std::memory_order_relaxed);
+            limiter_->slow_samples_.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+RateLimiter::ActiveScope::~ActiveScope() {
+    if (limiter_) {
+        limiter_->active_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace bitcask
@@ -542,8 +542,9 @@ double RedisDataStructure::zscore(const std::string& key, const std::string& mem
     Bytes key_bytes = string_to_bytes(key);
     Bytes member_bytes = string_to_bytes(member);
     
-    // 创建迭代器遍历所有相关的ZSet条目
+    // 创建迭代器遍历所有相关的ZSet条目，直接定位到以key开头的范围
     IteratorOptions iter_options;
+    iter_options.prefix = key_bytes;
     auto iter = db_->iterator(iter_options);
     
     // 寻找匹配的成员
@@ -6,12 +6,12 @@
 
 namespace bitcask {
 
-SkipListIndex::SkipListIndex() : level_(0), rng_(std::random_device{}()) {
+SkipListIndex::SkipListIndex() : level_(0), erase_version_(0), rng_(std::random_device{}()) {
     header_ = std::make_shared<SkipListNode>(MAX_LEVEL);
 }
 
 std::unique_ptr<LogRecordPos> SkipListIndex::put(const Bytes& key, const LogRecordPos& pos) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     
     std::vector<std::shared_ptr<SkipListNode>> update(MAX_LEVEL + 1);
     auto node = find_node(key, update);
@@ -45,7 +45,7 @@ std::unique_ptr<LogRecordPos> SkipListIndex::put(const Bytes& key, const LogReco
 }
 
 std::unique_ptr<LogRecordPos> SkipListIndex::get(const Bytes& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     
     std::vector<std::shared_ptr<SkipListNode>> update(MAX_LEVEL + 1);
     auto node = find_node(key, update);
@@ -58,7 +58,7 @@ std::unique_ptr<LogRecordPos> SkipListIndex::get(const Bytes& key) {
 }
 
 std::pair<std::unique_ptr<LogRecordPos>, bool> SkipListIndex::remove(const Bytes& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     
     std::vector<std::shared_ptr<SkipListNode>> update(MAX_LEVEL + 1);
     auto node = find_node(key, update);
@@ -81,12 +81,13 @@ std::pair<std::unique_ptr<LogRecordPos>, bool> SkipListIndex::remove(const Bytes
     while (level_ > 0 && !header_->forward[level_]) {
         level_--;
     }
+    erase_version_++;
     
     return {std::move(old_pos), true};
 }
 
 std::vector<Bytes> SkipListIndex::list_keys() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     
     std::vector<Bytes> keys;
     auto current = header_->forward[0];
@@ -100,7 +101,7 @@ std::vector<Bytes> SkipListIndex::list_keys() {
 }
 
 size_t SkipListIndex::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     
     size_t count = 0;
     auto current = header_->forward[0];
@@ -114,15 +115,14 @@ size_t SkipListIndex::size() const {
 }
 
 std::unique_ptr<IndexIterator> SkipListIndex::iterator(bool reverse) {
-    IteratorOptions options;
-    options.reverse = reverse;
-    return std::make_unique<SkipListIterator>(header_, options);
+    return std::make_unique<SkipListIterator>(*this, reverse);
 }
 
 void SkipListIndex::close() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     header_.reset();
     level_ = 0;
+    erase_version_++;
 }
 
 int SkipListIndex::random_level() {
@@ -163,154 +163,113 @@ std::shared_ptr<SkipListNode> SkipListIndex::find_node(const Bytes& key,
     return current->forward[0];
 }
 
-// SkipListIterator实现
-SkipListIterator::SkipListIterator(std::shared_ptr<SkipListNode> header, const IteratorOptions& options)
-    : header_(header), current_(nullptr), options_(options), current_index_(0), use_items_(false) {
-    
-    if (options_.reverse) {
-        init_items();
-        use_items_ = true;
+std::shared_ptr<SkipListNode> SkipListIndex::find_after(const Bytes& key, bool inclusive) const {
+    if (!header_) {
+        return nullptr;
     }
-    
-    rewind();
-}
-
-void SkipListIterator::rewind() {
-    if (use_items_) {
-        current_index_ = 0;
-    } else {
-        current_ = header_->forward[0];
-        
-        // 如果有前缀过滤，找到第一个匹配的键
-        while (current_ && !key_matches_prefix(current_->key)) {
-            current_ = current_->forward[0];
+    auto current = header_;
+    for (int i = level_; i >= 0; i--) {
+        while (current->forward[i]) {
+            int cmp = compare_keys(current->forward[i]->key, key);
+            if (cmp > 0 || (cmp == 0 && inclusive)) {
+                break;
+            }
+            current = current->forward[i];
         }
     }
+    return current->forward[0];
 }
 
-void SkipListIterator::seek(const Bytes& key) {
-    if (use_items_) {
-        // 在排序的项目列表中查找
-        for (size_t i = 0; i < items_.size(); i++) {
-            if (compare_keys(items_[i].first, key) >= 0) {
-                current_index_ = i;
-                return;
-            }
-        }
-        current_index_ = items_.size(); // 未找到，设置为无效位置
-    } else {
-        current_ = header_;
-        
-        // 从高层开始查找
-        for (int level = 15; level >= 0; level--) {
-            while (current_->forward[level] && 
-                   compare_keys(current_->forward[level]->key, key) < 0) {
-                current_ = current_->forward[level];
+std::shared_ptr<SkipListNode> SkipListIndex::find_before(const Bytes& key, bool inclusive) const {
+    if (!header_) {
+        return nullptr;
+    }
+    auto current = header_;
+    for (int i = level_; i >= 0; i--) {
+        while (current->forward[i]) {
+            int cmp = compare_keys(current->forward[i]->key, key);
+            if (cmp > 0 || (cmp == 0 && !inclusive)) {
+                break;
             }
-        }
-        
-        current_ = current_->forward[0];
-        
-        // 如果有前缀过滤，确保键匹配前缀
-        while (current_ && !key_matches_prefix(current_->key)) {
-            current_ = current_->forward[0];
+            current = current->forward[i];
         }
     }
+    return current == header_ ? nullptr : current;
 }
 
-void SkipListIterator::next() {
-    if (use_items_) {
-        current_index_++;
-    } else {
-        if (current_) {
-            current_ = current_->forward[0];
-            
-            // 如果有前缀过滤，跳过不匹配的键
-            while (current_ && !key_matches_prefix(current_->key)) {
-                current_ = current_->forward[0];
-            }
+std::shared_ptr<SkipListNode> SkipListIndex::find_last() const {
+    if (!header_) {
+        return nullptr;
+    }
+    auto current = header_;
+    for (int i = level_; i >= 0; i--) {
+        while (current->forward[i]) {
+            current = current->forward[i];
         }
     }
+    return current == header_ ? nullptr : current;
 }
 
-bool SkipListIterator::valid() const {
-    if (use_items_) {
-        return current_index_ < items_.size();
-    } else {
-        return current_ != nullptr;
-    }
+// SkipListIterator实现
+SkipListIterator::SkipListIterator(const SkipListIndex& index, bool reverse)
+    : index_(index), version_(0), reverse_(reverse) {
+    rewind();
 }
 
-Bytes SkipListIterator::key() const {
-    if (use_items_) {
-        if (current_index_ < items_.size()) {
-            return items_[current_index_].first;
-        }
+void SkipListIterator::rewind() {
+    std::shared_lock<std::shared_mutex> lock(index_.mutex_);
+    version_ = index_.erase_version_;
+    if (reverse_) {
+        node_ = index_.find_last();
     } else {
-        if (current_) {
-            return current_->key;
-        }
+        node_ = index_.header_ ? index_.header_->forward[0] : nullptr;
     }
-    return Bytes{};
 }
 
-LogRecordPos SkipListIterator::value() const {
-    if (use_items_) {
-        if (current_index_ < items_.size()) {
-            return items_[current_index_].second;
-        }
+void SkipListIterator::seek(const Bytes& key) {
+    std::shared_lock<std::shared_mutex> lock(index_.mutex_);
+    version_ = index_.erase_version_;
+    node_ = reverse_ ? index_.find_before(key, true) : index_.find_after(key, true);
+}
+
+void SkipListIterator::next() {
+    if (!node_) {
+        return;
+    }
+    std::shared_lock<std::shared_mutex> lock(index_.mutex_);
+    if (reverse_) {
+        node_ = index_.find_before(node_->key, false);
+    } else if (version_ == index_.erase_version_) {
+        node_ = node_->forward[0];
     } else {
-        if (current_) {
-            return current_->pos;
-        }
+        // 期间有删除，当前节点可能已被摘除，它的后继指针不再可信
+        node_ = index_.find_after(node_->key, false);
     }
-    return LogRecordPos{};
+    version_ = index_.erase_version_;
 }
 
-void SkipListIterator::close() {
-    current_ = nullptr;
-    items_.clear();
+bool SkipListIterator::valid() const {
+    return node_ != nullptr;
 }
 
-void SkipListIterator::init_items() {
-    auto current = header_->forward[0];
-    
-    while (current) {
-        if (key_matches_prefix(current->key)) {
-            items_.emplace_back(current->key, current->pos);
-        }
-        current = current->forward[0];
-    }
-    
-    // 反向排序
-    if (options_.reverse) {
-        std::reverse(items_.begin(), items_.end());
+const Bytes& SkipListIterator::key() const {
+    if (!node_) {
+        throw BitcaskException("Iterator is not valid");
     }
+    return node_->key;
 }
 
-bool SkipListIterator::key_matches_prefix(const Bytes& key) const {
-    if (options_.prefix.empty()) {
-        return true;
-    }
-    
-    if (key.size() < options_.prefix.size()) {
-        return false;
+LogRecordPos SkipListIterator::value() const {
+    if (!node_) {
+        throw BitcaskException("Iterator is not valid");
     }
-    
-    return std::equal(options_.prefix.begin(), options_.prefix.end(), key.begin());
+    // 位置会被原地更新，需要在锁内读取
+    std::shared_lock<std::shared_mutex> lock(index_.mutex_);
+    return node_->pos;
 }
 
-int SkipListIterator::compare_keys(const Bytes& a, const Bytes& b) const {
-    size_t min_len = std::min(a.size(), b.size());
-    
-    for (size_t i = 0; i < min_len; i++) {
-        if (a[i] < b[i]) return -1;
-        if (a[i] > b[i]) return 1;
-    }
-    
-    if (a.size() < b.size()) return -1;
-    if (a.size() > b.size()) return 1;
-    return 0;
+void SkipListIterator::close() {
+    node_.reset();
 }
 
 }  // namespace bitcask
@@ -1,15 +1,20 @@
 #include "bitcask/utils.h"
 #include "bitcask/common.h"
+#include "bitcask/rate_limiter.h"
 #include <cstdio>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
 #include <system_error>
 #include <iostream>
 
 #ifdef __linux__
 #include <sys/statvfs.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #elif __APPLE__
 #include <sys/statvfs.h>
 #elif _WIN32
@@ -68,57 +73,184 @@ uint64_t available_disk_size() {
     return UINT64_MAX; // 如果无法获取，返回最大值
 }
 
-void copy_file(const std::string& src, const std::string& dst) {
-    FILE* src_file = fopen(src.c_str(), "rb");
-    if (!src_file) {
-        throw BitcaskException("Failed to open source file: " + src);
-    }
-    
-    FILE* dst_file = fopen(dst.c_str(), "wb");
-    if (!dst_file) {
-        fclose(src_file);
-        throw BitcaskException("Failed to open destination file: " + dst);
+namespace {
+
+// 每次复制（并向限速器申请额度）的字节数
+const size_t COPY_CHUNK_SIZE = 1024 * 1024;
+
+// 用read/write复制[offset, length)，源文件更短时复制到末尾
+bool copy_by_read_write(int src_fd, int dst_fd, uint64_t offset, uint64_t length, RateLimiter* limiter) {
+    std::vector<char> buffer(COPY_CHUNK_SIZE);
+    while (offset < length) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), length - offset));
+        if (limiter) {
+            limiter->request(want);
+        }
+        ssize_t bytes_read = pread(src_fd, buffer.data(), want, static_cast<off_t>(offset));
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read < 0) {
+            return false;
+        }
+        if (bytes_read == 0) {
+            return true;
+        }
+        ssize_t written = 0;
+        while (written < bytes_read) {
+            ssize_t n = pwrite(dst_fd, buffer.data() + written, bytes_read - written,
+                               static_cast<off_t>(offset + written));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            written += n;
+        }
+        offset += static_cast<uint64_t>(bytes_read);
     }
-    
-    char buffer[8192];
-    size_t bytes_read;
-    
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), src_file)) > 0) {
-        size_t bytes_written = fwrite(buffer, 1, bytes_read, dst_file);
-        if (bytes_written != bytes_read) {
-            fclose(src_file);
-            fclose(dst_file);
-            throw BitcaskException("Failed to write to destination file: " + dst);
+    return true;
+}
+
+// 复制源文件的前length字节：优先copy_file_range在内核中复制（同一文件系统上可能由文件系统直接完成），
+// 不支持时退回read/write
+bool copy_range(int src_fd, int dst_fd, uint64_t length, RateLimiter* limiter) {
+#ifdef __linux__
+    loff_t offset = 0;
+    while (static_cast<uint64_t>(offset) < length) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(COPY_CHUNK_SIZE, length - offset));
+        if (limiter) {
+            limiter->request(want);
         }
-        
-        // 检查文件读取错误
-        if (ferror(src_file)) {
-            fclose(src_file);
-            fclose(dst_file);
-            throw BitcaskException("Error reading from source file: " + src);
+        loff_t out_offset = offset;
+        ssize_t n = copy_file_range(src_fd, &offset, dst_fd, &out_offset, want, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
         }
-        
-        // 检查文件写入错误
-        if (ferror(dst_file)) {
-            fclose(src_file);
-            fclose(dst_file);
-            throw BitcaskException("Error writing to destination file: " + dst);
+        if (n == 0) {
+            return true;
+        }
+        if (n < 0) {
+            // 只有一开始就失败时才能确定是不支持（EXDEV、ENOSYS等），中途失败的是真正的IO错误
+            return offset == 0 && copy_by_read_write(src_fd, dst_fd, 0, length, limiter);
         }
     }
+    return true;
+#else
+    return copy_by_read_write(src_fd, dst_fd, 0, length, limiter);
+#endif
+}
+
+// 新建dst用于写入。dst可能是源文件的硬链接（如增量备份中链接过来的文件），直接截断会清空源文件，先删除
+int create_copy_destination(const std::string& dst) {
+    unlink(dst.c_str());
+    int dst_fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (dst_fd == -1) {
+        throw BitcaskException("Failed to open destination file: " + dst);
+    }
+    return dst_fd;
+}
+
+}  // namespace
+
+void copy_file(const std::string& src, const std::string& dst, RateLimiter* limiter) {
+    int src_fd = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd == -1) {
+        throw BitcaskException("Failed to open source file: " + src);
+    }
+    int dst_fd = -1;
+    try {
+        dst_fd = create_copy_destination(dst);
+    } catch (...) {
+        close(src_fd);
+        throw;
+    }
     
-    // 确保所有数据都写入磁盘
-    if (fflush(dst_file) != 0) {
-        fclose(src_file);
-        fclose(dst_file);
-        throw BitcaskException("Failed to flush destination file: " + dst);
+    bool ok = false;
+#ifdef __linux__
+    // 文件系统支持reflink（btrfs、xfs）时共享数据块，不产生数据IO
+    ok = ioctl(dst_fd, FICLONE, src_fd) == 0;
+#endif
+    if (!ok) {
+        // 按打开时的大小复制，限速时不会为最后一块多申请额度
+        struct stat src_stat;
+        uint64_t length = fstat(src_fd, &src_stat) == 0 ? static_cast<uint64_t>(src_stat.st_size) : UINT64_MAX;
+        ok = copy_range(src_fd, dst_fd, length, limiter);
     }
     
-    fclose(src_file);
-    fclose(dst_file);
+    close(src_fd);
+    if (close(dst_fd) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        throw BitcaskException("Failed to copy file: " + src + " -> " + dst + " (" + strerror(errno) + ")");
+    }
+}
+
+void copy_file_prefix(int src_fd, const std::string& dst, uint64_t length, RateLimiter* limiter) {
+    int dst_fd = create_copy_destination(dst);
+    bool ok = copy_range(src_fd, dst_fd, length, limiter);
+    if (close(dst_fd) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        throw BitcaskException("Failed to copy file to: " + dst + " (" + strerror(errno) + ")");
+    }
+}
+
+bool link_file(const std::string& src, const std::string& dst) {
+    unlink(dst.c_str());
+    return link(src.c_str(), dst.c_str()) == 0;
+}
+
+bool same_file(const std::string& a, const std::string& b) {
+    struct stat stat_a;
+    struct stat stat_b;
+    return stat(a.c_str(), &stat_a) == 0 && stat(b.c_str(), &stat_b) == 0 &&
+           stat_a.st_dev == stat_b.st_dev && stat_a.st_ino == stat_b.st_ino;
+}
+
+void sync_file(const std::string& file_path) {
+    // fdatasync作用于文件本身，用只读描述符也能刷出其他描述符写入的数据
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw BitcaskException("Failed to open file for sync: " + file_path + " (" + strerror(errno) + ")");
+    }
+    // 失败后内核会清掉脏页的错误状态，再同步一次也不能说明数据已落盘，只能报告给调用者
+    if (fdatasync(fd) != 0 && errno != EINVAL) {
+        int err = errno;
+        close(fd);
+        throw BitcaskException("Failed to sync file: " + file_path + " (" + strerror(err) + ")");
+    }
+    close(fd);
 }
 
 void move_file(const std::string& src, const std::string& dst) {
-    rename(src.c_str(), dst.c_str());
+    if (rename(src.c_str(), dst.c_str()) == 0) {
+        return;
+    }
+    // 跨文件系统时无法改名，退回复制后删除
+    if (errno == EXDEV) {
+        copy_file(src, dst);
+        sync_file(dst);
+        std::remove(src.c_str());
+        return;
+    }
+    throw BitcaskException("Failed to move file: " + src + " -> " + dst + " (" + strerror(errno) + ")");
+}
+
+void sync_dir(const std::string& dir_path) {
+    // 目录的fsync让其中文件的创建、改名和删除落盘
+    int fd = open(dir_path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd == -1) {
+        return;
+    }
+    fsync(fd);
+    close(fd);
 }
 
 bool remove_directory(const std::string& dir_path) {
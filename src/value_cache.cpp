@@ -0,0 +1,121 @@
+#include "bitcask/value_cache.h"
+#include <algorithm>
+#include <mutex>
+
+namespace bitcask {
+
+namespace {
+
+// 每个条目除值以外的固定开销（条目、索引节点、槽位），计入用量
+const size_t ENTRY_OVERHEAD = 128;
+
+}  // namespace
+
+ValueCache::ValueCache(size_t capacity, size_t num_shards) {
+    num_shards = std::max<size_t>(num_shards, 1);
+    shard_capacity_ = capacity / num_shards;
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+ValueCache::Shard& ValueCache::shard_for(const ValueCacheKey& key) {
+    return *shards_[KeyHash()(key) % shards_.size()];
+}
+
+bool ValueCache::get(const ValueCacheKey& key, Bytes& value) {
+    Shard& shard = shard_for(key);
+    std::shared_ptr<const Bytes> found;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Entry& entry = *shard.slots[it->second];
+            entry.referenced.store(true, std::memory_order_relaxed);
+            found = entry.value;
+        }
+    }
+
+    if (!found) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+    // 在锁外复制，值被淘汰也不影响这里持有的引用
+    value.assign(found->begin(), found->end());
+    return true;
+}
+
+void ValueCache::put(const ValueCacheKey& key, const Bytes& value) {
+    size_t charge = value.size() + ENTRY_OVERHEAD;
+    if (charge > shard_capacity_) {
+        return;
+    }
+
+    auto data = std::make_shared<const Bytes>(value);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.index.count(key) != 0) {
+        // 同一位置上的记录不会变化，已缓存的值仍然有效
+        return;
+    }
+
+    evict_locked(shard, charge);
+
+    size_t slot;
+    if (!shard.free_slots.empty()) {
+        slot = shard.free_slots.back();
+        shard.free_slots.pop_back();
+    } else {
+        slot = shard.slots.size();
+        shard.slots.emplace_back();
+    }
+    shard.slots[slot] = std::make_unique<Entry>(key, std::move(data), charge);
+    shard.index.emplace(key, slot);
+    shard.usage += charge;
+}
+
+void ValueCache::evict_locked(Shard& shard, size_t charge) {
+    // 用量不为0时环中一定有条目，最多扫两圈就能腾出空间
+    while (shard.usage + charge > shard_capacity_) {
+        if (shard.hand >= shard.slots.size()) {
+            shard.hand = 0;
+        }
+        auto& entry = shard.slots[shard.hand];
+        if (entry && !entry->referenced.exchange(false, std::memory_order_relaxed)) {
+            shard.usage -= entry->charge;
+            shard.index.erase(entry->key);
+            entry.reset();
+            shard.free_slots.push_back(shard.hand);
+        }
+        shard.hand++;
+    }
+}
+
+uint64_t ValueCache::hits() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->hits.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t ValueCache::misses() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->misses.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t ValueCache::usage() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        total += shard->usage;
+    }
+    return total;
+}
+
+}  // namespace bitcask
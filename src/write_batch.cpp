@@ -48,62 +48,55 @@ void WriteBatch::commit() {
         return;
     }
     
-    std::unique_lock<std::shared_mutex> lock(db_->mutex_);
+    std::shared_lock<std::shared_mutex> lock(db_->mutex_);
     
     uint64_t current_seq_no = seq_no_.load();
-    std::vector<LogRecordPos> positions;
     
-    try {
-        positions.reserve(pending_writes_.size());
-        
-        // 写入所有记录
-        for (const auto& record : pending_writes_) {
-            // 创建带序列号的副本，避免修改原记录
-            LogRecord record_with_seq = record;
-            record_with_seq.key = DB::log_record_key_with_seq(record.key, current_seq_no);
-            
-            // 写入日志记录
-            LogRecordPos pos = db_->append_log_record_internal(record_with_seq);
-            positions.push_back(pos);
-        }
-    } catch (const std::exception& e) {
-        // 清理已分配的资源
-        positions.clear();
-        throw;
+    // 创建带序列号的副本，避免修改原记录
+    std::vector<LogRecord> records;
+    records.reserve(pending_writes_.size() + 1);
+    for (const auto& record : pending_writes_) {
+        LogRecord record_with_seq = record;
+        record_with_seq.key = DB::log_record_key_with_seq(record.key, current_seq_no);
+        records.push_back(std::move(record_with_seq));
     }
     
-    // 写入事务完成标记
+    // 事务完成标记
     LogRecord txn_fin_record;
     txn_fin_record.key = DB::log_record_key_with_seq(Bytes(), current_seq_no);
     txn_fin_record.type = LogRecordType::TXN_FINISHED;
-    db_->append_log_record_internal(txn_fin_record);
+    records.push_back(std::move(txn_fin_record));
     
-    // 同步数据（如果需要）
-    if (options_.sync_writes) {
-        db_->active_file_->sync();
+    std::vector<const LogRecord*> record_ptrs;
+    record_ptrs.reserve(records.size());
+    for (const auto& record : records) {
+        record_ptrs.push_back(&record);
     }
     
-    // 更新内存索引
-    for (size_t i = 0; i < pending_writes_.size(); ++i) {
-        const auto& record = pending_writes_[i];
-        const auto& pos = positions[i];
-        
-        // 使用原始key（pending_writes_中保存的是原始key）
-        const Bytes& real_key = record.key;
-        
-        if (record.type == LogRecordType::NORMAL) {
-            auto old_pos = db_->index_->put(real_key, pos);
-            if (old_pos) {
-                db_->reclaim_size_ += old_pos->size;
-            }
-        } else if (record.type == LogRecordType::DELETED) {
-            auto [old_pos, ok] = db_->index_->remove(real_key);
-            db_->reclaim_size_ += pos.size;
-            if (old_pos) {
-                db_->reclaim_size_ += old_pos->size;
+    // 整个批次一次预留、连续写入；需要同步时落盘后才更新索引
+    auto sync_mode = options_.sync_writes ? DB::AppendSync::ALWAYS : DB::AppendSync::POLICY;
+    db_->append_log_records(record_ptrs, sync_mode, [this](const std::vector<LogRecordPos>& positions) {
+        for (size_t i = 0; i < pending_writes_.size(); ++i) {
+            const auto& record = pending_writes_[i];
+            const auto& pos = positions[i];
+            
+            // 使用原始key（pending_writes_中保存的是原始key）
+            const Bytes& real_key = record.key;
+            
+            if (record.type == LogRecordType::NORMAL) {
+                auto old_pos = db_->index_->put(real_key, pos);
+                if (old_pos) {
+                    db_->mark_dead(*old_pos);
+                }
+            } else if (record.type == LogRecordType::DELETED) {
+                auto [old_pos, ok] = db_->index_->remove(real_key);
+                db_->mark_dead(pos);
+                if (old_pos) {
+                    db_->mark_dead(*old_pos);
+                }
             }
         }
-    }
+    });
     
     // 更新序列号
     db_->seq_no_.store(current_seq_no + 1);
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "bitcask/bitcask.h"
 #include "bitcask/utils.h"
+#include "bitcask/direct_io.h"
+#include "bitcask/crc32c.h"
 #include <chrono>
 #include <random>
 #include <algorithm>
@@ -334,6 +336,80 @@ TEST_F(BenchmarkTest, IteratorPerformance) {
     db->close();
 }
 
+// 创建迭代器并定位的开销：游标直接在索引上移动，和索引大小基本无关
+TEST_F(BenchmarkTest, IteratorSeekLatency) {
+    const int seeks = 1000;
+    std::cout << "\nIterator Seek Latency (" << NUM_KEYS << " keys, " << seeks << " seeks):" << std::endl;
+    for (IndexType type : {IndexType::BTREE, IndexType::SKIPLIST, IndexType::BPLUS_TREE, IndexType::ART}) {
+        utils::remove_directory(test_dir);
+        auto indexer = create_indexer(type, test_dir);
+        for (int i = 0; i < NUM_KEYS; ++i) {
+            indexer->put(test_keys[i], LogRecordPos(1, i, 10));
+        }
+        
+        for (bool reverse : {false, true}) {
+            int found = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < seeks; ++i) {
+                auto iter = indexer->iterator(reverse);
+                iter->seek(test_keys[(i * 7919) % NUM_KEYS]);
+                for (int j = 0; j < 10 && iter->valid(); ++j, iter->next()) {
+                    found += iter->key().empty() ? 0 : 1;
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            std::cout << "  Index " << static_cast<int>(type) << (reverse ? " reverse: " : " forward: ")
+                      << std::fixed << std::setprecision(2) << (double)duration.count() / seeks
+                      << " μs per open+seek+10 next" << std::endl;
+            EXPECT_GT(found, 0);
+        }
+        indexer->close();
+    }
+    utils::remove_directory(test_dir);
+}
+
+// 分页列举：每页用上一页最后一个key作为下界重新定位，只取limit个key
+TEST_F(BenchmarkTest, PaginatedRangeScan) {
+    Options options = Options::default_options();
+    options.dir_path = test_dir;
+    options.sync_writes = false;
+    
+    auto db = bitcask::open(options);
+    for (int i = 0; i < NUM_KEYS; ++i) {
+        db->put(test_keys[i], test_values[i]);
+    }
+    
+    const size_t page_size = 100;
+    IteratorOptions iter_options;
+    iter_options.limit = page_size;
+    int pages = 0;
+    int count = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    while (true) {
+        auto iter = db->iterator(iter_options);
+        if (!iter->valid()) {
+            break;
+        }
+        for (; iter->valid(); iter->next()) {
+            iter_options.lower_bound = iter->key();
+            count++;
+        }
+        iter_options.lower_bound.push_back(0x00);
+        pages++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    std::cout << "\nPaginated Range Scan (" << page_size << " keys per page):" << std::endl;
+    std::cout << "  Pages: " << pages << std::endl;
+    std::cout << "  Per page: " << std::fixed << std::setprecision(2)
+              << (double)duration.count() / pages << " μs" << std::endl;
+    
+    EXPECT_EQ(count, NUM_KEYS);
+    db->close();
+}
+
 // 不同数据大小的性能测试
 TEST_F(BenchmarkTest, VariableDataSizePerformance) {
     Options options = Options::default_options();
@@ -467,6 +543,529 @@ TEST_F(BenchmarkTest, ConcurrentPerformance) {
     db->close();
 }
 
+// 直接IO与标准文件IO对比测试
+TEST_F(BenchmarkTest, DirectIOVsFileIOPerformance) {
+    const std::vector<std::pair<std::string, IOType>> io_types = {
+        {"FileIO", IOType::STANDARD_FIO},
+        {"DirectIO", IOType::DIRECT_IO},
+    };
+    
+    for (const auto& [name, io_type] : io_types) {
+        utils::remove_directory(test_dir);
+        
+        Options options = Options::default_options();
+        options.dir_path = test_dir;
+        options.sync_writes = false;
+        options.mmap_at_startup = false;
+        options.io_type = io_type;
+        options.write_buffer_size = 64 * 1024; // 直接IO每次写整块，用追加缓冲区攒批
+        
+        auto db = bitcask::open(options);
+        
+        int operation_index = 0;
+        auto write_result = measure_performance([&]() {
+            db->put(test_keys[operation_index], test_values[operation_index]);
+            operation_index++;
+        }, NUM_KEYS);
+        print_benchmark_result(name + " Sequential Write", write_result);
+        
+        db->sync();
+        
+        operation_index = 0;
+        auto read_result = measure_performance([&]() {
+            int index = random_indices[operation_index];
+            EXPECT_EQ(db->get(test_keys[index]), test_values[index]);
+            operation_index++;
+        }, NUM_KEYS);
+        print_benchmark_result(name + " Random Read", read_result);
+        
+        db->close();
+    }
+    
+    auto& cache = DirectIOBlockCache::shared();
+    std::cout << "\nDirectIO Block Cache: " << cache.hits() << " hits, "
+              << cache.misses() << " misses" << std::endl;
+}
+
+// CRC32C吞吐量测试
+TEST_F(BenchmarkTest, Crc32cThroughput) {
+    const std::vector<size_t> value_sizes = {64, 256, 1024, 4096, 64 * 1024, 1024 * 1024};
+    const size_t TOTAL_BYTES = 256 * 1024 * 1024;
+    
+    std::mt19937 rng(42);
+    Bytes data(value_sizes.back());
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+    
+    auto measure_mbps = [&](size_t value_size, uint32_t (*fn)(uint32_t, const void*, size_t)) {
+        size_t iterations = TOTAL_BYTES / value_size;
+        uint32_t crc = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            crc = fn(crc, data.data(), value_size);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        EXPECT_NE(crc, 0xFFFFFFFFu);  // 防止循环被优化掉
+        double seconds = std::chrono::duration<double>(end - start).count();
+        return static_cast<double>(iterations * value_size) / (1024.0 * 1024.0) / seconds;
+    };
+    
+    std::cout << "\nCRC32C Throughput (" << crc32c::implementation() << "):" << std::endl;
+    for (size_t value_size : value_sizes) {
+        double hardware_mbps = measure_mbps(value_size, crc32c::extend);
+        double portable_mbps = measure_mbps(value_size, crc32c::extend_portable);
+        std::cout << "  Value Size " << value_size << " bytes: "
+                  << std::fixed << std::setprecision(2) << hardware_mbps << " MB/s (dispatched), "
+                  << portable_mbps << " MB/s (slicing-by-8)" << std::endl;
+    }
+}
+
+// 大value读取：get拷贝值，get_view直接指向封存文件的只读映射
+TEST_F(BenchmarkTest, LargeValueGetViewPerformance) {
+    const int num_values = 1000;
+    const size_t value_size = 64 * 1024;
+    
+    Options options = Options::default_options();
+    options.dir_path = test_dir;
+    options.sync_writes = false;
+    options.data_file_size = 8 * 1024 * 1024;
+    
+    auto db = bitcask::open(options);
+    Bytes value(value_size);
+    for (int i = 0; i < num_values; ++i) {
+        std::fill(value.begin(), value.end(), static_cast<uint8_t>(i));
+        db->put(test_keys[i], value);
+    }
+    db->sync();
+    
+    std::mt19937 rng(42);
+    uint64_t checksum = 0;
+    auto get_result = measure_performance([&]() {
+        Bytes v = db->get(test_keys[rng() % num_values]);
+        checksum += v[value_size / 2];
+    }, 20000);
+    print_benchmark_result("Large Value Get (64KB)", get_result);
+    
+    auto view_result = measure_performance([&]() {
+        ValueView v = db->get_view(test_keys[rng() % num_values]);
+        checksum += v.data()[value_size / 2];
+    }, 20000);
+    print_benchmark_result("Large Value GetView (64KB)", view_result);
+    
+    EXPECT_GT(checksum, 0u);
+    db->close();
+}
+
+// 热点key读取：对比启用和不启用值缓存
+TEST_F(BenchmarkTest, HotKeyValueCachePerformance) {
+    const int num_hot_keys = 100;
+    
+    for (uint64_t cache_size : {uint64_t(0), uint64_t(64 * 1024 * 1024)}) {
+        utils::remove_directory(test_dir);
+        Options options = Options::default_options();
+        options.dir_path = test_dir;
+        options.sync_writes = false;
+        options.value_cache_size = cache_size;
+        
+        auto db = bitcask::open(options);
+        for (int i = 0; i < NUM_KEYS; ++i) {
+            db->put(test_keys[i], test_values[i]);
+        }
+        
+        std::mt19937 rng(42);
+        auto result = measure_performance([&]() {
+            int index = static_cast<int>(rng() % num_hot_keys);
+            EXPECT_EQ(db->get(test_keys[index]).size(), test_values[index].size());
+        }, NUM_KEYS);
+        print_benchmark_result(cache_size == 0 ? "Hot Key Read (no cache)" : "Hot Key Read (value cache)", result);
+        
+        Stat stat = db->stat();
+        std::cout << "  Cache Hits: " << stat.value_cache_hits << ", Misses: " << stat.value_cache_misses << std::endl;
+        db->close();
+    }
+}
+
+// 启动时重建索引：串行扫描与多线程并发扫描数据文件对比
+TEST_F(BenchmarkTest, ParallelRecoveryOpenTime) {
+    Options options = Options::default_options();
+    options.dir_path = test_dir;
+    options.sync_writes = false;
+    options.data_file_size = 4 * 1024 * 1024;
+    options.data_file_hints = false;  // 只比较重放数据文件的耗时
+    
+    {
+        // key短于8字节：恢复时按非事务记录处理
+        auto db = bitcask::open(options);
+        for (int round = 0; round < 8; ++round) {
+            for (int i = 0; i < NUM_KEYS; ++i) {
+                Bytes key = {0x72, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+                db->put(key, test_values[(i + round) % NUM_KEYS]);
+            }
+        }
+        db->close();
+    }
+    
+    std::cout << "\nIndex Recovery Open Time:" << std::endl;
+    uint32_t serial_keys = 0;
+    for (uint32_t threads : {1u, 2u, 4u, 8u}) {
+        options.recovery_threads = threads;
+        auto start = std::chrono::high_resolution_clock::now();
+        auto db = bitcask::open(options);
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        Stat stat = db->stat();
+        if (threads == 1) {
+            serial_keys = stat.key_num;
+        }
+        EXPECT_EQ(stat.key_num, static_cast<uint32_t>(NUM_KEYS));
+        EXPECT_EQ(stat.key_num, serial_keys);
+        std::cout << "  " << threads << " thread(s): "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms ("
+                  << stat.data_file_num << " files, " << stat.key_num << " keys)" << std::endl;
+        db->close();
+    }
+}
+
+// 顺序扫描数据文件的吞吐
+TEST_F(BenchmarkTest, DataFileScanThroughput) {
+    utils::create_directory(test_dir);
+    auto data_file = DataFile::open_data_file(test_dir, 0, IOType::STANDARD_FIO);
+    data_file->enable_write_buffer(1024 * 1024);
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < NUM_KEYS; ++i) {
+            data_file->write(LogRecord(test_keys[i], test_values[i]));
+        }
+    }
+    data_file->seal();
+    const double num_records = 4.0 * NUM_KEYS;
+    
+    auto print_rate = [&](const std::string& name, std::chrono::high_resolution_clock::time_point start, uint64_t count) {
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        EXPECT_EQ(count, static_cast<uint64_t>(num_records));
+        std::cout << "  " << name << std::fixed << std::setprecision(0)
+                  << num_records / seconds << " records/sec" << std::endl;
+    };
+    
+    std::cout << "\nData File Scan Throughput (" << data_file->file_size() / 1024 / 1024 << " MB):" << std::endl;
+    
+    // 逐条read_log_record，以EOF异常结束
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t count = 0;
+    uint64_t offset = 0;
+    try {
+        while (true) {
+            offset += data_file->read_log_record(offset).size;
+            count++;
+        }
+    } catch (const ReadDataFileEOFError&) {
+    }
+    print_rate("read_log_record:        ", start, count);
+    
+    for (bool populate : {false, true}) {
+        ScannerOptions options;
+        options.map_populate = populate;
+        start = std::chrono::high_resolution_clock::now();
+        auto scanner = data_file->new_scanner(options);
+        ScannedRecord record;
+        count = 0;
+        while (scanner->next(record) == ScanStatus::OK) {
+            count++;
+        }
+        print_rate(populate ? "DataFileScanner (mmap): " : "DataFileScanner:        ", start, count);
+    }
+    data_file->close();
+}
+
+// 数据文件中间有大段损坏时的启动耗时
+TEST_F(BenchmarkTest, CorruptionResyncOpenTime) {
+    const uint64_t GARBAGE_SIZE = 4 * 1024 * 1024;
+    std::cout << "\nCorruption Resync Open Time (4 MB garbage):" << std::endl;
+    for (uint32_t interval : {0u, 64u * 1024}) {
+        utils::remove_directory(test_dir);
+        Options options = Options::default_options();
+        options.dir_path = test_dir;
+        options.sync_writes = false;
+        options.sync_marker_interval = interval;
+        
+        {
+            auto db = bitcask::open(options);
+            for (int round = 0; round < 4; ++round) {
+                for (int i = 0; i < NUM_KEYS; ++i) {
+                    Bytes key = {0x63, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+                    db->put(key, test_values[i]);
+                }
+            }
+            db->close();
+        }
+        
+        {
+            std::fstream file(DataFile::get_data_file_name(test_dir, 0), std::ios::in | std::ios::out | std::ios::binary);
+            std::mt19937 rng(11);
+            std::string garbage(GARBAGE_SIZE, '\0');
+            for (auto& c : garbage) {
+                c = static_cast<char>(rng());
+            }
+            file.seekp(8 * 1024 * 1024);
+            file.write(garbage.data(), garbage.size());
+        }
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        auto db = bitcask::open(options);
+        auto end = std::chrono::high_resolution_clock::now();
+        Stat stat = db->stat();
+        EXPECT_GE(stat.corrupted_bytes, GARBAGE_SIZE);
+        std::cout << "  " << (interval == 0 ? "No sync markers:   " : "64KB sync markers: ")
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms ("
+                  << stat.corrupted_ranges << " ranges, " << stat.corrupted_bytes << " bytes skipped)" << std::endl;
+        db->close();
+    }
+}
+
+// 提示文件启动耗时测试
+TEST_F(BenchmarkTest, HintFileOpenTime) {
+    Options options = Options::default_options();
+    options.dir_path = test_dir;
+    options.sync_writes = false;
+    options.data_file_size = 4 * 1024 * 1024;
+    options.recovery_threads = 1;
+    
+    uint32_t sealed_files = 0;
+    {
+        auto db = bitcask::open(options);
+        for (int round = 0; round < 8; ++round) {
+            for (int i = 0; i < NUM_KEYS; ++i) {
+                Bytes key = {0x68, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+                db->put(key, test_values[(i + round) % NUM_KEYS]);
+            }
+        }
+        sealed_files = db->stat().data_file_num - 1;
+        // 等后台为封存文件生成提示文件
+        for (int i = 0; i < 1000; ++i) {
+            uint32_t count = 0;
+            for (uint32_t fid = 0; fid < sealed_files; ++fid) {
+                count += utils::file_exists(DataFile::get_hint_file_name(test_dir, fid)) ? 1 : 0;
+            }
+            if (count == sealed_files) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        db->close();
+    }
+    
+    std::cout << "\nHint File Open Time (" << sealed_files << " sealed files):" << std::endl;
+    for (bool hints : {false, true}) {
+        options.data_file_hints = hints;
+        auto start = std::chrono::high_resolution_clock::now();
+        auto db = bitcask::open(options);
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        EXPECT_EQ(db->stat().key_num, static_cast<uint32_t>(NUM_KEYS));
+        std::cout << "  " << (hints ? "With hints:    " : "Replay data:   ")
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+        db->close();
+    }
+}
+
+// merge期间前台写入的延迟：merge只在最后安装结果时独占，写入不会被整个合并过程阻塞；
+// 限速后merge的读写分散到更长的时间里
+TEST_F(BenchmarkTest, PutLatencyDuringMerge) {
+    std::cout << "\nPut Latency During Merge:" << std::endl;
+    // 不限速，以及限速32MB/s并以200μs为前台延迟目标
+    for (uint64_t io_rate : {uint64_t(0), uint64_t(32 * 1024 * 1024)}) {
+        utils::remove_directory(test_dir);
+        Options options = Options::default_options();
+        options.dir_path = test_dir;
+        options.sync_writes = false;
+        options.data_file_size = 4 * 1024 * 1024;
+        options.data_file_merge_ratio = 0.0;
+        options.background_io_rate = io_rate;
+        options.background_io_latency_target_us = io_rate > 0 ? 200 : 0;
+        
+        auto db = bitcask::open(options);
+        for (int round = 0; round < 4; ++round) {
+            for (int i = 0; i < NUM_KEYS; ++i) {
+                Bytes key = {0x6d, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+                db->put(key, test_values[(i + round) % NUM_KEYS]);
+            }
+        }
+        
+        std::atomic<bool> merge_done{false};
+        auto merge_start = std::chrono::high_resolution_clock::now();
+        std::thread merge_thread([&]() {
+            db->merge();
+            merge_done = true;
+        });
+        
+        std::vector<double> latencies;
+        for (int i = 0; !merge_done.load(); ++i) {
+            Bytes key = {0x6d, static_cast<uint8_t>((i % NUM_KEYS) >> 16), static_cast<uint8_t>((i % NUM_KEYS) >> 8),
+                         static_cast<uint8_t>(i % NUM_KEYS)};
+            auto start = std::chrono::high_resolution_clock::now();
+            db->put(key, test_values[i % NUM_KEYS]);
+            auto end = std::chrono::high_resolution_clock::now();
+            latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        merge_thread.join();
+        auto merge_end = std::chrono::high_resolution_clock::now();
+        
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  IO Rate Limit: " << (io_rate ? std::to_string(io_rate >> 20) + " MB/s" : "unlimited") << std::endl;
+        std::cout << "    Merge Time: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(merge_end - merge_start).count() << " ms" << std::endl;
+        std::cout << "    Puts During Merge: " << latencies.size() << std::endl;
+        if (!latencies.empty()) {
+            std::cout << "    P99 Latency: " << std::fixed << std::setprecision(2)
+                      << latencies[static_cast<size_t>(latencies.size() * 0.99)] << " μs" << std::endl;
+            std::cout << "    Max Latency: " << std::fixed << std::setprecision(2) << latencies.back() << " μs" << std::endl;
+        }
+        EXPECT_EQ(db->stat().key_num, static_cast<uint32_t>(NUM_KEYS));
+        db->close();
+    }
+}
+
+// 按文件选择性merge：大部分文件只有零星的失效数据，只重写失效比例高的文件
+TEST_F(BenchmarkTest, SelectiveMergeWriteAmplification) {
+    std::cout << "\nSelective Merge Write Amplification:" << std::endl;
+    for (float garbage_ratio : {0.0f, 0.5f}) {
+        utils::remove_directory(test_dir);
+        Options options = Options::default_options();
+        options.dir_path = test_dir;
+        options.sync_writes = false;
+        options.data_file_size = 1024 * 1024;
+        options.data_file_merge_ratio = 0.0;
+        options.merge_file_garbage_ratio = garbage_ratio;
+        
+        auto db = bitcask::open(options);
+        for (int i = 0; i < NUM_KEYS; ++i) {
+            Bytes key = {0x73, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+            db->put(key, test_values[i]);
+        }
+        // 少量热点key反复改写：旧文件中各有零星失效，改写产生的文件几乎全部失效
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 1000; ++i) {
+                Bytes key = {0x73, static_cast<uint8_t>((i * 50) >> 16), static_cast<uint8_t>((i * 50) >> 8),
+                             static_cast<uint8_t>(i * 50)};
+                db->put(key, test_values[(i + round) % NUM_KEYS]);
+            }
+        }
+        
+        uint64_t rewritten = 0;
+        for (const auto& file_stat : db->data_file_stats()) {
+            if (file_stat.dead_bytes > 0 && file_stat.garbage_ratio() >= garbage_ratio) {
+                rewritten += file_stat.size;
+            }
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        db->merge();
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        EXPECT_EQ(db->stat().key_num, static_cast<uint32_t>(NUM_KEYS));
+        std::cout << "  File garbage ratio >= " << std::fixed << std::setprecision(1) << garbage_ratio
+                  << ": rewrote " << rewritten / 1024 << " KB in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms, "
+                  << "reclaimable left " << db->stat().reclaimable_size / 1024 << " KB" << std::endl;
+        db->close();
+    }
+}
+
+// 增量备份：第二次备份只处理变化的文件，旧文件在同一文件系统上直接硬链接
+TEST_F(BenchmarkTest, IncrementalBackup) {
+    Options options = Options::default_options();
+    options.dir_path = test_dir;
+    options.sync_writes = false;
+    options.data_file_size = 1024 * 1024;
+    std::string backup_dir = test_dir + "_backup";
+    utils::remove_directory(backup_dir);
+    
+    auto db = bitcask::open(options);
+    for (int i = 0; i < NUM_KEYS; ++i) {
+        Bytes key = {0x62, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+        db->put(key, test_values[i]);
+    }
+    
+    std::cout << "\nIncremental Backup (" << db->stat().data_file_num << " data files):" << std::endl;
+    for (int round = 0; round < 2; ++round) {
+        // 第二轮前只改写少量key
+        for (int i = 0; round > 0 && i < 1000; ++i) {
+            Bytes key = {0x62, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+            db->put(key, test_values[(i + 1) % NUM_KEYS]);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        db->backup(backup_dir);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << (round == 0 ? "Full backup:        " : "Incremental backup: ")
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " μs" << std::endl;
+    }
+    db->close();
+    
+    Options backup_options = options;
+    backup_options.dir_path = backup_dir;
+    auto restored = bitcask::open(backup_options);
+    EXPECT_EQ(restored->stat().key_num, static_cast<uint32_t>(NUM_KEYS));
+    restored->close();
+    utils::remove_directory(backup_dir);
+}
+
+// 检查点期间前台写入的延迟：写入只在记录活跃文件长度时暂停，文件的链接和复制在锁外进行
+TEST_F(BenchmarkTest, PutLatencyDuringCheckpoint) {
+    Options options = Options::default_options();
+    options.dir_path = test_dir;
+    options.sync_writes = false;
+    options.data_file_size = 4 * 1024 * 1024;
+    std::string checkpoint_dir = test_dir + "_checkpoint";
+    utils::remove_directory(checkpoint_dir);
+    
+    auto db = bitcask::open(options);
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < NUM_KEYS; ++i) {
+            Bytes key = {0x63, static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+            db->put(key, test_values[(i + round) % NUM_KEYS]);
+        }
+    }
+    
+    std::atomic<bool> checkpoint_done{false};
+    auto checkpoint_start = std::chrono::high_resolution_clock::now();
+    std::thread checkpoint_thread([&]() {
+        db->checkpoint(checkpoint_dir);
+        checkpoint_done = true;
+    });
+    
+    std::vector<double> latencies;
+    for (int i = 0; !checkpoint_done.load(); ++i) {
+        Bytes key = {0x63, static_cast<uint8_t>((i % NUM_KEYS) >> 16), static_cast<uint8_t>((i % NUM_KEYS) >> 8),
+                     static_cast<uint8_t>(i % NUM_KEYS)};
+        auto start = std::chrono::high_resolution_clock::now();
+        db->put(key, test_values[i % NUM_KEYS]);
+        auto end = std::chrono::high_resolution_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    checkpoint_thread.join();
+    auto checkpoint_end = std::chrono::high_resolution_clock::now();
+    
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "\nPut Latency During Checkpoint:" << std::endl;
+    std::cout << "  Checkpoint Time: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(checkpoint_end - checkpoint_start).count()
+              << " μs" << std::endl;
+    std::cout << "  Puts During Checkpoint: " << latencies.size() << std::endl;
+    if (!latencies.empty()) {
+        std::cout << "  P99 Latency: " << std::fixed << std::setprecision(2)
+                  << latencies[static_cast<size_t>(latencies.size() * 0.99)] << " μs" << std::endl;
+        std::cout << "  Max Latency: " << std::fixed << std::setprecision(2) << latencies.back() << " μs" << std::endl;
+    }
+    db->close();
+    
+    Options checkpoint_options = options;
+    checkpoint_options.dir_path = checkpoint_dir;
+    auto snapshot = bitcask::open(checkpoint_options);
+    EXPECT_EQ(snapshot->stat().key_num, static_cast<uint32_t>(NUM_KEYS));
+    snapshot->close();
+    utils::remove_directory(checkpoint_dir);
+}
+
 // 内存使用性能测试
 TEST_F(BenchmarkTest, MemoryUsageTest) {
     Options options = Options::default_options();
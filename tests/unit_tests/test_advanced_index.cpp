@@ -6,6 +6,7 @@
 #include "bitcask/art_index.h"
 #include <random>
 #include <algorithm>
+#include <fstream>
 
 namespace bitcask {
 namespace test {
@@ -267,6 +268,61 @@ TEST_F(BPlusTreeIndexTest, LargeDataSet) {
     EXPECT_EQ(keys.size(), DATA_SIZE);
 }
 
+// 多层B+树上反向迭代：从索引文件加载一棵手工构造的树，中间有一个删空的叶子
+TEST_F(BPlusTreeIndexTest, ReverseIterationAcrossLeaves) {
+    index_.reset();
+    {
+        std::ofstream file(temp_dir_ + "/bptree-index.db", std::ios::binary | std::ios::trunc);
+        auto write_u32 = [&](uint32_t v) { file.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+        auto write_node = [&](BPlusNodeType type, const std::vector<std::string>& keys) {
+            uint8_t t = static_cast<uint8_t>(type);
+            file.write(reinterpret_cast<const char*>(&t), sizeof(t));
+            write_u32(static_cast<uint32_t>(keys.size()));
+            for (const auto& key : keys) {
+                write_u32(static_cast<uint32_t>(key.size()));
+                file.write(key.data(), key.size());
+            }
+            if (type == BPlusNodeType::LEAF) {
+                for (const auto& key : keys) {
+                    write_u32(1);
+                    uint64_t offset = static_cast<uint64_t>(key[0]);
+                    file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+                    write_u32(10);
+                }
+            }
+        };
+        // 根["b","f"] -> 叶子[a,b]，内部节点["d"] -> (空叶子，叶子[e,f])，叶子[g,h]
+        write_node(BPlusNodeType::INTERNAL, {"b", "f"});
+        write_node(BPlusNodeType::LEAF, {"a", "b"});
+        write_node(BPlusNodeType::INTERNAL, {"d"});
+        write_node(BPlusNodeType::LEAF, {});
+        write_node(BPlusNodeType::LEAF, {"e", "f"});
+        write_node(BPlusNodeType::LEAF, {"g", "h"});
+    }
+    index_ = std::make_unique<BPlusTreeIndex>(temp_dir_);
+
+    auto iter = index_->iterator(true);
+    std::string seen;
+    for (; iter->valid(); iter->next()) {
+        seen += bytes_to_string(iter->key());
+        EXPECT_EQ(iter->value().offset, static_cast<uint64_t>(iter->key()[0]));
+    }
+    EXPECT_EQ(seen, "hgfeba");
+
+    // 定位到空叶子时退到前面的叶子
+    iter->seek(string_to_bytes("d"));
+    ASSERT_TRUE(iter->valid());
+    EXPECT_EQ(bytes_to_string(iter->key()), "b");
+    iter->seek(string_to_bytes("e"));
+    ASSERT_TRUE(iter->valid());
+    EXPECT_EQ(bytes_to_string(iter->key()), "e");
+    iter->next();
+    ASSERT_TRUE(iter->valid());
+    EXPECT_EQ(bytes_to_string(iter->key()), "b");
+    iter->seek(string_to_bytes("0"));
+    EXPECT_FALSE(iter->valid());
+}
+
 // 数据库使用高级索引的集成测试
 class DatabaseAdvancedIndexTest : public AdvancedIndexTest {
 protected:
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "bitcask/art_index.h"
 #include "bitcask/common.h"
+#include <algorithm>
 
 namespace bitcask {
 
@@ -261,15 +262,21 @@ TEST_F(ARTIndexTest, IteratorWithPrefix) {
         art_index->put(key, pos);
     }
     
-    // 创建带前缀的迭代器选项
-    IteratorOptions options;
-    options.prefix = {'a', 'b'};
-    
-    std::shared_ptr<ARTNode> null_node = nullptr;
-    auto iter = std::make_unique<ARTIterator>(null_node, options);
+    // 定位到前缀处，依次取出以前缀开头的key
+    Bytes prefix = {'a', 'b'};
+    auto iter = art_index->iterator(false);
+    std::vector<Bytes> keys;
+    for (iter->seek(prefix); iter->valid(); iter->next()) {
+        const Bytes& key = iter->key();
+        if (key.size() < prefix.size() || !std::equal(prefix.begin(), prefix.end(), key.begin())) {
+            break;
+        }
+        keys.push_back(key);
+    }
     
-    // 注意：这里的测试有限，因为我们无法直接访问根节点
-    // 在实际使用中，会通过ARTIndex::iterator方法创建迭代器
+    ASSERT_EQ(keys.size(), 2u);
+    EXPECT_EQ(keys[0], test_data[0].first);
+    EXPECT_EQ(keys[1], test_data[1].first);
 }
 
 TEST_F(ARTIndexTest, LargeDataset) {
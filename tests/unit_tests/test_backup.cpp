@@ -1,10 +1,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "bitcask/bitcask.h"
+#include "bitcask/utils.h"
 #include <thread>
+#include <atomic>
 #include <chrono>
 #include <random>
 #include <fstream>
+#include <map>
 
 namespace bitcask {
 namespace test {
@@ -331,5 +334,333 @@ TEST_F(BackupTest, EmptyDatabaseBackup) {
     backup_db->close();
 }
 
+// 打开备份读回所有key：长key、末尾像序列号的key、事务写入的key都要恢复
+TEST_F(BackupTest, RestoredBackupReadsKeysBack) {
+    options_.data_file_size = 4 * 1024;
+    options_.data_file_merge_ratio = 0.0;
+    std::map<std::string, std::string> expected;
+    {
+        auto db = DB::open(options_);
+        for (int i = 0; i < 200; ++i) {
+            std::string key = "restore_key_" + std::to_string(i);
+            expected[key] = "value_" + std::to_string(i);
+            db->put(string_to_bytes(key), string_to_bytes(expected[key]));
+        }
+        // 最后8个字节是非零的小端整数，不能被当成事务序列号
+        std::string seq_like = std::string("k") + std::string("\x05\0\0\0\0\0\0\0", 8);
+        expected[seq_like] = "seq_like";
+        db->put(string_to_bytes(seq_like), string_to_bytes("seq_like"));
+        db->remove(string_to_bytes("restore_key_7"));
+        expected.erase("restore_key_7");
+        
+        auto batch = db->new_write_batch(WriteBatchOptions::default_options());
+        for (int i = 0; i < 50; ++i) {
+            std::string key = "batch_key_" + std::to_string(i);
+            expected[key] = "batch_value_" + std::to_string(i);
+            batch->put(string_to_bytes(key), string_to_bytes(expected[key]));
+        }
+        batch->commit();
+        
+        db->backup(backup_dir_);
+        db->close();
+    }
+    
+    Options backup_options = options_;
+    backup_options.dir_path = backup_dir_;
+    auto backup_db = DB::open(backup_options);
+    EXPECT_EQ(backup_db->list_keys().size(), expected.size());
+    for (const auto& [key, value] : expected) {
+        EXPECT_EQ(bytes_to_string(backup_db->get(string_to_bytes(key))), value);
+    }
+    EXPECT_THROW(backup_db->get(string_to_bytes("restore_key_7")), KeyNotFoundError);
+    
+    // 合并后的备份同样能读回
+    backup_db->merge();
+    backup_db->close();
+    backup_db = DB::open(backup_options);
+    EXPECT_EQ(backup_db->list_keys().size(), expected.size());
+    EXPECT_EQ(bytes_to_string(backup_db->get(string_to_bytes("batch_key_3"))), "batch_value_3");
+    backup_db->close();
+}
+
+// 测试增量备份：没变的旧文件跳过，同一文件系统上用硬链接，merge掉的文件从备份中删除
+TEST_F(BackupTest, IncrementalBackup) {
+    options_.data_file_size = 8 * 1024;
+    options_.sync_writes = false;
+    options_.data_file_merge_ratio = 0.0;
+    auto db = DB::open(options_);
+    
+    auto data_file = [](const std::string& dir, uint32_t fid) {
+        return DataFile::get_data_file_name(dir, fid);
+    };
+    auto sealed_fids = [&]() {
+        std::vector<uint32_t> fids;
+        for (const auto& file_stat : db->data_file_stats()) {
+            fids.push_back(file_stat.file_id);
+        }
+        fids.pop_back();
+        return fids;
+    };
+    
+    for (int i = 0; i < 1000; ++i) {
+        db->put(string_to_bytes("a" + std::to_string(i)), string_to_bytes("value_a" + std::to_string(i)));
+    }
+    db->backup(backup_dir_);
+    auto first_sealed = sealed_fids();
+    ASSERT_GT(first_sealed.size(), 1u);
+    for (uint32_t fid : first_sealed) {
+        EXPECT_TRUE(utils::same_file(data_file(temp_dir_, fid), data_file(backup_dir_, fid)));
+    }
+    
+    // 第二次备份时已有的旧文件保持不变
+    for (int i = 0; i < 1000; ++i) {
+        db->put(string_to_bytes("b" + std::to_string(i)), string_to_bytes("value_b" + std::to_string(i)));
+    }
+    for (int i = 0; i < 500; ++i) {
+        db->remove(string_to_bytes("a" + std::to_string(i)));
+    }
+    db->backup(backup_dir_);
+    for (uint32_t fid : sealed_fids()) {
+        EXPECT_TRUE(utils::same_file(data_file(temp_dir_, fid), data_file(backup_dir_, fid)));
+    }
+    
+    // merge重写和删除文件后，备份中的文件跟着替换和删除
+    db->merge();
+    db->backup(backup_dir_);
+    std::vector<uint32_t> fids;
+    for (const auto& file_stat : db->data_file_stats()) {
+        fids.push_back(file_stat.file_id);
+    }
+    EXPECT_EQ(DataFile::list_data_file_ids(backup_dir_), fids);
+    for (uint32_t fid : first_sealed) {
+        if (std::find(fids.begin(), fids.end(), fid) != fids.end()) {
+            EXPECT_TRUE(utils::same_file(data_file(temp_dir_, fid), data_file(backup_dir_, fid)));
+        }
+    }
+    
+    // 复制到硬链接上不会改动源文件
+    uint32_t linked_fid = sealed_fids().front();
+    struct stat before;
+    ASSERT_EQ(stat(data_file(temp_dir_, linked_fid).c_str(), &before), 0);
+    utils::copy_file(data_file(temp_dir_, linked_fid), data_file(backup_dir_, linked_fid));
+    struct stat after;
+    ASSERT_EQ(stat(data_file(temp_dir_, linked_fid).c_str(), &after), 0);
+    EXPECT_EQ(after.st_size, before.st_size);
+    EXPECT_FALSE(utils::same_file(data_file(temp_dir_, linked_fid), data_file(backup_dir_, linked_fid)));
+    db->close();
+    
+    Options backup_options = options_;
+    backup_options.dir_path = backup_dir_;
+    auto restored_db = DB::open(backup_options);
+    for (int i = 0; i < 1000; ++i) {
+        std::string a_key = "a" + std::to_string(i);
+        if (i < 500) {
+            EXPECT_THROW(restored_db->get(string_to_bytes(a_key)), KeyNotFoundError);
+        } else {
+            EXPECT_EQ(bytes_to_string(restored_db->get(string_to_bytes(a_key))), "value_" + a_key);
+        }
+        EXPECT_EQ(bytes_to_string(restored_db->get(string_to_bytes("b" + std::to_string(i)))),
+                  "value_b" + std::to_string(i));
+    }
+    restored_db->close();
+}
+
+// 测试备份中的文件不是硬链接时（如跨文件系统备份）：提示文件记录的整个文件CRC相同才跳过，否则重新复制
+TEST_F(BackupTest, IncrementalBackupComparesHintChecksums) {
+    options_.data_file_size = 8 * 1024;
+    options_.sync_writes = false;
+    options_.data_file_hints = true;
+    auto db = DB::open(options_);
+    for (int i = 0; i < 1000; ++i) {
+        db->put(string_to_bytes("a" + std::to_string(i)), string_to_bytes("value_a" + std::to_string(i)));
+    }
+    std::vector<uint32_t> sealed;
+    for (const auto& file_stat : db->data_file_stats()) {
+        sealed.push_back(file_stat.file_id);
+    }
+    sealed.pop_back();
+    ASSERT_GE(sealed.size(), 2u);
+    
+    // 等后台为所有封存文件生成提示文件
+    auto hints_ready = [&]() {
+        for (uint32_t fid : sealed) {
+            if (!utils::file_exists(DataFile::get_hint_file_name(temp_dir_, fid))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (int i = 0; i < 500 && !hints_ready(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(hints_ready());
+    db->backup(backup_dir_);
+    
+    // 把备份中的数据文件换成独立的副本
+    auto inode = [](const std::string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 ? st.st_ino : 0;
+    };
+    std::vector<ino_t> copied_inodes;
+    for (uint32_t fid : sealed) {
+        std::string src = DataFile::get_data_file_name(temp_dir_, fid);
+        std::string dst = DataFile::get_data_file_name(backup_dir_, fid);
+        ASSERT_TRUE(utils::same_file(src, dst));
+        utils::copy_file(src, dst);
+        copied_inodes.push_back(inode(dst));
+    }
+    // 第一个文件的源提示文件不存在（如merge重写后还没生成），无法确认时重新链接
+    std::remove(DataFile::get_hint_file_name(temp_dir_, sealed[0]).c_str());
+    
+    db->backup(backup_dir_);
+    EXPECT_TRUE(utils::same_file(DataFile::get_data_file_name(temp_dir_, sealed[0]),
+                                 DataFile::get_data_file_name(backup_dir_, sealed[0])));
+    for (size_t i = 1; i < sealed.size(); ++i) {
+        EXPECT_EQ(inode(DataFile::get_data_file_name(backup_dir_, sealed[i])), copied_inodes[i]);
+    }
+    db->close();
+    
+    Options backup_options = options_;
+    backup_options.dir_path = backup_dir_;
+    auto restored_db = DB::open(backup_options);
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "a" + std::to_string(i);
+        EXPECT_EQ(bytes_to_string(restored_db->get(string_to_bytes(key))), "value_" + key);
+    }
+    restored_db->close();
+}
+
+// 测试并发写入时备份：只包含备份时已完成的写入，每个写入线程的键都是从0开始的连续前缀
+TEST_F(BackupTest, BackupDuringConcurrentWrites) {
+    options_.sync_writes = false;
+    auto db = DB::open(options_);
+    
+    const int thread_count = 4;
+    std::atomic<bool> stop{false};
+    std::vector<std::atomic<int>> written(thread_count);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < thread_count; ++t) {
+        written[t] = 0;
+        writers.emplace_back([&, t]() {
+            std::string prefix(1, static_cast<char>('p' + t));
+            for (int i = 0; !stop.load(); ++i) {
+                db->put(string_to_bytes(prefix + std::to_string(i)), string_to_bytes("v" + std::to_string(i)));
+                written[t] = i + 1;
+            }
+        });
+    }
+    for (int t = 0; t < thread_count; ++t) {
+        while (written[t].load() < 100) {
+            std::this_thread::yield();
+        }
+    }
+    db->backup(backup_dir_);
+    std::vector<int> written_at_backup(thread_count);
+    for (int t = 0; t < thread_count; ++t) {
+        written_at_backup[t] = written[t].load();
+    }
+    stop = true;
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    db->close();
+    
+    Options backup_options = options_;
+    backup_options.dir_path = backup_dir_;
+    auto restored_db = DB::open(backup_options);
+    for (int t = 0; t < thread_count; ++t) {
+        std::string prefix(1, static_cast<char>('p' + t));
+        int present = 0;
+        while (true) {
+            try {
+                Bytes value = restored_db->get(string_to_bytes(prefix + std::to_string(present)));
+                EXPECT_EQ(bytes_to_string(value), "v" + std::to_string(present));
+                present++;
+            } catch (const KeyNotFoundError&) {
+                break;
+            }
+        }
+        EXPECT_GE(present, 100);
+        EXPECT_LE(present, written_at_backup[t] + 1);
+        EXPECT_THROW(restored_db->get(string_to_bytes(prefix + std::to_string(present + 1))), KeyNotFoundError);
+    }
+    restored_db->close();
+}
+
+// 测试检查点：并发写入时生成的时间点快照可以直接打开，之后的写入和merge不影响它
+TEST_F(BackupTest, CheckpointIsPointInTimeSnapshot) {
+    options_.data_file_size = 8 * 1024;
+    options_.sync_writes = false;
+    options_.data_file_merge_ratio = 0.0;
+    auto db = DB::open(options_);
+    
+    for (int i = 0; i < 1000; ++i) {
+        db->put(string_to_bytes("a" + std::to_string(i)), string_to_bytes("old_a" + std::to_string(i)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        db->remove(string_to_bytes("a" + std::to_string(i)));
+    }
+    
+    // 单个写入线程按顺序写入，快照中的w键必须是从0开始的连续前缀
+    std::atomic<bool> stop{false};
+    std::atomic<int> written{0};
+    std::thread writer([&]() {
+        for (int i = 0; !stop.load(); ++i) {
+            db->put(string_to_bytes("w" + std::to_string(i)), string_to_bytes("w"));
+            written = i + 1;
+        }
+    });
+    while (written.load() < 200) {
+        std::this_thread::yield();
+    }
+    db->checkpoint(backup_dir_);
+    int written_at_checkpoint = written.load();
+    stop = true;
+    writer.join();
+    int written_total = written.load();
+    EXPECT_THROW(db->checkpoint(backup_dir_), BitcaskException);
+    
+    // 检查点之后的改写和merge
+    for (int i = 0; i < 1000; ++i) {
+        db->put(string_to_bytes("a" + std::to_string(i)), string_to_bytes("new_a" + std::to_string(i)));
+    }
+    db->merge();
+    db->close();
+    
+    Options checkpoint_options = options_;
+    checkpoint_options.dir_path = backup_dir_;
+    auto snapshot = DB::open(checkpoint_options);
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "a" + std::to_string(i);
+        if (i < 100) {
+            EXPECT_THROW(snapshot->get(string_to_bytes(key)), KeyNotFoundError);
+        } else {
+            EXPECT_EQ(bytes_to_string(snapshot->get(string_to_bytes(key))), "old_" + key);
+        }
+    }
+    // 写入线程在put返回后才更新计数，快照最多比记下的计数多一条
+    int present = 0;
+    while (true) {
+        try {
+            snapshot->get(string_to_bytes("w" + std::to_string(present)));
+            present++;
+        } catch (const KeyNotFoundError&) {
+            break;
+        }
+    }
+    EXPECT_GE(present, 200);
+    EXPECT_LE(present, written_at_checkpoint + 1);
+    for (int i = present; i < written_total; ++i) {
+        EXPECT_THROW(snapshot->get(string_to_bytes("w" + std::to_string(i))), KeyNotFoundError);
+    }
+    
+    // 检查点作为普通数据库继续写入
+    snapshot->put(string_to_bytes("z"), string_to_bytes("after"));
+    snapshot->close();
+    snapshot = DB::open(checkpoint_options);
+    EXPECT_EQ(bytes_to_string(snapshot->get(string_to_bytes("z"))), "after");
+    snapshot->close();
+}
+
 }  // namespace test
 }  // namespace bitcask
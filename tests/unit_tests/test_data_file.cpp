@@ -2,6 +2,10 @@
 #include <gmock/gmock.h>
 #include "bitcask/data_file.h"
 #include "bitcask/utils.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
 
 using namespace bitcask;
 
@@ -61,6 +65,86 @@ TEST_F(DataFileTest, WriteAndReadLogRecord) {
     data_file->close();
 }
 
+TEST_F(DataFileTest, ReadLogRecordWithKnownSize) {
+    auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
+    
+    auto [encoded_data, size] = test_record.encode();
+    data_file->write(encoded_data);
+    uint64_t reserved = data_file->reserve(size);
+    data_file->write_at(reserved, test_record);
+    
+    // 写缓冲区中尚未落盘的记录也能按长度读出
+    data_file->enable_write_buffer(4096);
+    data_file->write(encoded_data);
+    
+    for (uint64_t offset : {uint64_t(0), reserved, reserved + size}) {
+        ReadLogRecord read_record = data_file->read_log_record(offset, static_cast<uint32_t>(size));
+        EXPECT_EQ(read_record.record.key, test_key);
+        EXPECT_EQ(read_record.record.value, test_value);
+        EXPECT_EQ(read_record.size, size);
+    }
+    EXPECT_EQ(data_file->file_size(), 3 * size);
+    
+    // 长度与记录不符或越过文件末尾都视为错误
+    EXPECT_THROW(data_file->read_log_record(0, static_cast<uint32_t>(size - 1)), BitcaskException);
+    EXPECT_THROW(data_file->read_log_record(2 * size, static_cast<uint32_t>(size + 1)), ReadDataFileEOFError);
+    
+    data_file->close();
+}
+
+TEST_F(DataFileTest, ConcurrentReadsWhileAppending) {
+    // 读线程读取已写入的记录（包括仍在追加缓冲区中的），写线程继续追加
+    auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
+    data_file->enable_write_buffer(1024);
+    
+    auto [encoded_data, size] = test_record.encode();
+    const int total = 2000;
+    std::atomic<int> written{0};
+    std::atomic<int> errors{0};
+    
+    std::thread writer([&]() {
+        for (int i = 0; i < total; ++i) {
+            data_file->write(encoded_data);
+            written.store(i + 1, std::memory_order_release);
+        }
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&, r]() {
+            uint32_t n = static_cast<uint32_t>(r);
+            while (written.load(std::memory_order_acquire) < total) {
+                int count = written.load(std::memory_order_acquire);
+                if (count == 0) {
+                    continue;
+                }
+                n = n * 1103515245 + 12345;
+                uint64_t offset = static_cast<uint64_t>(n % count) * size;
+                try {
+                    if (data_file->read_log_record(offset, static_cast<uint32_t>(size)).record.value != test_value ||
+                        data_file->read_log_record(offset).record.key != test_key) {
+                        errors++;
+                    }
+                } catch (...) {
+                    errors++;
+                }
+            }
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+    
+    // 封存后缓冲区已刷出，全部记录都能读到
+    data_file->seal();
+    EXPECT_EQ(data_file->file_size(), total * size);
+    EXPECT_EQ(data_file->read_log_record((total - 1) * size).record.value, test_value);
+    EXPECT_THROW(data_file->read_log_record(total * size), ReadDataFileEOFError);
+    
+    data_file->close();
+}
+
 TEST_F(DataFileTest, MultipleRecords) {
     auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
     
@@ -111,6 +195,105 @@ TEST_F(DataFileTest, WriteHintRecord) {
     data_file->close();
 }
 
+TEST_F(DataFileTest, WriteLogRecordScatterGather) {
+    auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
+    
+    // 直接写入日志记录，与先编码再写入的结果一致
+    size_t written = data_file->write(test_record);
+    EXPECT_EQ(written, test_record.encoded_size());
+    
+    LogRecord deleted_record(test_key, Bytes{}, LogRecordType::DELETED);
+    data_file->write(deleted_record);
+    
+    ReadLogRecord first = data_file->read_log_record(0);
+    EXPECT_EQ(first.record.key, test_key);
+    EXPECT_EQ(first.record.value, test_value);
+    EXPECT_EQ(first.size, written);
+    
+    ReadLogRecord second = data_file->read_log_record(written);
+    EXPECT_EQ(second.record.key, test_key);
+    EXPECT_TRUE(second.record.value.empty());
+    EXPECT_EQ(second.record.type, LogRecordType::DELETED);
+    
+    data_file->close();
+}
+
+TEST_F(DataFileTest, WriteBufferReadYourWrites) {
+    auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
+    data_file->enable_write_buffer(4096);
+    
+    size_t record_size = test_record.encoded_size();
+    data_file->write(test_record);
+    data_file->write(test_record);
+    EXPECT_EQ(data_file->get_write_off(), record_size * 2);
+    
+    // 数据还在缓冲区中，文件本身为空
+    std::string file_name = DataFile::get_data_file_name(test_dir, 1);
+    auto raw_io = create_io_manager(file_name, IOType::STANDARD_FIO);
+    EXPECT_EQ(raw_io->size(), 0);
+    
+    // 未刷出的数据可以被读到
+    ReadLogRecord second = data_file->read_log_record(record_size);
+    EXPECT_EQ(second.record.key, test_key);
+    EXPECT_EQ(second.record.value, test_value);
+    
+    // sync先刷出缓冲区
+    data_file->sync();
+    EXPECT_EQ(static_cast<size_t>(raw_io->size()), record_size * 2);
+    
+    // 一部分在文件中、一部分在缓冲区中的记录同样可以读到
+    data_file->write(test_record);
+    ReadLogRecord third = data_file->read_log_record(record_size * 2);
+    EXPECT_EQ(third.record.key, test_key);
+    EXPECT_EQ(third.record.value, test_value);
+    
+    // 超过缓冲区容量的记录直接写入文件
+    LogRecord large_record(test_key, Bytes(8192, 0x42), LogRecordType::NORMAL);
+    data_file->write(large_record);
+    EXPECT_EQ(static_cast<size_t>(raw_io->size()), data_file->get_write_off());
+    ReadLogRecord large = data_file->read_log_record(record_size * 3);
+    EXPECT_EQ(large.record.value.size(), 8192u);
+    
+    raw_io->close();
+    data_file->close();
+}
+
+TEST_F(DataFileTest, ReadLogRecordsBatch) {
+    for (IOType io_type : {IOType::STANDARD_FIO, IOType::IO_URING}) {
+        utils::remove_directory(test_dir);
+        utils::create_directory(test_dir);
+        auto data_file = DataFile::open_data_file(test_dir, 1, io_type);
+        
+        std::vector<LogRecordPos> positions;
+        for (int i = 0; i < 50; ++i) {
+            LogRecord record(Bytes{static_cast<uint8_t>(i)}, Bytes(i + 1, static_cast<uint8_t>(i)), LogRecordType::NORMAL);
+            uint64_t offset = data_file->get_write_off();
+            size_t size = data_file->write(record);
+            positions.emplace_back(1, offset, static_cast<uint32_t>(size));
+        }
+        // 倒序读取，最后几条还在追加缓冲区中
+        data_file->enable_write_buffer(4096);
+        LogRecord buffered(Bytes{0xFF}, Bytes{0x01, 0x02}, LogRecordType::DELETED);
+        uint64_t buffered_off = data_file->get_write_off();
+        size_t buffered_size = data_file->write(buffered);
+        positions.emplace_back(1, buffered_off, static_cast<uint32_t>(buffered_size));
+        std::reverse(positions.begin(), positions.end());
+        
+        auto records = data_file->read_log_records(positions);
+        ASSERT_EQ(records.size(), positions.size());
+        EXPECT_EQ(records[0].record.key, Bytes{0xFF});
+        EXPECT_EQ(records[0].record.type, LogRecordType::DELETED);
+        for (size_t j = 1; j < records.size(); ++j) {
+            int i = static_cast<int>(50 - j);
+            EXPECT_EQ(records[j].size, positions[j].size);
+            EXPECT_EQ(records[j].record.key, Bytes{static_cast<uint8_t>(i)});
+            EXPECT_EQ(records[j].record.value, Bytes(i + 1, static_cast<uint8_t>(i)));
+        }
+        
+        data_file->close();
+    }
+}
+
 TEST_F(DataFileTest, SyncOperation) {
     auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
     
@@ -225,6 +408,153 @@ TEST_F(DataFileErrorTest, CorruptedData) {
     data_file->close();
 }
 
+TEST_F(DataFileErrorTest, CorruptedValueByte) {
+    auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
+    
+    LogRecord record({0x74, 0x65, 0x73, 0x74}, {0x76, 0x61, 0x6c, 0x75, 0x65}, LogRecordType::NORMAL);
+    auto [encoded_data, size] = record.encode();
+    data_file->write(encoded_data);
+    EXPECT_EQ(data_file->read_log_record(0).record.value, record.value);
+    
+    // 翻转value中的一位，CRC校验应失败
+    encoded_data[size - 1] ^= 0x01;
+    data_file->write(encoded_data);
+    EXPECT_THROW(data_file->read_log_record(size), InvalidCRCError);
+    
+    // 只写了一部分的记录视为文件结束
+    Bytes partial(encoded_data.begin(), encoded_data.begin() + size - 2);
+    data_file->write(partial);
+    EXPECT_THROW(data_file->read_log_record(2 * size), ReadDataFileEOFError);
+    
+    data_file->close();
+}
+
+TEST_F(DataFileErrorTest, ScannerReportsCorruptionAndTornTail) {
+    auto data_file = DataFile::open_data_file(test_dir, 1, IOType::STANDARD_FIO);
+    data_file->enable_write_buffer(4096);
+    
+    // 大小不一的记录，部分超过扫描缓冲区
+    std::vector<LogRecord> records;
+    for (int i = 0; i < 50; ++i) {
+        records.emplace_back(Bytes{0x6b, static_cast<uint8_t>(i)}, Bytes(i * 7, static_cast<uint8_t>(i)));
+        data_file->write(records.back());
+    }
+    uint64_t valid_end = data_file->get_write_off();
+    
+    // 损坏一条记录的value，再追加一条完整记录和一条写了一半的记录
+    LogRecord good({0x67}, {0x01, 0x02}, LogRecordType::DELETED);
+    auto [bad_data, bad_size] = good.encode();
+    bad_data[bad_size - 1] ^= 0x01;
+    data_file->write(bad_data);
+    data_file->write(good);
+    auto [torn_data, torn_size] = good.encode();
+    data_file->write(Bytes(torn_data.begin(), torn_data.begin() + torn_size - 1));
+    
+    for (bool populate : {false, true}) {
+        ScannerOptions options;
+        options.buffer_size = 64;
+        options.map_populate = populate;
+        auto scanner = data_file->new_scanner(options);
+        
+        ScannedRecord record;
+        uint64_t offset = 0;
+        for (const auto& expected : records) {
+            ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+            EXPECT_EQ(record.offset, offset);
+            EXPECT_EQ(record.key_bytes(), expected.key);
+            EXPECT_EQ(record.value_bytes(), expected.value);
+            offset += record.size;
+        }
+        EXPECT_EQ(offset, valid_end);
+        
+        // 损坏的记录不前进，跳过后读到下一条
+        EXPECT_EQ(scanner->next(record), ScanStatus::CORRUPTED);
+        EXPECT_EQ(scanner->offset(), valid_end);
+        scanner->seek(valid_end + bad_size);
+        ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+        EXPECT_EQ(record.type, LogRecordType::DELETED);
+        EXPECT_EQ(record.value_bytes(), good.value);
+        
+        uint64_t tail = scanner->offset();
+        EXPECT_EQ(scanner->next(record), ScanStatus::TORN_TAIL);
+        EXPECT_EQ(scanner->offset(), tail);
+    }
+    
+    // 全零的尾部视为文件结束
+    auto zero_file = DataFile::open_data_file(test_dir, 2, IOType::STANDARD_FIO);
+    zero_file->write(good);
+    zero_file->write(Bytes(100, 0));
+    auto scanner = zero_file->new_scanner();
+    ScannedRecord record;
+    EXPECT_EQ(scanner->next(record), ScanStatus::OK);
+    EXPECT_EQ(scanner->next(record), ScanStatus::END_OF_FILE);
+    EXPECT_EQ(scanner->offset(), static_cast<uint64_t>(torn_size));
+    
+    zero_file->close();
+    data_file->close();
+}
+
+TEST_F(DataFileErrorTest, ScannerDecidesTornTailFromDeclaredLength) {
+    // 头部声明value长32MB，远超文件剩余部分
+    const Bytes oversized_header = {0xAA, 0xBB, 0xCC, 0xDD, 0x01, 0x01, 0x80, 0x80, 0x80, 0x10};
+    LogRecord good({0x67}, {0x01, 0x02});
+    
+    // 0：后面什么都没有；1：后面有同步标记和完整记录；2：后面只有完整记录，没有同步标记
+    for (int follow : {0, 1, 2}) {
+        SCOPED_TRACE(follow);
+        auto data_file = DataFile::open_data_file(test_dir, 3 + follow, IOType::STANDARD_FIO);
+        data_file->write(good);
+        uint64_t bad_off = data_file->get_write_off();
+        data_file->write(oversized_header);
+        data_file->write(Bytes(100 * 1024, 0x5A));
+        uint64_t good_off = 0;
+        if (follow == 1) {
+            data_file->write(encoded_sync_marker());
+            data_file->write(good);
+        } else if (follow == 2) {
+            good_off = data_file->get_write_off();
+            for (int i = 0; i < 3; ++i) {
+                data_file->write(good);
+            }
+        }
+        
+        ScannerOptions options;
+        options.buffer_size = 4096;
+        auto scanner = data_file->new_scanner(options);
+        ScannedRecord record;
+        ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+        if (follow == 0) {
+            // 后面没有同步标记也没有完整记录：写了一半的尾部
+            EXPECT_EQ(scanner->next(record), ScanStatus::TORN_TAIL);
+            EXPECT_EQ(scanner->offset(), bad_off);
+        } else if (follow == 2) {
+            // 后面还能解出完整记录：长度字段损坏，不能当作尾部截掉，逐字节跳过后读到后面的记录
+            ScanStatus status;
+            while ((status = scanner->next(record)) == ScanStatus::CORRUPTED) {
+                scanner->skip_corrupted();
+            }
+            ASSERT_EQ(status, ScanStatus::OK);
+            EXPECT_EQ(record.offset, good_off);
+            EXPECT_EQ(scanner->corrupted_bytes(), good_off - bad_off);
+            for (int i = 0; i < 2; ++i) {
+                ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+                EXPECT_EQ(record.value_bytes(), good.value);
+            }
+            EXPECT_EQ(scanner->next(record), ScanStatus::END_OF_FILE);
+        } else {
+            // 后面还有同步标记：长度字段损坏，跳到标记处继续
+            EXPECT_EQ(scanner->next(record), ScanStatus::CORRUPTED);
+            scanner->skip_corrupted();
+            ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+            EXPECT_EQ(record.type, LogRecordType::SYNC_MARKER);
+            ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+            EXPECT_EQ(record.value_bytes(), good.value);
+            EXPECT_EQ(scanner->next(record), ScanStatus::END_OF_FILE);
+        }
+        data_file->close();
+    }
+}
+
 // MMap DataFile 测试
 class MMapDataFileTest : public ::testing::Test {
 protected:
@@ -294,6 +624,26 @@ TEST_F(FileNameTest, DataFileName) {
     EXPECT_EQ(name3, "/tmp/test/999999999.data");
 }
 
+TEST_F(FileNameTest, ListDataFileIds) {
+    std::string dir = "/tmp/bitcask_list_files_test";
+    utils::remove_directory(dir);
+    utils::create_directory(dir);
+    
+    // 文件ID不连续，且超过1000
+    for (uint32_t fid : {7u, 0u, 1500u, 4000000000u}) {
+        DataFile::open_data_file(dir, fid, IOType::STANDARD_FIO)->close();
+    }
+    // 不是数据文件的名字被忽略
+    for (const char* name : {"000000001.hint", "12.data", "abc.data", "00000000x.data", "000000002.data.tmp"}) {
+        std::ofstream(dir + "/" + name) << "x";
+    }
+    
+    EXPECT_EQ(DataFile::list_data_file_ids(dir), (std::vector<uint32_t>{0, 7, 1500, 4000000000u}));
+    EXPECT_TRUE(DataFile::list_data_file_ids(dir + "/missing").empty());
+    
+    utils::remove_directory(dir);
+}
+
 // IO 管理器切换测试
 class IOManagerSwitchTest : public ::testing::Test {
 protected:
@@ -2,11 +2,153 @@
 #include <gmock/gmock.h>
 #include "bitcask/db.h"
 #include "bitcask/utils.h"
+#include "bitcask/data_file_scanner.h"
+#include <atomic>
 #include <thread>
 #include <random>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <condition_variable>
 
 using namespace bitcask;
 
+namespace bitcask {
+
+// 把活跃文件的IO管理器包一层，让接下来的若干次writev失败
+class DBFaultInjection {
+public:
+    class FailingWritevIOManager : public IOManager {
+    public:
+        FailingWritevIOManager(std::unique_ptr<IOManager> inner, std::shared_ptr<std::atomic<int>> failures)
+            : inner_(std::move(inner)), failures_(std::move(failures)) {}
+
+        ssize_t read(void* buf, size_t size, off_t offset) override { return inner_->read(buf, size, offset); }
+        ssize_t write(const void* buf, size_t size, off_t offset) override { return inner_->write(buf, size, offset); }
+        ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override {
+            // 负数表示一直失败
+            if (failures_->load() != 0) {
+                if (failures_->load() > 0) {
+                    failures_->fetch_sub(1);
+                }
+                errno = ENOSPC;
+                return -1;
+            }
+            return inner_->writev(iov, iovcnt, offset);
+        }
+        void read_batch(IORequest* reqs, size_t count) override { inner_->read_batch(reqs, count); }
+        int allocate(off_t offset, off_t len) override { return inner_->allocate(offset, len); }
+        int sync() override { return inner_->sync(); }
+        int close() override { return inner_->close(); }
+        off_t size() override { return inner_->size(); }
+
+    private:
+        std::unique_ptr<IOManager> inner_;
+        std::shared_ptr<std::atomic<int>> failures_;
+    };
+
+    // 拦住下一次writev直到放行，并记录拦住期间是否有人落盘
+    struct WriteGate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool hold_next = true;
+        bool holding = false;
+        bool open = false;
+        bool synced_over_hole = false;
+    };
+    
+    class GatedWritevIOManager : public IOManager {
+    public:
+        GatedWritevIOManager(std::unique_ptr<IOManager> inner, std::shared_ptr<WriteGate> gate)
+            : inner_(std::move(inner)), gate_(std::move(gate)) {}
+        
+        ssize_t read(void* buf, size_t size, off_t offset) override { return inner_->read(buf, size, offset); }
+        ssize_t write(const void* buf, size_t size, off_t offset) override { return inner_->write(buf, size, offset); }
+        ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override {
+            bool held = false;
+            {
+                std::unique_lock<std::mutex> lock(gate_->mutex);
+                if (gate_->hold_next) {
+                    gate_->hold_next = false;
+                    gate_->holding = true;
+                    held = true;
+                    gate_->cv.notify_all();
+                    gate_->cv.wait(lock, [this]() { return gate_->open; });
+                }
+            }
+            ssize_t n = inner_->writev(iov, iovcnt, offset);
+            if (held) {
+                std::lock_guard<std::mutex> lock(gate_->mutex);
+                gate_->holding = false;
+            }
+            return n;
+        }
+        void read_batch(IORequest* reqs, size_t count) override { inner_->read_batch(reqs, count); }
+        int allocate(off_t offset, off_t len) override { return inner_->allocate(offset, len); }
+        int sync() override {
+            {
+                std::lock_guard<std::mutex> lock(gate_->mutex);
+                if (gate_->holding) {
+                    gate_->synced_over_hole = true;
+                }
+            }
+            return inner_->sync();
+        }
+        int close() override { return inner_->close(); }
+        off_t size() override { return inner_->size(); }
+    
+    private:
+        std::unique_ptr<IOManager> inner_;
+        std::shared_ptr<WriteGate> gate_;
+    };
+    
+    static void gate_writev(DB& db, std::shared_ptr<WriteGate> gate) {
+        std::lock_guard<std::mutex> lock(db.append_mutex_);
+        db.active_file_->wrap_io_manager([&](std::unique_ptr<IOManager> inner) -> std::unique_ptr<IOManager> {
+            return std::make_unique<GatedWritevIOManager>(std::move(inner), gate);
+        });
+    }
+    
+    class FailingSyncIOManager : public IOManager {
+    public:
+        explicit FailingSyncIOManager(std::unique_ptr<IOManager> inner) : inner_(std::move(inner)) {}
+        
+        ssize_t read(void* buf, size_t size, off_t offset) override { return inner_->read(buf, size, offset); }
+        ssize_t write(const void* buf, size_t size, off_t offset) override { return inner_->write(buf, size, offset); }
+        ssize_t writev(const struct iovec* iov, int iovcnt, off_t offset) override {
+            return inner_->writev(iov, iovcnt, offset);
+        }
+        void read_batch(IORequest* reqs, size_t count) override { inner_->read_batch(reqs, count); }
+        int allocate(off_t offset, off_t len) override { return inner_->allocate(offset, len); }
+        int sync() override {
+            errno = EIO;
+            return -1;
+        }
+        int close() override { return inner_->close(); }
+        off_t size() override { return inner_->size(); }
+    
+    private:
+        std::unique_ptr<IOManager> inner_;
+    };
+    
+    static void fail_sync(DB& db) {
+        std::lock_guard<std::mutex> lock(db.append_mutex_);
+        db.active_file_->wrap_io_manager([](std::unique_ptr<IOManager> inner) -> std::unique_ptr<IOManager> {
+            return std::make_unique<FailingSyncIOManager>(std::move(inner));
+        });
+    }
+    
+    static void fail_writev(DB& db, std::shared_ptr<std::atomic<int>> failures) {
+        std::lock_guard<std::mutex> lock(db.append_mutex_);
+        db.active_file_->wrap_io_manager([&](std::unique_ptr<IOManager> inner) -> std::unique_ptr<IOManager> {
+            return std::make_unique<FailingWritevIOManager>(std::move(inner), failures);
+        });
+    }
+};
+
+}  // namespace bitcask
+
 class DBTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -57,6 +199,19 @@ TEST_F(DBTest, PutAndGet) {
     db->close();
 }
 
+TEST_F(DBTest, PutMovedKeyValue) {
+    auto db = DB::open(options);
+    
+    // 右值写入，key和value直接交给日志记录
+    Bytes key = test_pairs[0].first;
+    Bytes value(64 * 1024, 0x5a);
+    db->put(std::move(key), Bytes(value));
+    
+    EXPECT_EQ(db->get(test_pairs[0].first), value);
+    
+    db->close();
+}
+
 TEST_F(DBTest, GetNonExistentKey) {
     auto db = DB::open(options);
     
@@ -206,6 +361,39 @@ TEST_F(DBTest, FoldEarlyTermination) {
     db->close();
 }
 
+TEST_F(DBTest, FoldReadsInBatchesAcrossFiles) {
+    // 多批、跨多个文件，最后一批还在追加缓冲区里
+    options.io_type = IOType::IO_URING;
+    options.mmap_at_startup = false;
+    options.sync_writes = false;
+    options.data_file_size = 8 * 1024;
+    options.write_buffer_size = 4096;
+    auto db = DB::open(options);
+    
+    std::map<Bytes, Bytes> expected;
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 300; i += round + 1) {
+            Bytes key = {0x66, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+            Bytes value(20 + i % 30, static_cast<uint8_t>(round * 13 + i));
+            db->put(key, value);
+            expected[key] = value;
+        }
+    }
+    
+    std::map<Bytes, Bytes> folded;
+    db->fold([&folded](const Bytes& key, const Bytes& value) -> bool {
+        folded[key] = value;
+        return true;
+    });
+    EXPECT_EQ(folded, expected);
+    
+    // 在一批中间停止
+    size_t count = 0;
+    db->fold([&count](const Bytes&, const Bytes&) -> bool { return ++count < 100; });
+    EXPECT_EQ(count, 100u);
+    db->close();
+}
+
 TEST_F(DBTest, SyncOperation) {
     auto db = DB::open(options);
     
@@ -221,6 +409,555 @@ TEST_F(DBTest, SyncOperation) {
 // 数据持久化测试
 class DBPersistenceTest : public DBTest {};
 
+TEST_F(DBPersistenceTest, ParallelRecoveryMatchesSerial) {
+    options.sync_writes = false;
+    options.data_file_size = 8 * 1024; // 大量小文件，事务跨文件
+    
+    std::map<Bytes, Bytes> expected;
+    {
+        auto db = DB::open(options);
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 300; ++i) {
+                Bytes key = {0x6b, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+                Bytes value(40, static_cast<uint8_t>(round * 7 + i));
+                db->put(key, value);
+                expected[key] = value;
+            }
+            for (int i = round; i < 300; i += 5) {
+                Bytes key = {0x6b, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+                db->remove(key);
+                expected.erase(key);
+            }
+            
+            auto batch = db->new_write_batch(WriteBatchOptions::default_options());
+            for (int i = 0; i < 200; ++i) {
+                Bytes key = {0x74, static_cast<uint8_t>(round), static_cast<uint8_t>(i)};
+                Bytes value(64, static_cast<uint8_t>(i));
+                batch->put(key, value);
+                expected[key] = value;
+            }
+            batch->commit();
+        }
+        db->close();
+    }
+    
+    Stat serial_stat;
+    for (uint32_t threads : {1u, 8u}) {
+        options.recovery_threads = threads;
+        auto db = DB::open(options);
+        Stat stat = db->stat();
+        EXPECT_GT(stat.data_file_num, 8u);
+        EXPECT_EQ(stat.key_num, expected.size());
+        for (const auto& [key, value] : expected) {
+            EXPECT_EQ(db->get(key), value);
+        }
+        if (threads == 1) {
+            serial_stat = stat;
+        } else {
+            EXPECT_EQ(stat.reclaimable_size, serial_stat.reclaimable_size);
+        }
+        
+        // 恢复后继续写入活跃文件
+        Bytes key = {0x6e, static_cast<uint8_t>(threads)};
+        db->put(key, Bytes{0x01});
+        expected[key] = Bytes{0x01};
+        db->close();
+    }
+}
+
+TEST_F(DBPersistenceTest, DataFileHintsSkipReplay) {
+    options.sync_writes = false;
+    options.data_file_size = 8 * 1024;
+    
+    std::map<Bytes, Bytes> expected;
+    auto write_round = [&](DB* db, int round) {
+        for (int i = 0; i < 300; ++i) {
+            Bytes key = {0x68, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+            Bytes value(40, static_cast<uint8_t>(round + i));
+            db->put(key, value);
+            expected[key] = value;
+        }
+        for (int i = round; i < 300; i += 7) {
+            Bytes key = {0x68, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+            db->remove(key);
+            expected.erase(key);
+        }
+        auto batch = db->new_write_batch(WriteBatchOptions::default_options());
+        for (int i = 0; i < 100; ++i) {
+            Bytes key = {0x74, static_cast<uint8_t>(round), static_cast<uint8_t>(i)};
+            batch->put(key, Bytes(30, static_cast<uint8_t>(i)));
+            expected[key] = Bytes(30, static_cast<uint8_t>(i));
+        }
+        batch->commit();
+    };
+    
+    // 等后台为所有封存文件生成提示文件
+    auto wait_for_hints = [&](uint32_t sealed_files) {
+        for (int i = 0; i < 500; ++i) {
+            uint32_t count = 0;
+            for (uint32_t fid = 0; fid < sealed_files; ++fid) {
+                count += utils::file_exists(DataFile::get_hint_file_name(test_dir, fid)) ? 1 : 0;
+            }
+            if (count == sealed_files) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    };
+    
+    Stat written_stat;
+    {
+        auto db = DB::open(options);
+        write_round(db.get(), 0);
+        write_round(db.get(), 1);
+        written_stat = db->stat();
+        EXPECT_TRUE(wait_for_hints(written_stat.data_file_num - 1));
+        db->close();
+    }
+    
+    // 有提示文件时重启的结果与重放数据文件一致
+    for (bool hints : {true, false}) {
+        options.data_file_hints = hints;
+        auto db = DB::open(options);
+        Stat stat = db->stat();
+        EXPECT_EQ(stat.key_num, expected.size());
+        EXPECT_EQ(stat.reclaimable_size, written_stat.reclaimable_size);
+        for (const auto& [key, value] : expected) {
+            EXPECT_EQ(db->get(key), value);
+        }
+        db->close();
+    }
+    
+    // 提示文件与数据文件不一致或损坏时退回扫描，并在后台重新生成
+    options.data_file_hints = true;
+    {
+        std::ofstream stale(DataFile::get_hint_file_name(test_dir, 0), std::ios::binary | std::ios::trunc);
+        stale << "stale";
+    }
+    std::remove(DataFile::get_hint_file_name(test_dir, 1).c_str());
+    {
+        auto db = DB::open(options);
+        EXPECT_EQ(db->stat().key_num, expected.size());
+        for (const auto& [key, value] : expected) {
+            EXPECT_EQ(db->get(key), value);
+        }
+        EXPECT_TRUE(wait_for_hints(2));
+        write_round(db.get(), 2);
+        db->close();
+    }
+    {
+        auto db = DB::open(options);
+        EXPECT_EQ(db->stat().key_num, expected.size());
+        for (const auto& [key, value] : expected) {
+            EXPECT_EQ(db->get(key), value);
+        }
+        db->close();
+    }
+}
+
+TEST_F(DBPersistenceTest, SparseDataFileIds) {
+    options.sync_writes = false;
+    options.data_file_size = 4 * 1024;
+    
+    uint32_t last_fid = 0;
+    {
+        auto db = DB::open(options);
+        for (int i = 0; i < 200; ++i) {
+            Bytes key = {0x73, static_cast<uint8_t>(i)};
+            db->put(key, Bytes(60, static_cast<uint8_t>(i)));
+        }
+        last_fid = db->stat().data_file_num - 1;
+        db->close();
+    }
+    
+    // 活跃文件的ID远超过旧的扫描上限，中间留下大段空缺
+    utils::move_file(DataFile::get_data_file_name(test_dir, last_fid),
+                     DataFile::get_data_file_name(test_dir, 5000));
+    
+    {
+        auto db = DB::open(options);
+        EXPECT_EQ(db->stat().key_num, 200u);
+        for (int i = 0; i < 200; ++i) {
+            Bytes key = {0x73, static_cast<uint8_t>(i)};
+            EXPECT_EQ(db->get(key), Bytes(60, static_cast<uint8_t>(i)));
+        }
+        for (int i = 0; i < 200; ++i) {
+            Bytes key = {0x74, static_cast<uint8_t>(i)};
+            db->put(key, Bytes(60, static_cast<uint8_t>(i)));
+        }
+        db->close();
+    }
+    
+    EXPECT_TRUE(utils::file_exists(DataFile::get_data_file_name(test_dir, 5001)));
+    auto db = DB::open(options);
+    EXPECT_EQ(db->stat().key_num, 400u);
+    db->close();
+}
+
+// 没有同步标记时活跃文件中间的长度字段损坏：后面的记录仍然完整，不能当作尾部截掉
+TEST_F(DBPersistenceTest, CorruptLengthWithoutMarkersIsNotTruncated) {
+    options.sync_writes = false;
+    options.sync_marker_interval = 0;
+    
+    const int num_keys = 2000;
+    const int bad_key = 1000;
+    auto key_of = [](int i) { return Bytes{0x63, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)}; };
+    {
+        auto db = DB::open(options);
+        for (int i = 0; i < num_keys; ++i) {
+            db->put(key_of(i), Bytes(40, static_cast<uint8_t>(i)));
+        }
+        db->close();
+    }
+    
+    // 把第bad_key条记录的长度字段改成32MB，远超文件末尾
+    std::string file_name = DataFile::get_data_file_name(test_dir, 0);
+    uint64_t bad_off = 0;
+    {
+        auto scanner = DataFileScanner::open(file_name);
+        ScannedRecord record;
+        for (int i = 0; i <= bad_key; ++i) {
+            ASSERT_EQ(scanner->next(record), ScanStatus::OK);
+        }
+        bad_off = record.offset;
+    }
+    uint64_t file_size = 0;
+    {
+        std::fstream file(file_name, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(0, std::ios::end);
+        file_size = static_cast<uint64_t>(file.tellg());
+        const char header[] = {0x01, 0x01, static_cast<char>(0x80), static_cast<char>(0x80),
+                               static_cast<char>(0x80), 0x10};
+        file.seekp(static_cast<std::streamoff>(bad_off + 4));
+        file.write(header, sizeof(header));
+    }
+    
+    auto db = DB::open(options);
+    Stat stat = db->stat();
+    EXPECT_EQ(stat.truncated_tail_bytes, 0u);
+    EXPECT_EQ(stat.corrupted_ranges, 1u);
+    EXPECT_EQ(static_cast<uint64_t>(std::ifstream(file_name, std::ios::binary | std::ios::ate).tellg()), file_size);
+    EXPECT_EQ(stat.key_num, static_cast<uint32_t>(num_keys - 1));
+    EXPECT_THROW(db->get(key_of(bad_key)), KeyNotFoundError);
+    for (int i = bad_key + 1; i < num_keys; ++i) {
+        EXPECT_EQ(db->get(key_of(i)), Bytes(40, static_cast<uint8_t>(i)));
+    }
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, SyncMarkersBoundCorruptionLoss) {
+    options.sync_writes = false;
+    options.sync_marker_interval = 1024;
+    
+    // 每条记录50字节，全部在一个文件里
+    const int num_keys = 2000;
+    auto key_of = [](int i) { return Bytes{0x63, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)}; };
+    {
+        auto db = DB::open(options);
+        for (int i = 0; i < num_keys; ++i) {
+            db->put(key_of(i), Bytes(40, static_cast<uint8_t>(i)));
+        }
+        db->close();
+    }
+    
+    // 文件中间写入3000字节垃圾，末尾追加半条记录
+    std::string file_name = DataFile::get_data_file_name(test_dir, 0);
+    const uint64_t garbage_off = 40000;
+    const uint64_t garbage_len = 3000;
+    auto [tail_record, tail_size] = LogRecord({0x7a}, Bytes(100, 0x01)).encode();
+    uint64_t valid_size = 0;
+    {
+        std::fstream file(file_name, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(0, std::ios::end);
+        valid_size = static_cast<uint64_t>(file.tellg());
+        std::mt19937 rng(7);
+        std::string garbage(garbage_len, '\0');
+        for (auto& c : garbage) {
+            c = static_cast<char>(rng());
+        }
+        file.seekp(garbage_off);
+        file.write(garbage.data(), garbage.size());
+        file.seekp(0, std::ios::end);
+        file.write(reinterpret_cast<const char*>(tail_record.data()), tail_size / 2);
+    }
+    
+    {
+        auto db = DB::open(options);
+        Stat stat = db->stat();
+        EXPECT_EQ(stat.corrupted_ranges, 1u);
+        EXPECT_GE(stat.corrupted_bytes, garbage_len - 50);
+        EXPECT_LE(stat.corrupted_bytes, garbage_len + 1024 + 100);
+        EXPECT_EQ(stat.truncated_tail_bytes, tail_size / 2);
+        EXPECT_EQ(static_cast<uint64_t>(std::ifstream(file_name, std::ios::binary | std::ios::ate).tellg()), valid_size);
+        
+        // 丢失的只有损坏区间到下一个同步标记之间的记录
+        EXPECT_LT(stat.key_num, static_cast<uint32_t>(num_keys));
+        EXPECT_GE(stat.key_num, static_cast<uint32_t>(num_keys - (garbage_len + 1024) / 50 - 2));
+        for (int i = 0; i < num_keys; ++i) {
+            try {
+                EXPECT_EQ(db->get(key_of(i)), Bytes(40, static_cast<uint8_t>(i)));
+            } catch (const KeyNotFoundError&) {
+            }
+        }
+        
+        // 截断之后继续写入
+        db->put({0x6e}, {0x01});
+        db->close();
+    }
+    
+    auto db = DB::open(options);
+    Stat stat = db->stat();
+    EXPECT_EQ(stat.truncated_tail_bytes, 0u);
+    EXPECT_EQ(stat.corrupted_ranges, 1u);
+    EXPECT_EQ(db->get({0x6e}), Bytes{0x01});
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, WriteBufferPersistence) {
+    options.sync_writes = false;
+    options.write_buffer_size = 4096;
+    options.data_file_size = 16 * 1024; // 触发文件轮转
+    
+    {
+        auto db = DB::open(options);
+        for (int i = 0; i < 500; ++i) {
+            Bytes key = {static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+            Bytes value(60, static_cast<uint8_t>(i));
+            db->put(key, value);
+            // 刚写入的数据可以立即读到
+            EXPECT_EQ(db->get(key), value);
+        }
+        db->close();
+    }
+    
+    auto db = DB::open(options);
+    for (int i = 0; i < 500; ++i) {
+        Bytes key = {static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+        EXPECT_EQ(db->get(key), Bytes(60, static_cast<uint8_t>(i)));
+    }
+    EXPECT_GT(db->stat().data_file_num, 1u);
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, BackgroundFileRotation) {
+    options.sync_writes = false;
+    options.data_file_size = 4 * 1024;
+    options.background_file_rotation = true;
+    
+    {
+        auto db = DB::open(options);
+        for (int i = 0; i < 300; ++i) {
+            Bytes key = {static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+            db->put(key, Bytes(100, static_cast<uint8_t>(i)));
+        }
+        EXPECT_GT(db->stat().data_file_num, 5u);
+        db->close();
+    }
+    
+    // 关闭后不保留未使用的预创建文件
+    uint32_t file_num = 0;
+    while (utils::file_exists(DataFile::get_data_file_name(test_dir, file_num))) {
+        file_num++;
+    }
+    EXPECT_FALSE(utils::file_exists(DataFile::get_data_file_name(test_dir, file_num + 1)));
+    
+    auto db = DB::open(options);
+    EXPECT_EQ(db->stat().data_file_num, file_num);
+    for (int i = 0; i < 300; ++i) {
+        Bytes key = {static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF)};
+        EXPECT_EQ(db->get(key), Bytes(100, static_cast<uint8_t>(i)));
+    }
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, RecoverWithZeroTail) {
+    options.sync_writes = false;
+    
+    {
+        auto db = DB::open(options);
+        db->put({0x01}, {0x0A});
+        db->put({0x02}, {0x0B});
+        db->close();
+    }
+    
+    // 模拟预分配后未写满的活跃文件：尾部是一段全零数据
+    std::string file_path = DataFile::get_data_file_name(test_dir, 0);
+    {
+        std::ofstream out(file_path, std::ios::binary | std::ios::app);
+        std::string zeros(4096, '\0');
+        out.write(zeros.data(), zeros.size());
+    }
+    
+    {
+        auto db = DB::open(options);
+        EXPECT_EQ(db->get({0x01}), Bytes({0x0A}));
+        EXPECT_EQ(db->get({0x02}), Bytes({0x0B}));
+        // 新写入从零区开头开始，覆盖预分配的部分
+        db->put({0x03}, {0x0C});
+        db->close();
+    }
+    
+    auto db = DB::open(options);
+    EXPECT_EQ(db->get({0x01}), Bytes({0x0A}));
+    EXPECT_EQ(db->get({0x02}), Bytes({0x0B}));
+    EXPECT_EQ(db->get({0x03}), Bytes({0x0C}));
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, FailedAppendIsPaddedForRecovery) {
+    {
+        auto db = DB::open(options);
+        db->put({0x01}, {0x0A});
+        
+        // 只有这次写入失败：预留区域改写为填充记录，后面的写入照常确认
+        auto failures = std::make_shared<std::atomic<int>>(1);
+        DBFaultInjection::fail_writev(*db, failures);
+        EXPECT_THROW(db->put({0x02}, Bytes(100, 0x0B)), BitcaskException);
+        db->put({0x03}, {0x0C});
+        EXPECT_THROW(db->get({0x02}), KeyNotFoundError);
+        db->close();
+    }
+    
+    // 恢复越过填充记录，读到失败之后确认的写入
+    auto db = DB::open(options);
+    EXPECT_EQ(db->get({0x01}), Bytes({0x0A}));
+    EXPECT_THROW(db->get({0x02}), KeyNotFoundError);
+    EXPECT_EQ(db->get({0x03}), Bytes({0x0C}));
+    EXPECT_EQ(db->stat().corrupted_ranges, 0u);
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, UnrepairableAppendMakesDBReadOnly) {
+    {
+        auto db = DB::open(options);
+        db->put({0x01}, {0x0A});
+        
+        // 填充也写不进去时留下的空洞之后不能再确认写入
+        auto failures = std::make_shared<std::atomic<int>>(-1);
+        DBFaultInjection::fail_writev(*db, failures);
+        EXPECT_THROW(db->put({0x02}, {0x0B}), BitcaskException);
+        EXPECT_THROW(db->put({0x03}, {0x0C}), BitcaskException);
+        EXPECT_EQ(db->get({0x01}), Bytes({0x0A}));
+        db->close();
+    }
+    
+    auto db = DB::open(options);
+    EXPECT_EQ(db->get({0x01}), Bytes({0x0A}));
+    EXPECT_THROW(db->get({0x02}), KeyNotFoundError);
+    db->put({0x03}, {0x0C});
+    EXPECT_EQ(db->get({0x03}), Bytes({0x0C}));
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, SyncedCommitWaitsForEarlierReservations) {
+    options.sync_writes = false;
+    auto db = DB::open(options);
+    db->put({0x01}, {0x0A});
+    
+    // 前一次写入预留了区域但还没写完，后面同步提交的批次不能在这之前落盘并确认
+    auto gate = std::make_shared<DBFaultInjection::WriteGate>();
+    DBFaultInjection::gate_writev(*db, gate);
+    std::thread slow([&]() { db->put({0x02}, Bytes(100, 0x0B)); });
+    {
+        std::unique_lock<std::mutex> lock(gate->mutex);
+        gate->cv.wait(lock, [&]() { return gate->holding; });
+    }
+    
+    std::atomic<bool> committed(false);
+    std::thread synced([&]() {
+        auto batch = db->new_write_batch(WriteBatchOptions::default_options());
+        batch->put({0x03}, {0x0C});
+        batch->commit();
+        committed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(committed.load());
+    {
+        std::lock_guard<std::mutex> lock(gate->mutex);
+        gate->open = true;
+    }
+    gate->cv.notify_all();
+    slow.join();
+    synced.join();
+    
+    EXPECT_FALSE(gate->synced_over_hole);
+    EXPECT_EQ(db->get({0x02}), Bytes(100, 0x0B));
+    EXPECT_EQ(db->get({0x03}), Bytes({0x0C}));
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, SyncFailureReachesWriter) {
+    // 打开或同步失败要报告出来，文件已经不存在时没有需要落盘的数据
+    std::string plain = test_dir + "_plain";
+    { std::ofstream(plain) << "x"; }
+    EXPECT_THROW(utils::sync_file(plain + "/child"), BitcaskException);
+    EXPECT_NO_THROW(utils::sync_file(test_dir + "/missing"));
+    std::remove(plain.c_str());
+    
+    auto db = DB::open(options);
+    db->put({0x01}, {0x0A});
+    
+    // 落盘失败时同步写入不能确认成功
+    DBFaultInjection::fail_sync(*db);
+    EXPECT_THROW(db->put({0x02}, {0x0B}), BitcaskException);
+    auto batch = db->new_write_batch(WriteBatchOptions::default_options());
+    batch->put({0x03}, {0x0C});
+    EXPECT_THROW(batch->commit(), BitcaskException);
+    EXPECT_THROW(db->sync(), BitcaskException);
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, IOUringDataFiles) {
+    options.io_type = IOType::IO_URING;
+    options.mmap_at_startup = false;
+    options.data_file_size = 8 * 1024;
+    
+    {
+        auto db = DB::open(options);
+        for (int i = 0; i < 200; ++i) {
+            Bytes key = {static_cast<uint8_t>(i)};
+            db->put(key, Bytes(100, static_cast<uint8_t>(i)));
+        }
+        db->remove({0x05});
+        db->close();
+    }
+    
+    auto db = DB::open(options);
+    EXPECT_THROW(db->get({0x05}), KeyNotFoundError);
+    for (int i = 6; i < 200; ++i) {
+        EXPECT_EQ(db->get({static_cast<uint8_t>(i)}), Bytes(100, static_cast<uint8_t>(i)));
+    }
+    db->close();
+}
+
+TEST_F(DBPersistenceTest, DirectIODataFiles) {
+    options.io_type = IOType::DIRECT_IO;
+    options.mmap_at_startup = false;
+    options.sync_writes = false;
+    options.data_file_size = 16 * 1024;
+    
+    for (int round = 0; round < 2; ++round) {
+        auto db = DB::open(options);
+        for (int i = 0; i < 150; ++i) {
+            Bytes key = {static_cast<uint8_t>(round), static_cast<uint8_t>(i)};
+            db->put(key, Bytes(50 + i, static_cast<uint8_t>(i)));
+        }
+        db->close();
+    }
+    
+    // 每次关闭后尾块补零，重启时从零区开头继续追加
+    auto db = DB::open(options);
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 150; ++i) {
+            Bytes key = {static_cast<uint8_t>(round), static_cast<uint8_t>(i)};
+            EXPECT_EQ(db->get(key), Bytes(50 + i, static_cast<uint8_t>(i)));
+        }
+    }
+    EXPECT_EQ(db->stat().key_num, 300u);
+    db->close();
+}
+
 TEST_F(DBPersistenceTest, DataPersistence) {
     // 第一次打开，写入数据
     {
@@ -293,6 +1030,37 @@ TEST_F(DBLargeDataTest, LargeValue) {
     db->close();
 }
 
+TEST_F(DBLargeDataTest, GetViewFromSealedFiles) {
+    options.data_file_size = 64 * 1024;
+    auto db = DB::open(options);
+    
+    // 多个16KB的值，写满后旧文件被封存并映射
+    std::vector<Bytes> values;
+    for (int i = 0; i < 20; ++i) {
+        values.emplace_back(16 * 1024, static_cast<uint8_t>(i));
+        db->put(Bytes{0x76, static_cast<uint8_t>(i)}, values.back());
+    }
+    EXPECT_GT(db->stat().data_file_num, 1u);
+    
+    std::vector<ValueView> views;
+    for (int i = 0; i < 20; ++i) {
+        views.push_back(db->get_view(Bytes{0x76, static_cast<uint8_t>(i)}));
+        EXPECT_EQ(views.back().to_bytes(), values[i]);
+    }
+    
+    db->remove(Bytes{0x76, 0});
+    EXPECT_THROW(db->get_view(Bytes{0x76, 0}), KeyNotFoundError);
+    EXPECT_THROW(db->get_view(Bytes{0x78}), KeyNotFoundError);
+    
+    // 数据库关闭后视图仍持有映射
+    db->close();
+    db.reset();
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_EQ(views[i].size(), values[i].size());
+        EXPECT_TRUE(std::equal(views[i].begin(), views[i].end(), values[i].begin()));
+    }
+}
+
 TEST_F(DBLargeDataTest, ManyKeys) {
     auto db = DB::open(options);
     
@@ -488,6 +1256,59 @@ TEST_F(DBStatTest, ReclaimableSize) {
     db->close();
 }
 
+TEST_F(DBStatTest, ValueCacheHitsAndMisses) {
+    options.value_cache_size = 1024 * 1024;
+    auto db = DB::open(options);
+    
+    for (const auto& [key, value] : test_pairs) {
+        db->put(key, value);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (const auto& [key, value] : test_pairs) {
+            EXPECT_EQ(db->get(key), value);
+        }
+    }
+    
+    // 第一轮未命中，之后都命中
+    Stat stat = db->stat();
+    EXPECT_EQ(stat.value_cache_misses, test_pairs.size());
+    EXPECT_EQ(stat.value_cache_hits, 2 * test_pairs.size());
+    EXPECT_GT(stat.value_cache_usage, 0u);
+    
+    // 更新后位置变化，读到的是新值
+    Bytes new_value = {0x6e, 0x65, 0x77};
+    db->put(test_pairs[0].first, new_value);
+    EXPECT_EQ(db->get(test_pairs[0].first), new_value);
+    
+    db->close();
+}
+
+TEST(ValueCacheTest, ClockEvictionBoundsUsage) {
+    const size_t capacity = 16 * 1024;
+    ValueCache cache(capacity, 1);
+    Bytes value(1000, 0x5a);
+    Bytes out;
+    
+    // 热点条目每轮都被访问，CLOCK给它第二次机会
+    ValueCacheKey hot{0, 1, 0};
+    cache.put(hot, value);
+    for (uint64_t i = 1; i <= 200; ++i) {
+        EXPECT_TRUE(cache.get(hot, out));
+        cache.put(ValueCacheKey{0, 1, i * 1000}, value);
+        EXPECT_LE(cache.usage(), capacity);
+    }
+    EXPECT_TRUE(cache.get(hot, out));
+    EXPECT_EQ(out, value);
+    EXPECT_FALSE(cache.get(ValueCacheKey{0, 1, 1000}, out));
+    
+    // 代数不同视为不同条目
+    EXPECT_FALSE(cache.get(ValueCacheKey{1, 1, 0}, out));
+    
+    // 超过容量的值不缓存
+    cache.put(ValueCacheKey{0, 2, 0}, Bytes(capacity, 0));
+    EXPECT_FALSE(cache.get(ValueCacheKey{0, 2, 0}, out));
+}
+
 // 备份测试
 class DBBackupTest : public DBTest {};
 
@@ -735,3 +1556,160 @@ TEST_F(DBConcurrencyTest, MixedOperations) {
     
     db->close();
 }
+
+TEST_F(DBConcurrencyTest, GroupCommitSyncWrites) {
+    // sync_writes开启时，并发写入通过组提交共享fdatasync
+    auto db = DB::open(options);
+    
+    const int num_threads = 8;
+    const int writes_per_thread = 100;
+    std::vector<std::thread> threads;
+    
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&db, i]() {
+            for (int j = 0; j < writes_per_thread; ++j) {
+                Bytes key = {static_cast<uint8_t>(i), static_cast<uint8_t>(j)};
+                Bytes value = {static_cast<uint8_t>(j), static_cast<uint8_t>(i), 0x67};
+                db->put(key, value);
+            }
+            // 删除一部分key，删除同样走组提交
+            for (int j = 0; j < 10; ++j) {
+                Bytes key = {static_cast<uint8_t>(i), static_cast<uint8_t>(j)};
+                db->remove(key);
+            }
+        });
+    }
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (int i = 0; i < num_threads; ++i) {
+        for (int j = 0; j < writes_per_thread; ++j) {
+            Bytes key = {static_cast<uint8_t>(i), static_cast<uint8_t>(j)};
+            if (j < 10) {
+                EXPECT_THROW(db->get(key), KeyNotFoundError);
+            } else {
+                Bytes expected_value = {static_cast<uint8_t>(j), static_cast<uint8_t>(i), 0x67};
+                EXPECT_EQ(db->get(key), expected_value);
+            }
+        }
+    }
+    
+    Stat stat = db->stat();
+    EXPECT_EQ(stat.key_num, static_cast<uint32_t>(num_threads * (writes_per_thread - 10)));
+    EXPECT_EQ(stat.sync_group_records, static_cast<uint64_t>(num_threads * (writes_per_thread + 10)));
+    EXPECT_GT(stat.sync_group_num, 0u);
+    EXPECT_LE(stat.sync_group_num, stat.sync_group_records);
+    EXPECT_GE(stat.sync_group_max_size, 1u);
+    EXPECT_GE(stat.sync_group_avg_size, 1.0);
+    
+    db->close();
+    
+    // 重新打开后数据仍然完整
+    auto reopened = DB::open(options);
+    EXPECT_EQ(reopened->stat().key_num, static_cast<uint32_t>(num_threads * (writes_per_thread - 10)));
+    reopened->close();
+}
+
+TEST_F(DBConcurrencyTest, ReadsDuringWritesAndRotation) {
+    // 小文件频繁轮转，读线程在写入和轮转期间持续读取已经写入的key
+    options.sync_writes = false;
+    options.data_file_size = 8 * 1024;
+    auto db = DB::open(options);
+    
+    const int num_writers = 4;
+    const int writes_per_thread = 500;
+    std::atomic<int> written[num_writers] = {};
+    std::atomic<bool> writers_done{false};
+    std::atomic<int> read_errors{0};
+    std::vector<std::thread> threads;
+    
+    for (int i = 0; i < num_writers; ++i) {
+        threads.emplace_back([&db, &written, i]() {
+            for (int j = 0; j < writes_per_thread; ++j) {
+                Bytes key = {static_cast<uint8_t>(i), static_cast<uint8_t>(j >> 8), static_cast<uint8_t>(j & 0xFF)};
+                db->put(key, Bytes(64, static_cast<uint8_t>(i * 31 + j)));
+                written[i].store(j + 1);
+            }
+        });
+    }
+    for (int r = 0; r < 4; ++r) {
+        threads.emplace_back([&db, &written, &writers_done, &read_errors, r]() {
+            std::mt19937 rng(r);
+            while (!writers_done.load()) {
+                int i = static_cast<int>(rng() % num_writers);
+                int count = written[i].load();
+                if (count == 0) {
+                    continue;
+                }
+                int j = static_cast<int>(rng() % count);
+                Bytes key = {static_cast<uint8_t>(i), static_cast<uint8_t>(j >> 8), static_cast<uint8_t>(j & 0xFF)};
+                try {
+                    if (db->get(key) != Bytes(64, static_cast<uint8_t>(i * 31 + j))) {
+                        read_errors++;
+                    }
+                } catch (...) {
+                    read_errors++;
+                }
+            }
+        });
+    }
+    
+    for (int i = 0; i < num_writers; ++i) {
+        threads[i].join();
+    }
+    writers_done.store(true);
+    for (size_t i = num_writers; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    
+    EXPECT_EQ(read_errors.load(), 0);
+    EXPECT_EQ(db->stat().key_num, static_cast<uint32_t>(num_writers * writes_per_thread));
+    EXPECT_GT(db->stat().data_file_num, 10u);
+    db->close();
+}
+
+TEST_F(DBConcurrencyTest, SameKeyWritesKeepFileOrder) {
+    // 多个线程覆盖同一批key，内存索引中的值必须与重启后按文件顺序恢复的值一致
+    options.sync_writes = false;
+    options.data_file_size = 16 * 1024;
+    std::vector<Bytes> expected(16);
+    {
+        auto db = DB::open(options);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i) {
+            threads.emplace_back([&db, i]() {
+                for (int j = 0; j < 300; ++j) {
+                    Bytes key = {static_cast<uint8_t>(j % 16)};
+                    if (j % 7 == 0) {
+                        db->remove(key);
+                    } else {
+                        db->put(key, {static_cast<uint8_t>(i), static_cast<uint8_t>(j >> 8), static_cast<uint8_t>(j & 0xFF)});
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (int k = 0; k < 16; ++k) {
+            try {
+                expected[k] = db->get({static_cast<uint8_t>(k)});
+            } catch (const KeyNotFoundError&) {
+                expected[k].clear();
+            }
+        }
+        db->close();
+    }
+    
+    auto db = DB::open(options);
+    for (int k = 0; k < 16; ++k) {
+        if (expected[k].empty()) {
+            EXPECT_THROW(db->get({static_cast<uint8_t>(k)}), KeyNotFoundError);
+        } else {
+            EXPECT_EQ(db->get({static_cast<uint8_t>(k)}), expected[k]);
+        }
+    }
+    db->close();
+}
@@ -5,6 +5,8 @@
 #include <random>
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <filesystem>
 
 using namespace bitcask;
 
@@ -345,6 +347,153 @@ TEST_F(IndexConcurrencyTest, MixedReadWrite) {
     EXPECT_EQ(operation_count.load(), 3 * 50 * test_keys.size() + 2 * 30);
 }
 
+// 游标迭代器测试：所有索引类型的迭代器都直接在索引结构上移动
+class IndexCursorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() / "bitcask_index_cursor_test";
+        std::filesystem::remove_all(dir_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    static Bytes make_key(int i) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "k%03d", i);
+        return Bytes(buf, buf + 4);
+    }
+
+    std::unique_ptr<Indexer> make_indexer(IndexType type, int count) {
+        auto indexer = create_indexer(type, dir_.string());
+        for (int i = 0; i < count; ++i) {
+            indexer->put(make_key(i * 2), LogRecordPos(1, i, 10));
+        }
+        return indexer;
+    }
+
+    std::filesystem::path dir_;
+    const std::vector<IndexType> types_ = {IndexType::BTREE, IndexType::SKIPLIST,
+                                           IndexType::BPLUS_TREE, IndexType::ART};
+};
+
+TEST_F(IndexCursorTest, SeekBothDirections) {
+    for (IndexType type : types_) {
+        SCOPED_TRACE(static_cast<int>(type));
+        std::filesystem::remove_all(dir_);
+        auto indexer = make_indexer(type, 100);   // k000, k002, ..., k198
+
+        auto forward = indexer->iterator(false);
+        forward->seek(make_key(50));
+        ASSERT_TRUE(forward->valid());
+        EXPECT_EQ(forward->key(), make_key(50));
+        forward->seek(make_key(51));
+        ASSERT_TRUE(forward->valid());
+        EXPECT_EQ(forward->key(), make_key(52));
+        forward->seek(make_key(199));
+        EXPECT_FALSE(forward->valid());
+
+        // 反向定位到最后一个小于等于key的位置
+        auto reverse = indexer->iterator(true);
+        ASSERT_TRUE(reverse->valid());
+        EXPECT_EQ(reverse->key(), make_key(198));
+        reverse->seek(make_key(51));
+        ASSERT_TRUE(reverse->valid());
+        EXPECT_EQ(reverse->key(), make_key(50));
+        EXPECT_EQ(reverse->value().offset, 25u);
+        reverse->next();
+        ASSERT_TRUE(reverse->valid());
+        EXPECT_EQ(reverse->key(), make_key(48));
+
+        int count = 0;
+        Bytes last;
+        for (reverse->rewind(); reverse->valid(); reverse->next()) {
+            if (count > 0) {
+                EXPECT_LT(reverse->key(), last);
+            }
+            last = reverse->key();
+            ++count;
+        }
+        EXPECT_EQ(count, 100);
+        reverse->seek(Bytes{'a'});
+        EXPECT_FALSE(reverse->valid());
+        indexer->close();
+    }
+}
+
+TEST_F(IndexCursorTest, ModifyDuringIteration) {
+    for (IndexType type : types_) {
+        for (bool reverse : {false, true}) {
+            SCOPED_TRACE(std::to_string(static_cast<int>(type)) + (reverse ? " reverse" : " forward"));
+            std::filesystem::remove_all(dir_);
+            auto indexer = make_indexer(type, 50);   // k000, k002, ..., k098
+
+            // 每一步删除当前key和下一个key，并在前方插入一个新key
+            std::vector<Bytes> seen;
+            auto iter = indexer->iterator(reverse);
+            for (; iter->valid(); iter->next()) {
+                seen.push_back(iter->key());
+                int current = std::stoi(std::string(seen.back().begin() + 1, seen.back().end()));
+                int step = reverse ? -2 : 2;
+                indexer->remove(make_key(current));
+                indexer->remove(make_key(current + step));
+                indexer->put(make_key(current + 2 * step + (reverse ? -1 : 1)), LogRecordPos(2, 0, 10));
+                // 当前key被删除后仍可读取，位置取删除前的值
+                EXPECT_EQ(iter->key(), seen.back());
+                EXPECT_NO_THROW(iter->value());
+            }
+
+            ASSERT_FALSE(seen.empty());
+            for (size_t i = 1; i < seen.size(); ++i) {
+                if (reverse) {
+                    EXPECT_GT(seen[i - 1], seen[i]);
+                } else {
+                    EXPECT_LT(seen[i - 1], seen[i]);
+                }
+            }
+            // 下一个key被删除，新插入的key能被看到
+            EXPECT_EQ(seen[0], reverse ? make_key(98) : make_key(0));
+            ASSERT_GE(seen.size(), 3u);
+            EXPECT_EQ(seen[1], reverse ? make_key(94) : make_key(4));
+            EXPECT_EQ(seen[2], reverse ? make_key(93) : make_key(5));
+            indexer->close();
+        }
+    }
+}
+
+TEST_F(IndexCursorTest, KeyReferenceOutlivesRemoval) {
+    for (IndexType type : types_) {
+        SCOPED_TRACE(static_cast<int>(type));
+        std::filesystem::remove_all(dir_);
+        auto indexer = make_indexer(type, 50);
+
+        // key直接引用索引中的数据：停在同一位置的迭代器返回同一个对象
+        auto first = indexer->iterator(false);
+        auto second = indexer->iterator(false);
+        first->seek(make_key(20));
+        second->seek(make_key(20));
+        const Bytes& key = first->key();
+        EXPECT_EQ(&second->key(), &key);
+
+        // 删除当前key并在周围插入，引用在迭代器移动之前保持有效且内容不变
+        indexer->remove(make_key(20));
+        for (int i = 15; i < 25; i += 2) {
+            indexer->put(make_key(i), LogRecordPos(2, i, 10));
+        }
+        EXPECT_EQ(key, make_key(20));
+        EXPECT_EQ(&first->key(), &key);
+        EXPECT_EQ(second->key(), make_key(20));
+        EXPECT_EQ(first->value().offset, 10u);
+        second.reset();
+
+        first->next();
+        ASSERT_TRUE(first->valid());
+        EXPECT_EQ(first->key(), make_key(21));
+        indexer->close();
+    }
+}
+
 // 性能测试
 class IndexPerformanceTest : public ::testing::Test {
 protected:
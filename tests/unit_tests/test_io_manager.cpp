@@ -1,10 +1,15 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "bitcask/io_manager.h"
+#include "bitcask/io_uring_io.h"
+#include "bitcask/direct_io.h"
+#include "bitcask/rate_limiter.h"
 #include "bitcask/utils.h"
+#include <atomic>
 #include <fstream>
 #include <chrono>
 #include <numeric>
+#include <thread>
 
 using namespace bitcask;
 
@@ -104,6 +109,49 @@ TEST_F(FileIOManagerTest, MultipleWrites) {
     io_manager->close();
 }
 
+TEST_F(FileIOManagerTest, WriteV) {
+    auto io_manager = create_io_manager(test_file, IOType::STANDARD_FIO);
+    
+    std::vector<uint8_t> head = {0xAA, 0xBB};
+    std::vector<uint8_t> tail = {0xCC, 0xDD, 0xEE};
+    struct iovec iov[3];
+    iov[0].iov_base = head.data();
+    iov[0].iov_len = head.size();
+    iov[1].iov_base = test_data.data();
+    iov[1].iov_len = test_data.size();
+    iov[2].iov_base = tail.data();
+    iov[2].iov_len = tail.size();
+    
+    // 在偏移量4处一次写入三个缓冲区
+    ssize_t written = io_manager->writev(iov, 3, 4);
+    EXPECT_EQ(static_cast<size_t>(written), head.size() + test_data.size() + tail.size());
+    EXPECT_EQ(static_cast<size_t>(io_manager->size()), 4 + static_cast<size_t>(written));
+    
+    std::vector<uint8_t> expected = head;
+    expected.insert(expected.end(), test_data.begin(), test_data.end());
+    expected.insert(expected.end(), tail.begin(), tail.end());
+    
+    std::vector<uint8_t> read_buffer(expected.size());
+    ssize_t read_bytes = io_manager->read(read_buffer.data(), read_buffer.size(), 4);
+    EXPECT_EQ(static_cast<size_t>(read_bytes), expected.size());
+    EXPECT_EQ(read_buffer, expected);
+    
+    io_manager->close();
+}
+
+TEST_F(FileIOManagerTest, AllocateKeepsSize) {
+    auto io_manager = create_io_manager(test_file, IOType::STANDARD_FIO);
+    
+    // 预分配不改变文件大小（文件系统不支持时同样保持为0）
+    io_manager->allocate(0, 1024 * 1024);
+    EXPECT_EQ(io_manager->size(), 0);
+    
+    io_manager->write(test_data.data(), test_data.size(), 0);
+    EXPECT_EQ(static_cast<size_t>(io_manager->size()), test_data.size());
+    
+    io_manager->close();
+}
+
 TEST_F(FileIOManagerTest, Sync) {
     auto io_manager = create_io_manager(test_file, IOType::STANDARD_FIO);
     
@@ -280,6 +328,207 @@ TEST_F(MMapIOManagerTest, LargeFileExpansion) {
     io_manager->close();
 }
 
+// IOUringIOManager 测试（内核不支持io_uring时走pread/pwrite回退路径）
+class IOUringIOManagerTest : public IOManagerTest {};
+
+TEST_F(IOUringIOManagerTest, WriteAndRead) {
+    auto io_manager = create_io_manager(test_file, IOType::IO_URING);
+    
+    ssize_t written = io_manager->write(test_data.data(), test_data.size(), 0);
+    EXPECT_EQ(static_cast<size_t>(written), test_data.size());
+    EXPECT_EQ(static_cast<size_t>(io_manager->size()), test_data.size());
+    
+    std::vector<uint8_t> head = {0xAA, 0xBB};
+    struct iovec iov[2];
+    iov[0].iov_base = head.data();
+    iov[0].iov_len = head.size();
+    iov[1].iov_base = test_data.data();
+    iov[1].iov_len = test_data.size();
+    written = io_manager->writev(iov, 2, test_data.size());
+    EXPECT_EQ(static_cast<size_t>(written), head.size() + test_data.size());
+    
+    std::vector<uint8_t> read_buffer(test_data.size());
+    ssize_t read_bytes = io_manager->read(read_buffer.data(), read_buffer.size(), test_data.size() + head.size());
+    EXPECT_EQ(static_cast<size_t>(read_bytes), test_data.size());
+    EXPECT_EQ(read_buffer, test_data);
+    
+    // 超出文件末尾的读取返回0
+    EXPECT_EQ(io_manager->read(read_buffer.data(), read_buffer.size(), 1024), 0);
+    
+    io_manager->sync();
+    io_manager->close();
+}
+
+TEST_F(IOUringIOManagerTest, ReadBatch) {
+    auto io_manager = create_io_manager(test_file, IOType::IO_URING);
+    
+    // 写入1000个4字节整数
+    std::vector<uint32_t> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+    io_manager->write(values.data(), values.size() * sizeof(uint32_t), 0);
+    
+    // 超过队列深度的一批随机读取
+    const size_t count = 600;
+    std::vector<uint32_t> results(count, 0xFFFFFFFF);
+    std::vector<IORequest> reqs(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = (i * 7919) % values.size();
+        reqs[i] = IORequest{&results[i], sizeof(uint32_t), static_cast<off_t>(index * sizeof(uint32_t)), -1};
+    }
+    io_manager->read_batch(reqs.data(), reqs.size());
+    
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(reqs[i].result, static_cast<ssize_t>(sizeof(uint32_t)));
+        EXPECT_EQ(results[i], (i * 7919) % values.size());
+    }
+    
+    io_manager->close();
+}
+
+TEST_F(IOUringIOManagerTest, ConcurrentBatchesShareRing) {
+    // 多个线程同时通过共享的ring读写各自的文件，结果分发到各自的请求
+    const int threads = 8;
+    std::vector<std::thread> workers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto io_manager = create_io_manager(test_file + std::to_string(t), IOType::IO_URING);
+            std::vector<uint32_t> values(512);
+            std::iota(values.begin(), values.end(), t * 10000);
+            io_manager->write(values.data(), values.size() * sizeof(uint32_t), 0);
+            
+            for (int round = 0; round < 20; ++round) {
+                const size_t count = 300;   // 8个线程同时提交时超过队列深度
+                std::vector<uint32_t> results(count, 0);
+                std::vector<IORequest> reqs(count);
+                for (size_t i = 0; i < count; ++i) {
+                    size_t index = (i * 31 + round) % values.size();
+                    reqs[i] = IORequest{&results[i], sizeof(uint32_t), static_cast<off_t>(index * sizeof(uint32_t)), -1};
+                }
+                io_manager->read_batch(reqs.data(), reqs.size());
+                for (size_t i = 0; i < count; ++i) {
+                    if (reqs[i].result != static_cast<ssize_t>(sizeof(uint32_t)) ||
+                        results[i] != values[(i * 31 + round) % values.size()]) {
+                        mismatches++;
+                    }
+                }
+                
+                uint32_t single = 0;
+                if (io_manager->read(&single, sizeof(single), round * sizeof(uint32_t)) != sizeof(single) ||
+                    single != values[round]) {
+                    mismatches++;
+                }
+            }
+            io_manager->close();
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+// DirectIOManager 测试
+class DirectIOManagerTest : public IOManagerTest {};
+
+TEST_F(DirectIOManagerTest, UnalignedAppendAndRead) {
+    std::vector<uint8_t> expected;
+    {
+        auto io_manager = create_io_manager(test_file, IOType::DIRECT_IO);
+        
+        // 不对齐的追加写，跨越多个块边界
+        for (int i = 0; i < 300; ++i) {
+            std::vector<uint8_t> record(37 + i % 50, static_cast<uint8_t>(i));
+            ssize_t written = io_manager->write(record.data(), record.size(), expected.size());
+            EXPECT_EQ(static_cast<size_t>(written), record.size());
+            expected.insert(expected.end(), record.begin(), record.end());
+        }
+        EXPECT_EQ(static_cast<size_t>(io_manager->size()), expected.size());
+        
+        // 覆盖写中间的一段
+        std::vector<uint8_t> patch(5000, 0xEE);
+        io_manager->write(patch.data(), patch.size(), 3000);
+        std::copy(patch.begin(), patch.end(), expected.begin() + 3000);
+        
+        // 小范围读取（经过块缓存）与大范围读取
+        std::vector<uint8_t> small(100);
+        EXPECT_EQ(io_manager->read(small.data(), small.size(), 4050), 100);
+        EXPECT_TRUE(std::equal(small.begin(), small.end(), expected.begin() + 4050));
+        std::vector<uint8_t> all(expected.size() + 100);
+        EXPECT_EQ(static_cast<size_t>(io_manager->read(all.data(), all.size(), 0)), expected.size());
+        all.resize(expected.size());
+        EXPECT_EQ(all, expected);
+        
+        EXPECT_EQ(io_manager->sync(), 0);
+        io_manager->close();
+    }
+    
+    // 重新打开：尾块补零后文件大小按块对齐，原有数据不变
+    auto io_manager = create_io_manager(test_file, IOType::DIRECT_IO);
+    off_t size = io_manager->size();
+    EXPECT_EQ(size % DIRECT_IO_BLOCK_SIZE, 0);
+    EXPECT_GE(static_cast<size_t>(size), expected.size());
+    std::vector<uint8_t> all(size);
+    EXPECT_EQ(io_manager->read(all.data(), all.size(), 0), size);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), all.begin()));
+    EXPECT_TRUE(std::all_of(all.begin() + expected.size(), all.end(), [](uint8_t b) { return b == 0; }));
+    io_manager->close();
+}
+
+// 限速的IO管理器测试
+class RateLimitedIOManagerTest : public IOManagerTest {};
+
+TEST_F(RateLimitedIOManagerTest, ThrottlesAndPassesThrough) {
+    auto limiter = std::make_shared<RateLimiter>(1024 * 1024);
+    RateLimitedIOManager io_manager(create_io_manager(test_file, IOType::STANDARD_FIO), limiter);
+    
+    // 以1MB/s写入256KB，至少需要约250ms
+    std::vector<uint8_t> chunk(64 * 1024, 0xAB);
+    auto start_time = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(io_manager.write(chunk.data(), chunk.size(), i * chunk.size()),
+                  static_cast<ssize_t>(chunk.size()));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    EXPECT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 200);
+    
+    // 读取同样计入额度，内容和大小透传底层IO管理器
+    std::vector<uint8_t> buffer(chunk.size());
+    ASSERT_EQ(io_manager.read(buffer.data(), buffer.size(), chunk.size()), static_cast<ssize_t>(buffer.size()));
+    EXPECT_EQ(buffer, chunk);
+    EXPECT_EQ(io_manager.size(), static_cast<off_t>(4 * chunk.size()));
+    EXPECT_EQ(limiter->total_bytes(), 5 * chunk.size());
+    EXPECT_EQ(io_manager.sync(), 0);
+    io_manager.close();
+}
+
+TEST(RateLimiterTest, AdaptiveBackoffOnSlowForeground) {
+    const uint64_t max_rate = 64 * 1024 * 1024;
+    RateLimiter limiter(max_rate, 1000);
+    
+    // 没有后台任务时前台不采样
+    EXPECT_FALSE(limiter.sampling());
+    
+    RateLimiter::ActiveScope scope(&limiter);
+    EXPECT_TRUE(limiter.sampling());
+    
+    // 一个调整周期内大部分前台操作超过目标，速率减半
+    for (int i = 0; i < 32; ++i) {
+        limiter.report_latency(5000);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    limiter.request(1);
+    EXPECT_EQ(limiter.rate(), max_rate / 2);
+    
+    // 前台恢复正常后速率逐步回升
+    for (int i = 0; i < 32; ++i) {
+        limiter.report_latency(100);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    limiter.request(1);
+    EXPECT_EQ(limiter.rate(), max_rate / 2 + max_rate / 10);
+}
+
 // 性能对比测试
 TEST_F(IOManagerTest, PerformanceComparison) {
     const size_t data_size = 10 * 1024; // 10KB
@@ -220,6 +220,114 @@ TEST_F(DBIteratorTest, SingleElement) {
     utils::remove_directory(single_dir);
 }
 
+// 范围扫描测试
+TEST_F(DBIteratorTest, RangeBounds) {
+    IteratorOptions iter_options;
+    iter_options.lower_bound = test_pairs[1].first;  // "abc"（包含）
+    iter_options.upper_bound = test_pairs[3].first;  // "ccc"（不包含）
+    
+    auto collect = [](DBIterator* iter) {
+        std::vector<Bytes> keys;
+        for (; iter->valid(); iter->next()) {
+            keys.push_back(iter->key());
+        }
+        return keys;
+    };
+    
+    auto iter = db->iterator(iter_options);
+    EXPECT_EQ(collect(iter.get()), std::vector<Bytes>({test_pairs[1].first, test_pairs[2].first}));
+    
+    // 范围之外的seek从范围的起点开始，或者直接结束
+    iter->seek(test_pairs[0].first);
+    ASSERT_TRUE(iter->valid());
+    EXPECT_EQ(iter->key(), test_pairs[1].first);
+    iter->seek(test_pairs[3].first);
+    EXPECT_FALSE(iter->valid());
+    
+    iter_options.reverse = true;
+    auto reverse_iter = db->iterator(iter_options);
+    EXPECT_EQ(collect(reverse_iter.get()), std::vector<Bytes>({test_pairs[2].first, test_pairs[1].first}));
+    reverse_iter->seek(test_pairs[4].first);
+    ASSERT_TRUE(reverse_iter->valid());
+    EXPECT_EQ(reverse_iter->key(), test_pairs[2].first);
+    reverse_iter->seek(test_pairs[0].first);
+    EXPECT_FALSE(reverse_iter->valid());
+}
+
+TEST_F(DBIteratorTest, ReversePrefixIteration) {
+    db->put({0xff, 0x01}, {0x76});
+    db->put({0xff, 0xff, 0x02}, {0x76});
+    
+    // 反向前缀迭代从前缀范围的末尾开始
+    IteratorOptions iter_options;
+    iter_options.prefix = {0x61};  // "a"
+    iter_options.reverse = true;
+    auto iter = db->iterator(iter_options);
+    std::vector<Bytes> keys;
+    for (iter->rewind(); iter->valid(); iter->next()) {
+        keys.push_back(iter->key());
+    }
+    EXPECT_EQ(keys, std::vector<Bytes>({test_pairs[1].first, test_pairs[0].first}));
+    
+    // 全是0xFF的前缀没有上界
+    iter_options.prefix = {0xff, 0xff};
+    iter = db->iterator(iter_options);
+    ASSERT_TRUE(iter->valid());
+    EXPECT_EQ(iter->key(), Bytes({0xff, 0xff, 0x02}));
+    iter->next();
+    EXPECT_FALSE(iter->valid());
+}
+
+TEST_F(DBIteratorTest, PaginatedListing) {
+    for (IndexType type : {IndexType::BTREE, IndexType::SKIPLIST, IndexType::BPLUS_TREE, IndexType::ART}) {
+        for (bool reverse : {false, true}) {
+            SCOPED_TRACE(std::to_string(static_cast<int>(type)) + (reverse ? " reverse" : " forward"));
+            std::string page_dir = test_dir + "_pages";
+            utils::remove_directory(page_dir);
+            Options page_options = options;
+            page_options.dir_path = page_dir;
+            page_options.index_type = type;
+            auto page_db = DB::open(page_options);
+            for (int i = 0; i < 25; ++i) {
+                page_db->put({0x70, static_cast<uint8_t>(i)}, {0x76});   // "p" + i
+            }
+            page_db->put({0x71}, {0x76});
+            
+            // 每页3个key，下一页从上一页最后一个key之后开始
+            IteratorOptions iter_options;
+            iter_options.prefix = {0x70};
+            iter_options.reverse = reverse;
+            iter_options.limit = 3;
+            std::vector<Bytes> keys;
+            int pages = 0;
+            while (true) {
+                auto iter = page_db->iterator(iter_options);
+                if (!iter->valid()) {
+                    break;
+                }
+                for (; iter->valid(); iter->next()) {
+                    keys.push_back(iter->key());
+                }
+                pages++;
+                if (reverse) {
+                    iter_options.upper_bound = keys.back();
+                } else {
+                    iter_options.lower_bound = keys.back();
+                    iter_options.lower_bound.push_back(0x00);
+                }
+            }
+            
+            EXPECT_EQ(pages, 9);
+            ASSERT_EQ(keys.size(), 25u);
+            for (int i = 0; i < 25; ++i) {
+                EXPECT_EQ(keys[i], Bytes({0x70, static_cast<uint8_t>(reverse ? 24 - i : i)}));
+            }
+            page_db->close();
+            utils::remove_directory(page_dir);
+        }
+    }
+}
+
 // 错误处理测试
 class DBIteratorErrorTest : public DBIteratorTest {};
 
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "bitcask/log_record.h"
+#include "bitcask/crc32c.h"
+#include <random>
+#include <string>
 
 using namespace bitcask;
 
@@ -93,6 +96,28 @@ TEST_F(LogRecordTest, EncodedSize) {
     EXPECT_EQ(calculated_size, actual_size);
 }
 
+// 测试单独编码头部：头部 + key + value 与完整编码一致
+TEST_F(LogRecordTest, EncodeHeader) {
+    LogRecord record(test_key, test_value, LogRecordType::NORMAL);
+    auto [encoded, size] = record.encode();
+    
+    uint8_t header[MAX_LOG_RECORD_HEADER_SIZE];
+    size_t header_size = record.encode_header(header);
+    EXPECT_EQ(header_size + test_key.size() + test_value.size(), size);
+    
+    Bytes assembled(header, header + header_size);
+    assembled.insert(assembled.end(), test_key.begin(), test_key.end());
+    assembled.insert(assembled.end(), test_value.begin(), test_value.end());
+    EXPECT_EQ(assembled, encoded);
+    
+    // 空value的删除记录同样一致
+    LogRecord deleted_record(test_key, empty_bytes, LogRecordType::DELETED);
+    auto [deleted_encoded, deleted_size] = deleted_record.encode();
+    header_size = deleted_record.encode_header(header);
+    EXPECT_EQ(header_size + test_key.size(), deleted_size);
+    EXPECT_TRUE(std::equal(header, header + header_size, deleted_encoded.begin()));
+}
+
 // LogRecordPos 测试
 class LogRecordPosTest : public ::testing::Test {
 protected:
@@ -166,6 +191,19 @@ TEST_F(LogRecordHeaderTest, InvalidHeader) {
     EXPECT_THROW(decode_log_record_header(invalid_header), BitcaskException);
 }
 
+// 填充记录编码后必须正好占满指定长度
+TEST(PaddingRecordTest, ExactEncodedSize) {
+    for (size_t size = MIN_PADDING_RECORD_SIZE; size < 20000; size += 37) {
+        LogRecord record = padding_record(size);
+        auto [encoded, encoded_size] = record.encode();
+        EXPECT_EQ(encoded_size, size);
+        EXPECT_EQ(record.type, LogRecordType::SYNC_MARKER);
+        EXPECT_TRUE(verify_encoded_log_record(encoded.data(), encoded.size()));
+    }
+    EXPECT_EQ(padding_record(1024 * 1024).encoded_size(), 1024u * 1024u);
+    EXPECT_THROW(padding_record(MIN_PADDING_RECORD_SIZE - 1), BitcaskException);
+}
+
 // 变长整数编码测试
 class VarintTest : public ::testing::Test {};
 
@@ -234,3 +272,59 @@ TEST_F(CrcTest, CrcDifference) {
     // 不同数据应该产生不同的 CRC
     EXPECT_NE(record1.get_crc(), record2.get_crc());
 }
+
+TEST_F(CrcTest, Crc32cKnownValues) {
+    const std::string digits = "123456789";
+    EXPECT_EQ(crc32c::value(digits.data(), digits.size()), 0xE3069283u);
+    EXPECT_EQ(crc32c::extend_portable(0, digits.data(), digits.size()), 0xE3069283u);
+    
+    // 32个零字节（RFC 3720附录B.4）
+    Bytes zeros(32, 0x00);
+    EXPECT_EQ(crc32c::value(zeros.data(), zeros.size()), 0x8A9136AAu);
+    Bytes ones(32, 0xFF);
+    EXPECT_EQ(crc32c::value(ones.data(), ones.size()), 0x62A8AB43u);
+    
+    // 分段计算与整体计算结果相同
+    uint32_t crc = crc32c::value(digits.data(), 4);
+    crc = crc32c::extend(crc, digits.data() + 4, digits.size() - 4);
+    EXPECT_EQ(crc, 0xE3069283u);
+}
+
+TEST_F(CrcTest, Crc32cMatchesPortable) {
+    // 覆盖各种长度和起始对齐，长数据会走三路并行合并的路径
+    std::mt19937 rng(42);
+    Bytes data(3 * 8192 * 2 + 1024);
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+    
+    const size_t lengths[] = {0, 1, 7, 8, 9, 63, 255, 767, 768, 769, 4096, 3 * 8192, 3 * 8192 + 777, 3 * 8192 * 2 + 999};
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t len : lengths) {
+            ASSERT_LE(offset + len, data.size());
+            EXPECT_EQ(crc32c::extend(0x12345678, data.data() + offset, len),
+                      crc32c::extend_portable(0x12345678, data.data() + offset, len))
+                << "offset=" << offset << " len=" << len << " impl=" << crc32c::implementation();
+        }
+    }
+}
+
+TEST_F(CrcTest, VerifyCrc) {
+    LogRecord record({0x74, 0x65, 0x73, 0x74}, {0x76, 0x61, 0x6c, 0x75, 0x65}, LogRecordType::NORMAL);
+    EXPECT_TRUE(record.verify_crc(record.get_crc()));
+    EXPECT_FALSE(record.verify_crc(record.get_crc() ^ 1));
+    EXPECT_FALSE(record.verify_crc(0));
+    
+    // 旧版本写入的CRC32（IEEE）校验值仍然有效
+    auto [encoded, size] = record.encode();
+    uint32_t legacy = 0xFFFFFFFF;
+    for (size_t i = 4; i < size; ++i) {
+        legacy ^= encoded[i];
+        for (int j = 0; j < 8; ++j) {
+            legacy = (legacy & 1) ? (legacy >> 1) ^ 0xEDB88320 : legacy >> 1;
+        }
+    }
+    legacy ^= 0xFFFFFFFF;
+    EXPECT_NE(legacy, record.get_crc());
+    EXPECT_TRUE(record.verify_crc(legacy));
+}
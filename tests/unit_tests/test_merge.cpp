@@ -317,5 +317,269 @@ TEST_F(MergeTest, MergeStatistics) {
     db->close();
 }
 
+// merge后文件ID和偏移被复用，值缓存中的旧值不能再被读到
+TEST_F(MergeTest, MergeInvalidatesValueCache) {
+    options_.data_file_merge_ratio = 0.0;
+    options_.value_cache_size = 4 * 1024 * 1024;
+    auto db = DB::open(options_);
+    
+    std::vector<Bytes> values;
+    for (int i = 0; i < 200; ++i) {
+        values.push_back(random_value(100));
+        db->put(string_to_bytes("key" + std::to_string(i)), values.back());
+    }
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(db->get(string_to_bytes("key" + std::to_string(i))), values[i]);
+    }
+    for (int i = 0; i < 100; ++i) {
+        db->remove(string_to_bytes("key" + std::to_string(i)));
+    }
+    
+    db->merge();
+    
+    for (int i = 100; i < 200; ++i) {
+        EXPECT_EQ(db->get(string_to_bytes("key" + std::to_string(i))), values[i]);
+    }
+    db->close();
+}
+
+// merge期间前台读写照常进行，被改写或删除的key在merge结束后保持最新状态
+TEST_F(MergeTest, ForegroundWritesDuringMerge) {
+    options_.data_file_merge_ratio = 0.0;
+    options_.data_file_size = 64 * 1024;
+    options_.sync_writes = false;
+    auto db = DB::open(options_);
+    
+    const int key_count = 5000;
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < key_count; ++i) {
+            db->put(string_to_bytes("k" + std::to_string(i)), random_value(100));
+        }
+    }
+    
+    std::atomic<bool> merge_done{false};
+    std::thread merge_thread([&]() {
+        db->merge();
+        merge_done = true;
+    });
+    
+    // merge进行中不停改写、删除和新增key，直到merge结束后再多写一轮
+    int rounds = 0;
+    bool last_round = false;
+    while (!last_round) {
+        last_round = merge_done.load();
+        for (int i = 0; i < 100; ++i) {
+            db->put(string_to_bytes("k" + std::to_string(i)), string_to_bytes("new" + std::to_string(rounds)));
+            db->remove(string_to_bytes("k" + std::to_string(100 + i)));
+            db->put(string_to_bytes("n" + std::to_string(i)), string_to_bytes("added"));
+        }
+        EXPECT_EQ(db->get(string_to_bytes("k" + std::to_string(key_count - 1))).size(), 100u);
+        rounds++;
+    }
+    merge_thread.join();
+    
+    auto verify = [&](DB* d) {
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(bytes_to_string(d->get(string_to_bytes("k" + std::to_string(i)))),
+                      "new" + std::to_string(rounds - 1));
+            EXPECT_THROW(d->get(string_to_bytes("k" + std::to_string(100 + i))), KeyNotFoundError);
+            EXPECT_EQ(bytes_to_string(d->get(string_to_bytes("n" + std::to_string(i)))), "added");
+        }
+        for (int i = 200; i < key_count; ++i) {
+            EXPECT_EQ(d->get(string_to_bytes("k" + std::to_string(i))).size(), 100u);
+        }
+        EXPECT_EQ(d->stat().key_num, static_cast<uint32_t>(key_count));
+    };
+    verify(db.get());
+    db->close();
+    
+    // 重启后结果一致
+    db = DB::open(options_);
+    verify(db.get());
+    db->close();
+}
+
+// 完成标记写入后安装中断（部分结果已改名到主目录），重新打开时重做安装
+TEST_F(MergeTest, InterruptedInstallIsRedoneOnOpen) {
+    options_.data_file_merge_ratio = 0.0;
+    options_.data_file_size = 16 * 1024;
+    {
+        auto db = DB::open(options_);
+        for (int i = 0; i < 2000; ++i) {
+            db->put(string_to_bytes("key" + std::to_string(i)), string_to_bytes("value" + std::to_string(i)));
+        }
+        for (int i = 0; i < 1000; ++i) {
+            db->remove(string_to_bytes("key" + std::to_string(i)));
+        }
+        db->close();
+    }
+    std::vector<uint32_t> merged_fids = DataFile::list_data_file_ids(temp_dir_);
+    ASSERT_GT(merged_fids.size(), 2u);
+    
+    // 在副本上完成一次merge，得到合并结果
+    std::string copy_dir = temp_dir_ + "-copy";
+    utils::remove_directory(copy_dir);
+    utils::create_directory(copy_dir);
+    for (uint32_t fid : merged_fids) {
+        utils::copy_file(DataFile::get_data_file_name(temp_dir_, fid), DataFile::get_data_file_name(copy_dir, fid));
+    }
+    Options copy_options = options_;
+    copy_options.dir_path = copy_dir;
+    {
+        auto db = DB::open(copy_options);
+        db->merge();
+        db->close();
+    }
+    std::vector<uint32_t> output_fids;
+    for (uint32_t fid : DataFile::list_data_file_ids(copy_dir)) {
+        if (fid <= merged_fids.back()) {
+            output_fids.push_back(fid);
+        }
+    }
+    ASSERT_FALSE(output_fids.empty());
+    ASSERT_LT(output_fids.size(), merged_fids.size());
+    
+    // 模拟中断：合并目录中有结果和完成标记，第一个结果已经改名到主目录
+    std::string merge_dir = temp_dir_ + MERGE_DIR_SUFFIX;
+    utils::remove_directory(merge_dir);
+    utils::create_directory(merge_dir);
+    for (uint32_t fid : output_fids) {
+        utils::move_file(DataFile::get_data_file_name(copy_dir, fid), DataFile::get_data_file_name(merge_dir, fid));
+    }
+    std::string ids;
+    for (size_t i = 0; i < merged_fids.size(); ++i) {
+        ids += (i > 0 ? "," : "") + std::to_string(merged_fids[i]);
+    }
+    ids += ";";
+    for (size_t i = 0; i < output_fids.size(); ++i) {
+        ids += (i > 0 ? "," : "") + std::to_string(output_fids[i]);
+    }
+    auto merge_finished_file = DataFile::open_merge_finished_file(merge_dir);
+    LogRecord merge_finished_record(string_to_bytes(MERGE_FINISHED_KEY), string_to_bytes(ids));
+    merge_finished_file->write(merge_finished_record.encode().first);
+    merge_finished_file->close();
+    utils::move_file(DataFile::get_data_file_name(merge_dir, output_fids[0]),
+                     DataFile::get_data_file_name(temp_dir_, output_fids[0]));
+    
+    auto db = DB::open(options_);
+    EXPECT_FALSE(utils::directory_exists(merge_dir));
+    EXPECT_EQ(DataFile::list_data_file_ids(temp_dir_), output_fids);
+    EXPECT_EQ(db->stat().key_num, 1000u);
+    for (int i = 0; i < 2000; ++i) {
+        if (i < 1000) {
+            EXPECT_THROW(db->get(string_to_bytes("key" + std::to_string(i))), KeyNotFoundError);
+        } else {
+            EXPECT_EQ(bytes_to_string(db->get(string_to_bytes("key" + std::to_string(i)))), "value" + std::to_string(i));
+        }
+    }
+    db->close();
+    utils::remove_directory(copy_dir);
+}
+
+// 只重写失效比例达到阈值的文件，其余文件原样保留；合并的文件之前还有未合并的文件时，删除记录要保留
+TEST_F(MergeTest, SelectiveMergeRewritesOnlyGarbageFiles) {
+    options_.data_file_merge_ratio = 0.0;
+    options_.data_file_size = 16 * 1024;
+    options_.merge_file_garbage_ratio = 0.5;
+    options_.sync_writes = false;
+    auto db = DB::open(options_);
+    
+    // 开头几个文件只有"x"之后会被删除
+    db->put(string_to_bytes("x"), string_to_bytes("old"));
+    for (int i = 0; i < 1500; ++i) {
+        db->put(string_to_bytes("a" + std::to_string(i)), string_to_bytes("value_a" + std::to_string(i)));
+    }
+    uint32_t first_garbage_fid = db->data_file_stats().back().file_id + 1;
+    
+    // 后面的文件被整体改写，中间夹着"x"的删除记录
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 500; ++i) {
+            db->put(string_to_bytes("b" + std::to_string(i)),
+                    string_to_bytes(std::string(100, 'b') + std::to_string(i) + "_" + std::to_string(round)));
+        }
+        if (round == 0) {
+            db->remove(string_to_bytes("x"));
+        }
+    }
+    
+    auto stats_before = db->data_file_stats();
+    int64_t dead_total = 0;
+    for (const auto& file_stat : stats_before) {
+        dead_total += static_cast<int64_t>(file_stat.dead_bytes);
+        if (file_stat.file_id < first_garbage_fid - 1) {
+            EXPECT_LT(file_stat.garbage_ratio(), 0.5);
+        }
+    }
+    EXPECT_EQ(db->stat().reclaimable_size, dead_total);
+    
+    db->merge();
+    
+    // 失效比例低的文件没有被重写
+    auto stats_after = db->data_file_stats();
+    for (const auto& before : stats_before) {
+        if (before.garbage_ratio() >= 0.5) {
+            continue;
+        }
+        auto it = std::find_if(stats_after.begin(), stats_after.end(),
+                               [&](const DataFileStat& after) { return after.file_id == before.file_id; });
+        ASSERT_NE(it, stats_after.end());
+        EXPECT_EQ(it->size, before.size);
+    }
+    EXPECT_LT(stats_after.size(), stats_before.size());
+    EXPECT_LT(db->stat().reclaimable_size, dead_total);
+    
+    auto verify = [&](DB* d) {
+        EXPECT_THROW(d->get(string_to_bytes("x")), KeyNotFoundError);
+        for (int i = 0; i < 1500; ++i) {
+            EXPECT_EQ(bytes_to_string(d->get(string_to_bytes("a" + std::to_string(i)))), "value_a" + std::to_string(i));
+        }
+        for (int i = 0; i < 500; ++i) {
+            EXPECT_EQ(bytes_to_string(d->get(string_to_bytes("b" + std::to_string(i)))),
+                      std::string(100, 'b') + std::to_string(i) + "_2");
+        }
+    };
+    verify(db.get());
+    db->close();
+    
+    // 重启后逐文件的失效字节数由重放重新算出，与merge后的一致
+    db = DB::open(options_);
+    verify(db.get());
+    auto stats_reopen = db->data_file_stats();
+    ASSERT_EQ(stats_reopen.size(), stats_after.size());
+    for (size_t i = 0; i < stats_after.size(); ++i) {
+        EXPECT_EQ(stats_reopen[i].file_id, stats_after[i].file_id);
+        EXPECT_EQ(stats_reopen[i].dead_bytes, stats_after[i].dead_bytes);
+    }
+    db->close();
+}
+
+TEST_F(MergeTest, RateLimitedMerge) {
+    options_.data_file_merge_ratio = 0.0;
+    options_.data_file_size = 64 * 1024;
+    options_.sync_writes = false;
+    options_.background_io_rate = 1024 * 1024;
+    options_.background_io_latency_target_us = 100 * 1000;
+    auto db = DB::open(options_);
+    
+    // 两轮写入约460KB，第一轮的文件全部失效，merge读取这一半并写回其中仍有效的少量记录
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 2000; ++i) {
+            db->put(string_to_bytes("k" + std::to_string(i)),
+                    string_to_bytes(std::string(100, 'v') + std::to_string(round)));
+        }
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    db->merge();
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    
+    // 以1MB/s读写约250KB，扣除一个周期的令牌（约100KB）后至少需要约150ms
+    EXPECT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 100);
+    for (int i = 0; i < 2000; ++i) {
+        EXPECT_EQ(bytes_to_string(db->get(string_to_bytes("k" + std::to_string(i)))), std::string(100, 'v') + "1");
+    }
+    EXPECT_EQ(db->stat().reclaimable_size, 0);
+}
+
 }  // namespace test
 }  // namespace bitcask
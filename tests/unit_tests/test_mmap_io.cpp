@@ -166,6 +166,27 @@ TEST_F(MMapIOTest, BinarySafeData) {
     mmap_io->close();
 }
 
+TEST_F(MMapIOTest, ReadOnlyMapping) {
+    std::string data = "sealed file contents";
+    {
+        bitcask::FileIOManager file_io(test_file_);
+        file_io.write(data.data(), data.size(), 0);
+        file_io.close();
+    }
+
+    EXPECT_EQ(bitcask::ReadOnlyMapping::open(test_file_, 0), nullptr);
+    EXPECT_EQ(bitcask::ReadOnlyMapping::open(test_dir_ + "/missing.dat", 16), nullptr);
+
+    auto mapping = bitcask::ReadOnlyMapping::open(test_file_, data.size());
+    ASSERT_NE(mapping, nullptr);
+    ASSERT_EQ(mapping->size(), data.size());
+    EXPECT_EQ(std::memcmp(mapping->data(), data.data(), data.size()), 0);
+
+    // 文件删除后映射仍然有效
+    std::remove(test_file_.c_str());
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(mapping->data()), mapping->size()), data);
+}
+
 // 性能对比测试（可选）
 TEST_F(MMapIOTest, PerformanceComparison) {
     const size_t data_size = 10 * 1024; // 10KB